@@ -12,9 +12,50 @@ endmacro()
 # Add a keyword for the length of the test: 
 # 
 add_FretLab_runtest(integrate_density                                "FretLab;Integrate Cube File")
+add_FretLab_runtest(atomic_charges                                   "FretLab;Integrate Cube File;Atomic Charges;")
 add_FretLab_runtest(acceptor_donor_coulomb                           "FretLab;Acceptor - Donor Coulomb;")
 add_FretLab_runtest(acceptor_donor_with_overlap_integral             "FretLab;Acceptor - Donor Coulomb + Overlap;")
 add_FretLab_runtest(acceptor_np_charges                              "FretLab;Acceptor - Nanoparticle Interaction;")
+add_FretLab_runtest(acceptor_np_frequencies                          "FretLab;Acceptor - Nanoparticle Frequencies;")
+add_FretLab_runtest(acceptor_np_map                                  "FretLab;Acceptor - Nanoparticle Potential Map;")
+add_FretLab_runtest(acceptor_donor_states                            "FretLab;Acceptor - Donor States;")
+add_FretLab_runtest(acceptor_donor_identical                         "FretLab;Acceptor - Donor Identical Densities;")
+add_FretLab_runtest(aggregate                                        "FretLab;Aggregate;")
+add_FretLab_runtest(trajectory                                       "FretLab;Trajectory;")
+add_FretLab_runtest(compression                                      "FretLab;Compressed Operator;")
+add_FretLab_runtest(cutoff_sweep                                     "FretLab;Cutoff Sweep;")
+add_FretLab_runtest(kernel_variants                                  "FretLab;Kernel Variants;")
+add_FretLab_runtest(checkpoint_restart                               "FretLab;Checkpoint Restart;")
+add_FretLab_runtest(monte_carlo                                      "FretLab;Monte Carlo;")
+add_FretLab_runtest(dipole_prescreen                                 "FretLab;Dipole Prescreen;")
+add_FretLab_runtest(server_mode                                      "FretLab;Server Mode;")
+add_FretLab_runtest(results_file                                     "FretLab;Results File;")
+if(ZLIB_FOUND AND LIBLZMA_FOUND)
+    # gzip cube and (multi-member) log, xz cube
+    add_FretLab_runtest(compressed_inputs                            "FretLab;Compressed Inputs;")
+endif()
+if(ZSTD_FOUND)
+    # single-frame acceptor, multi-frame donor (frames decoded in parallel)
+    add_FretLab_runtest(compressed_inputs_zstd                       "FretLab;Compressed Inputs;")
+endif()
+if(ENABLE_BENCHMARKS)
+    # Synthetic Gaussians: couplings checked against their closed form
+    add_test(NAME synthetic_gaussians COMMAND fretlab_bench -sizes 24 -threads 1,2 -tolerance 1.0e-9)
+    set_tests_properties(synthetic_gaussians PROPERTIES LABELS "FretLab;Synthetic Gaussians;")
+endif()
+if(ENABLE_PYTHON)
+    add_FretLab_runtest(python_bindings                              "FretLab;Python Bindings;")
+endif()
+if(ENABLE_MPI AND MPI_CXX_FOUND)
+    # 2 and 3 ranks on one box against the shared-memory references. Open MPI
+    # refuses to run as root or with more ranks than cores unless told to.
+    add_test(NAME mpi
+             COMMAND python3 ${PROJECT_BINARY_DIR}/tests/mpi/test --binary-dir=${PROJECT_BINARY_DIR}
+                     --work-dir=${PROJECT_BINARY_DIR}/tests/mpi --mpiexec=${MPIEXEC_EXECUTABLE}
+                     "--mpiexec-flags=${MPIEXEC_PREFLAGS}" --verbose)
+    set_tests_properties(mpi PROPERTIES LABELS "FretLab;MPI;"
+                         ENVIRONMENT "OMPI_ALLOW_RUN_AS_ROOT=1;OMPI_ALLOW_RUN_AS_ROOT_CONFIRM=1;OMPI_MCA_rmaps_base_oversubscribe=1")
+endif()
 ##add_FretLab_runtest(acceptor_np_charges_dipoles_donor_coulomb        "FretLab;acceptor_np_charges_dipoles_donor_coulomb;")
 ##add_FretLab_runtest(acceptor_np_charges_donor_coulomb                "FretLab;aceptor_np_charges_donor_coulomb;")
 ##add_FretLab_runtest(acceptor_np_charges_donor_with_overlap_integral  "FretLab;aceptor_np_donor_charges_overlap;")
@@ -0,0 +1,244 @@
+"""
+Python bindings for the FretLab coupling engine.
+
+The bindings load the shared library ``libfretlab.so`` (built next to the
+``FretLab`` executable) through ctypes. Arrays are never copied:
+
+* inputs may be NumPy arrays (float64, C-contiguous) or any writable buffer
+  of doubles (``array.array('d')``, ctypes arrays, ...);
+* ``Density.weights``/``Density.xyz`` and ``Nanoparticle.q``/``mu``/``xyz``
+  are views on the memory of the loaded C++ objects (NumPy arrays when NumPy
+  is installed, memoryviews otherwise).
+
+Nanoparticles with several frequencies hold ``nfreq`` charge (and dipole)
+sets per site, indexed ``[site * nfreq + frequency]``.
+
+ctypes releases the GIL while a library function runs, so the kernels can
+run concurrently with other Python threads.
+
+The library is searched in ``$FRETLAB_LIBRARY``, next to this file, and in
+``../build``. All quantities are in atomic units (coordinates in Bohr).
+"""
+
+import ctypes
+import os
+
+try:
+    import numpy
+except ImportError:  # NumPy is optional
+    numpy = None
+
+__all__ = ['Density', 'Nanoparticle', 'reduce', 'acceptor_donor', 'acceptor_np']
+
+
+def _load_library():
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates = [os.environ.get('FRETLAB_LIBRARY', ''),
+                  os.path.join(here, 'libfretlab.so'),
+                  os.path.join(here, '..', 'build', 'libfretlab.so')]
+    for path in candidates:
+        if path and os.path.exists(path):
+            return ctypes.CDLL(path)
+    raise ImportError('libfretlab.so not found; set FRETLAB_LIBRARY to its path.')
+
+
+_lib = _load_library()
+
+_p = ctypes.c_void_p
+_d = ctypes.c_double
+_size = ctypes.c_size_t
+
+_lib.fretlab_last_error.restype = ctypes.c_char_p
+_lib.fretlab_api_version.restype = ctypes.c_int
+
+_lib.fretlab_density_read.argtypes = [ctypes.c_char_p, _d, ctypes.c_int]
+_lib.fretlab_density_read.restype = _p
+_lib.fretlab_density_free.argtypes = [_p]
+_lib.fretlab_density_size.argtypes = [_p]
+_lib.fretlab_density_size.restype = _size
+_lib.fretlab_density_weights.argtypes = [_p]
+_lib.fretlab_density_weights.restype = _p
+_lib.fretlab_density_xyz.argtypes = [_p]
+_lib.fretlab_density_xyz.restype = _p
+
+_lib.fretlab_nanoparticle_read.argtypes = [ctypes.c_char_p, ctypes.c_int]
+_lib.fretlab_nanoparticle_read.restype = _p
+_lib.fretlab_nanoparticle_free.argtypes = [_p]
+_lib.fretlab_nanoparticle_size.argtypes = [_p]
+_lib.fretlab_nanoparticle_size.restype = _size
+_lib.fretlab_nanoparticle_nfreq.argtypes = [_p]
+_lib.fretlab_nanoparticle_nfreq.restype = ctypes.c_int
+_lib.fretlab_nanoparticle_frequencies.argtypes = [_p]
+_lib.fretlab_nanoparticle_frequencies.restype = _p
+_lib.fretlab_nanoparticle_q.argtypes = [_p]
+_lib.fretlab_nanoparticle_q.restype = _p
+_lib.fretlab_nanoparticle_mu.argtypes = [_p]
+_lib.fretlab_nanoparticle_mu.restype = _p
+_lib.fretlab_nanoparticle_xyz.argtypes = [_p]
+_lib.fretlab_nanoparticle_xyz.restype = _p
+
+_lib.fretlab_reduce.argtypes = [_p, ctypes.c_int * 3, _d * 3, _d * 3, _d, ctypes.c_int, _p, _p]
+_lib.fretlab_reduce.restype = ctypes.c_long
+
+_lib.fretlab_acceptor_donor.argtypes = [_p, _p, _size, _p, _p, _size, ctypes.c_int, _d, _d, _d * 4]
+_lib.fretlab_acceptor_donor.restype = ctypes.c_int
+
+_lib.fretlab_acceptor_np.argtypes = [_p, _p, _size, _p, _p, _p, _size, ctypes.c_int, _p]
+_lib.fretlab_acceptor_np.restype = ctypes.c_int
+
+api_version = _lib.fretlab_api_version()
+
+
+def _check(status):
+    if status is None or status < 0:
+        raise RuntimeError(_lib.fretlab_last_error().decode())
+    return status
+
+
+def _address(obj, ncols):
+    """Returns (address, number of rows) of a contiguous float64 buffer without copying."""
+    interface = getattr(obj, '__array_interface__', None)
+    if interface is not None:
+        if interface['typestr'] != '<f8' or interface.get('strides') is not None:
+            raise TypeError('Arrays must be C-contiguous float64.')
+        count = 1
+        for extent in interface['shape']:
+            count *= extent
+        address = interface['data'][0]
+    else:
+        view = memoryview(obj)
+        if view.format not in ('d', '<d') or not view.c_contiguous:
+            raise TypeError('Buffers must be C-contiguous doubles.')
+        count = view.nbytes // 8
+        address = ctypes.addressof(_d.from_buffer(view)) if count else None
+    if count % ncols:
+        raise ValueError('Expected %d values per point.' % ncols)
+    return address, count // ncols
+
+
+def _view(address, rows, ncols, owner):
+    """Wraps library memory as an array of shape (rows, ncols) that keeps owner alive."""
+    buffer = (_d * (rows * ncols)).from_address(address) if rows else (_d * 0)()
+    buffer._owner = owner
+    shape = (rows, ncols) if ncols > 1 else (rows,)
+    if numpy is not None:
+        return numpy.ctypeslib.as_array(buffer).reshape(shape)
+    return memoryview(buffer).cast('B').cast('d', shape)
+
+
+def _new_array(count):
+    return numpy.empty(count) if numpy is not None else (_d * count)()
+
+
+class Density:
+    """Cube file density reduced with a cutoff (all points if keep_all)."""
+
+    def __init__(self, path, cutoff=0.0, keep_all=False):
+        self._handle = _check(_lib.fretlab_density_read(os.fsencode(path), cutoff, int(keep_all)))
+        n = _lib.fretlab_density_size(self._handle)
+        self.weights = _view(_lib.fretlab_density_weights(self._handle), n, 1, self)
+        self.xyz = _view(_lib.fretlab_density_xyz(self._handle), n, 3, self)
+
+    def __len__(self):
+        return len(self.weights)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fretlab_density_free(self._handle)
+            self._handle = None
+
+
+class Nanoparticle:
+    """
+    Nanoparticle charges (real, imaginary), dipoles (real xyz, imaginary xyz;
+    None for a charges-only model) and site coordinates from a log file, or from
+    a frequency list file (one "frequency  log file" pair per line) if
+    frequency_list is set.
+    """
+
+    def __init__(self, path, frequency_list=False):
+        self._handle = _check(_lib.fretlab_nanoparticle_read(os.fsencode(path), int(frequency_list)))
+        n = _lib.fretlab_nanoparticle_size(self._handle)
+        self.nfreq = _lib.fretlab_nanoparticle_nfreq(self._handle)
+        frequencies = _lib.fretlab_nanoparticle_frequencies(self._handle)
+        self.frequencies = list((_d * self.nfreq).from_address(frequencies)) if frequencies else []
+        self.q = _view(_lib.fretlab_nanoparticle_q(self._handle), n * self.nfreq, 2, self)
+        mu = _lib.fretlab_nanoparticle_mu(self._handle)
+        self.mu = _view(mu, n * self.nfreq, 6, self) if mu else None
+        self.xyz = _view(_lib.fretlab_nanoparticle_xyz(self._handle), n, 3, self)
+
+    def __len__(self):
+        return len(self.xyz)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fretlab_nanoparticle_free(self._handle)
+            self._handle = None
+
+
+def reduce(values, n, origin, spacing, cutoff, keep_all=False):
+    """
+    Reduces a density grid (z fastest, not volume weighted) to weighted points.
+    Returns (weights, xyz) as new arrays.
+    """
+    address, count = _address(values, 1)
+    args = (address, (ctypes.c_int * 3)(*n), (_d * 3)(*origin), (_d * 3)(*spacing), cutoff, int(keep_all))
+    if count != n[0] * n[1] * n[2]:
+        raise ValueError('Grid values size does not match the grid dimensions.')
+
+    npoints = _check(_lib.fretlab_reduce(*args, None, None))
+    weights, xyz = _new_array(npoints), _new_array(3 * npoints)
+    _check(_lib.fretlab_reduce(*args, _address(weights, 1)[0], _address(xyz, 1)[0]))
+    if numpy is not None:
+        xyz = xyz.reshape(npoints, 3)
+    return weights, xyz
+
+
+def _points(obj):
+    weights, xyz = (obj.weights, obj.xyz) if isinstance(obj, Density) else obj
+    w_address, n = _address(weights, 1)
+    x_address, n_xyz = _address(xyz, 3)
+    if n != n_xyz:
+        raise ValueError('Weights and coordinates must have the same length.')
+    return w_address, x_address, n
+
+
+def acceptor_donor(acceptor, donor, overlap=False, omega_0=0.0, spectral_overlap=0.0):
+    """
+    Acceptor-donor coupling. acceptor and donor are Density objects or
+    (weights, xyz) pairs. Returns a dict with coulomb, overlap, total and keet.
+    """
+    result = (_d * 4)()
+    _check(_lib.fretlab_acceptor_donor(*_points(acceptor), *_points(donor),
+                                       int(overlap), omega_0, spectral_overlap, result))
+    return dict(zip(('coulomb', 'overlap', 'total', 'keet'), result))
+
+
+def acceptor_np(acceptor, nanoparticle, nfreq=1, mu=None):
+    """
+    Acceptor-nanoparticle coupling as a complex number, or a list with the
+    coupling at every frequency if there are several. nanoparticle is a
+    Nanoparticle object or a (q, xyz) pair; for a pair, q holds nfreq charge
+    sets per site and mu, if given, the dipoles of the same sets.
+    """
+    if isinstance(nanoparticle, Nanoparticle):
+        q, xyz, nfreq, mu = nanoparticle.q, nanoparticle.xyz, nanoparticle.nfreq, nanoparticle.mu
+    else:
+        q, xyz = nanoparticle
+    if nfreq < 1:
+        raise ValueError('The number of frequencies must be positive.')
+
+    q_address, nsets = _address(q, 2)
+    x_address, n = _address(xyz, 3)
+    if nsets != n * nfreq:
+        raise ValueError('Expected nfreq charges per site.')
+    mu_address = None
+    if mu is not None:
+        mu_address, n_mu = _address(mu, 6)
+        if n_mu != nsets:
+            raise ValueError('Dipoles and charges must have the same length.')
+
+    result = (_d * (2 * nfreq))()
+    _check(_lib.fretlab_acceptor_np(*_points(acceptor), q_address, mu_address, x_address, n, nfreq, result))
+    spectrum = [complex(result[2 * k], result[2 * k + 1]) for k in range(nfreq)]
+    return spectrum[0] if nfreq == 1 else spectrum
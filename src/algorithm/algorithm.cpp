@@ -5,14 +5,59 @@
 #include "parameters.hpp"
 #include "integrals.hpp"
 #include "nanoparticle.hpp"
+#include "progress.hpp"
+#include "perf_counters.hpp"
 
 #include <iostream>
+#include <future>
+#include <stdexcept>
+#include <atomic>
+#include <fstream>
+#include <algorithm>
+#include <optional>
 
 ///
 /// @brief Constructor for Algorithm.
 ///
-Algorithm::Algorithm(Output &out, Target &target) : out(out), target(target) {}
+Algorithm::Algorithm(Output &out, Target &target, Data_cache *cache) : out(out), target(target), cache(cache) {}
 
+//----------------------------------------------------------------------
+///
+/// @brief Runs the calculation selected in target.mode.
+///
+void Algorithm::run(const Target &target)
+{
+    integrals.screened = target.screening;
+    out.verbosity = target.verbosity;
+
+    // Heartbeat of the kernels while the calculation runs
+    std::optional<Progress> progress;
+    if (target.progress_interval > 0.0)
+        progress.emplace(out.progress_filename(), target.progress_interval);
+
+    switch (target.mode)
+    {
+    case TargetMode::IntegrateCube:
+        integrate_density(target);
+        break;
+
+    case TargetMode::Acceptor_Donor:
+        acceptor_donor(target);
+        break;
+
+    case TargetMode::Acceptor_NP:
+        acceptor_np(target);
+        break;
+
+    case TargetMode::Aggregate:
+        aggregate(target);
+        break;
+
+    case TargetMode::None:
+    default:
+        throw std::runtime_error("No valid calculation target specified in input.");
+    }
+}
 //----------------------------------------------------------------------
 ///
 /// @brief Integrates the density of the input cube file.
@@ -20,11 +65,14 @@ Algorithm::Algorithm(Output &out, Target &target) : out(out), target(target) {}
 void Algorithm::integrate_density(const Target &target)
 {
 
-    cube.read_density(target, false, "Cube");
+    cube = load_density(target, "Cube");
 
-    cube.int_density();
+    {
+        Perf_counters::Phase phase("Density integration");
+        cube->int_density(target.atomic_partition);
+    }
 
-    out.print_density(target.density_file_integration, cube);
+    out.print_density(target.density_file_integration, *cube);
 }
 //----------------------------------------------------------------------
 ///
@@ -33,21 +81,76 @@ void Algorithm::integrate_density(const Target &target)
 void Algorithm::acceptor_donor(const Target &target)
 {
     //
-    //  Read input files
+    //  Read input files. Cubes with the same grid values (homo-FRET) are
+    //  parsed and reduced once: the donor is the acceptor moved to its own
+    //  origin, or the acceptor itself if both are at the same place.
+    //  Otherwise the acceptor is parsed on a worker thread while the donor
+    //  is parsed here. With a cache the answer is kept for later jobs.
     //
-    cube_acceptor.read_density(target, false, "Acceptor");
+    if (same_grid_values(target))
+    {
+        cube_acceptor = load_density(target, "Acceptor");
+
+        cube_donor = std::make_shared<Density>();
+        cube_donor->read_translated(target, "Donor", *cube_acceptor);
+        if (cube_donor->same_placement(*cube_acceptor))
+            cube_donor = cube_acceptor;
+    }
+    else
+    {
+        auto acceptor_read = std::async(std::launch::async, [&]
+                                        { return load_density(target, "Acceptor"); });
+
+        cube_donor = load_density(target, "Donor");
 
-    cube_donor.read_density(target, false, "Donor");
+        cube_acceptor = acceptor_read.get(); // rethrows any reading error
+    }
     //
-    //   Print acceptor / donor density characteristics
+    //   Print acceptor / donor density characteristics (only once both are loaded)
     //
-    out.print_density(target.acceptor_density_file, cube_acceptor, Parameters::acceptor_header);
+    out.print_density(target.acceptor_density_file, *cube_acceptor, Parameters::acceptor_header);
 
-    out.print_density(target.donor_density_file, cube_donor, Parameters::donor_header);
+    out.print_density(target.donor_density_file, *cube_donor, Parameters::donor_header);
+
+    if (target.is_trajectory_present)
+    {
+        trajectory(target);
+        return;
+    }
     //
     //  Compute integrals
     //
-    integrals.acceptor_donor(target, cube_acceptor, cube_donor);
+    if (target.is_compression_present)
+    {
+        bool reused = false;
+        const auto op = compressed_operator(target, cube_acceptor, cube_acceptor->xyz, cube_donor, cube_donor->xyz, reused);
+
+        Perf_counters::Phase phase("Compressed AD kernel");
+        integrals.acceptor_donor(*op, cube_acceptor->rho_reduced, cube_acceptor->nchannels,
+                                 cube_donor->rho_reduced, cube_donor->nchannels,
+                                 target.calc_overlap_int, target.omega_0);
+
+        out.print_compression(*op, integrals.compression_error, reused);
+    }
+    else if (target.is_cutoff_sweep_present)
+    {
+        Perf_counters::Phase phase("Cutoff sweep AD kernel");
+        integrals.cutoff_sweep(*cube_acceptor, *cube_donor, target.sweep_cutoffs, target.sweep_tolerance);
+    }
+    else
+    {
+        {
+            Perf_counters::Phase phase("Acceptor-donor kernel");
+            integrals.acceptor_donor(target, *cube_acceptor, *cube_donor);
+        }
+
+        if (!target.checkpoint_file.empty())
+            out.print_checkpoint(target.checkpoint_file, integrals);
+        if (target.is_monte_carlo_present)
+            out.print_monte_carlo(target, integrals);
+        if (target.is_dipole_prescreen_present)
+            out.print_prescreen(target, integrals);
+    }
     //
     //  Print results
     //
@@ -60,24 +163,249 @@ void Algorithm::acceptor_donor(const Target &target)
 void Algorithm::acceptor_np(const Target &target)
 {
     //
-    //  Read input files
+    //  Read input files. Nanoparticle and acceptor are loaded concurrently.
     //
-    np.read_nanoparticle(target);
+    auto np_read = std::async(std::launch::async, [&]
+                              { return load_nanoparticle(target); });
+
+    cube_acceptor = load_density(target, "Acceptor");
 
-    cube_acceptor.read_density(target, false, "Acceptor");
+    np = np_read.get(); // rethrows any reading error
     //
     //  Print acceptor / donor density characteristics
     //
-    out.print_nanoparticle(np);
+    out.print_nanoparticle(*np);
+
+    out.print_density(target.acceptor_density_file, *cube_acceptor, Parameters::acceptor_header);
+
+    if (target.is_trajectory_present)
+    {
+        trajectory(target);
+        return;
+    }
+    //
+    //  Compute integrals
+    //
+    if (target.is_potential_map_present)
+    {
+        if (cube_acceptor->nchannels > 1)
+            throw std::runtime_error("Several acceptor states are only supported for acceptor-donor couplings.");
+
+        Potential_map map(*np, target.potential_map_tolerance);
+        map.load(target.potential_map_file);
+
+        {
+            Perf_counters::Phase phase("Potential map NP kernel");
+            integrals.acceptor_np(cube_acceptor->rho_reduced, cube_acceptor->xyz, map);
+        }
+        integrals.acceptor_nanoparticle_frequencies = np->frequencies;
+
+        if (map.blocks_built > 0)
+            map.save(target.potential_map_file);
+
+        out.print_potential_map(target.potential_map_file, map);
+    }
+    else if (target.is_compression_present)
+    {
+        if (cube_acceptor->nchannels > 1)
+            throw std::runtime_error("Several acceptor states are only supported for acceptor-donor couplings.");
+        if (!np->charges)
+            throw std::runtime_error("Compression needs a nanoparticle with charges only.");
+
+        bool reused = false;
+        const auto op = compressed_operator(target, cube_acceptor, cube_acceptor->xyz, np, np->xyz, reused);
+
+        {
+            Perf_counters::Phase phase("Compressed NP kernel");
+            integrals.acceptor_np(*op, cube_acceptor->rho_reduced, np->q, np->nfreq);
+        }
+        integrals.acceptor_nanoparticle_frequencies = np->frequencies;
+
+        out.print_compression(*op, integrals.compression_error, reused);
+    }
+    else if (target.is_cutoff_sweep_present)
+    {
+        {
+            Perf_counters::Phase phase("Cutoff sweep NP kernel");
+            integrals.cutoff_sweep(*cube_acceptor, *np, target.sweep_cutoffs, target.sweep_tolerance);
+        }
+        integrals.acceptor_nanoparticle_frequencies = np->frequencies;
+    }
+    else
+    {
+        {
+            Perf_counters::Phase phase("Acceptor-NP kernel");
+            integrals.acceptor_np(target, *cube_acceptor, *np);
+        }
+        if (target.is_monte_carlo_present)
+            out.print_monte_carlo(target, integrals);
+    }
+    //
+    //  Print results
+    //
+    out.print_results_integrals(target, integrals);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Couplings along the trajectory, for the loaded densities (and nanoparticle).
+///
+/// The time series is written to "<input>.series" while frames are processed;
+/// the log gets a summary.
+///
+void Algorithm::trajectory(const Target &target)
+{
+    const std::string series_file = out.output_filename.substr(0, out.output_filename.size() - 4) + ".series";
+    std::ofstream series(series_file);
+    if (!series)
+        throw std::runtime_error("Failed to open time series file: " + series_file);
 
-    out.print_density(target.acceptor_density_file, cube_acceptor, Parameters::acceptor_header);
+    std::unique_ptr<Potential_map> map;
+    if (target.is_potential_map_present)
+    {
+        map = std::make_unique<Potential_map>(*np, target.potential_map_tolerance);
+        map->load(target.potential_map_file);
+    }
+
+    Trajectory driver(target);
+    Perf_counters::Phase phase("Trajectory");
+    driver.run(*cube_acceptor, cube_donor.get(), target.mode == TargetMode::Acceptor_NP ? np.get() : nullptr, series, map.get());
+
+    if (map)
+    {
+        if (map->blocks_built > 0)
+            map->save(target.potential_map_file);
+        out.print_potential_map(target.potential_map_file, *map);
+    }
+
+    out.print_trajectory(target, driver, series_file);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Compute the coupling matrix among all chromophores of an aggregate.
+///
+/// Every density is read and reduced once. With a poses file the single
+/// density is placed at each pose; otherwise each file is one chromophore and
+/// the files are read concurrently (at most n_threads_OMP at a time).
+///
+void Algorithm::aggregate(const Target &target)
+{
+    // Each density goes through the same loader (and cache) as an acceptor
+    auto load_file = [&](const std::string &file)
+    {
+        Target single = target;
+        single.acceptor_density_file = file;
+        single.acceptor_density_files = {file};
+        return load_density(single, "Acceptor");
+    };
+
+    if (!target.aggregate_poses_file.empty())
+    {
+        const auto poses = Chromophore::read_poses(target.aggregate_poses_file);
+        if (poses.size() < 2)
+            throw std::runtime_error("Aggregate poses file needs at least two poses: " + target.aggregate_poses_file);
+
+        auto density = load_file(target.aggregate_density_files.front());
+
+        chromophores.assign(poses.size(), Chromophore{});
+        for (std::size_t c = 0; c < poses.size(); ++c)
+        {
+            chromophores[c].label = target.aggregate_density_files.front();
+            chromophores[c].build(*density, poses[c], Parameters::aggregate_cell_size);
+        }
+    }
+    else
+    {
+        const auto &files = target.aggregate_density_files;
+        chromophores.assign(files.size(), Chromophore{});
+
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]
+        {
+            for (std::size_t c = next++; c < files.size(); c = next++)
+            {
+                auto density = load_file(files[c]);
+                chromophores[c].label = files[c];
+                chromophores[c].build(*density, Pose{}, Parameters::aggregate_cell_size);
+            }
+        };
+
+        const std::size_t nworkers = std::clamp<std::size_t>(target.n_threads_OMP, 1, files.size());
+        std::vector<std::future<void>> workers;
+        for (std::size_t w = 0; w < nworkers; ++w)
+            workers.push_back(std::async(std::launch::async, worker));
+        for (auto &w : workers)
+            w.get(); // rethrows any reading error
+    }
+    //
+    //  Print chromophores
+    //
+    out.print_aggregate(chromophores);
     //
     //  Compute integrals
     //
-    integrals.acceptor_np(target, cube_acceptor, np);
+    {
+        Perf_counters::Phase phase("Aggregate kernel");
+        integrals.aggregate(chromophores, target.multipole_distance);
+    }
     //
     //  Print results
     //
     out.print_results_integrals(target, integrals);
 }
 //----------------------------------------------------------------------
+///
+/// @brief Builds the compressed operator between two point sets. With a cache
+/// (server mode) the operator is kept and reused by later jobs on the same data.
+///
+std::shared_ptr<H_matrix> Algorithm::compressed_operator(const Target &target,
+                                                         const std::shared_ptr<const void> &rows_owner, std::span<const std::array<double, 3>> rows,
+                                                         const std::shared_ptr<const void> &cols_owner, std::span<const std::array<double, 3>> cols,
+                                                         bool &reused)
+{
+    Perf_counters::Phase phase("Compression");
+    if (cache != nullptr)
+        return cache->h_matrix(rows_owner, rows, cols_owner, cols, target.compression_tolerance, reused);
+
+    reused = false;
+    return std::make_shared<H_matrix>(rows, cols, target.compression_tolerance);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads a density file, or takes it from the cache if present.
+///
+std::shared_ptr<Density> Algorithm::load_density(const Target &target, const std::string &what_dens)
+{
+    if (cache != nullptr)
+        return cache->density(target, what_dens);
+
+    auto density = std::make_shared<Density>();
+    density->read_density(target, false, what_dens);
+    return density;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Whether acceptor and donor hold the same grid values, taken from the
+/// cache if present.
+///
+bool Algorithm::same_grid_values(const Target &target)
+{
+    if (cache != nullptr)
+        return cache->same_grid_values(target);
+
+    return Density::same_grid_values(Density::density_files(target, "Acceptor"),
+                                     Density::density_files(target, "Donor"));
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads the nanoparticle file, or takes it from the cache if present.
+///
+std::shared_ptr<Nanoparticle> Algorithm::load_nanoparticle(const Target &target)
+{
+    if (cache != nullptr)
+        return cache->nanoparticle(target);
+
+    auto nanoparticle = std::make_shared<Nanoparticle>();
+    nanoparticle->read_nanoparticle(target);
+    return nanoparticle;
+}
+//----------------------------------------------------------------------
@@ -6,6 +6,15 @@
 #include "density.hpp"
 #include "integrals.hpp"
 #include "nanoparticle.hpp"
+#include "data_cache.hpp"
+#include "chromophore.hpp"
+#include "trajectory.hpp"
+#include "potential_map.hpp"
+#include "h_matrix.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 ///
 /// @class Algorithm
@@ -14,8 +23,13 @@
 class Algorithm
 {
 public:
-    /// Constructor
-    Algorithm(Output &out, Target &target);
+    /// Constructor. If a cache is given, input files are loaded through it.
+    Algorithm(Output &out, Target &target, Data_cache *cache = nullptr);
+
+    ///
+    /// @brief Runs the calculation selected in target.mode.
+    ///
+    void run(const Target &target);
 
     ///
     /// @brief Integrates density of input cube file.
@@ -32,14 +46,49 @@ public:
     ///
     void acceptor_np(const Target &target);
 
+    ///
+    /// @brief Compute the coupling matrix among all chromophores of an aggregate.
+    ///
+    void aggregate(const Target &target);
+
 private:
+    ///
+    /// @brief Reads a density file, or takes it from the cache if present.
+    ///
+    std::shared_ptr<Density> load_density(const Target &target, const std::string &what_dens);
+
+    ///
+    /// @brief Whether acceptor and donor hold the same grid values, taken from the cache if present.
+    ///
+    bool same_grid_values(const Target &target);
+
+    ///
+    /// @brief Reads the nanoparticle file, or takes it from the cache if present.
+    ///
+    std::shared_ptr<Nanoparticle> load_nanoparticle(const Target &target);
+
+    ///
+    /// @brief Compressed operator between two point sets, taken from the cache if present.
+    ///
+    std::shared_ptr<H_matrix> compressed_operator(const Target &target,
+                                                  const std::shared_ptr<const void> &rows_owner, std::span<const std::array<double, 3>> rows,
+                                                  const std::shared_ptr<const void> &cols_owner, std::span<const std::array<double, 3>> cols,
+                                                  bool &reused);
+
+    ///
+    /// @brief Couplings along the trajectory of the target, for the loaded molecules.
+    ///
+    void trajectory(const Target &target);
+
     Output &out;
     Target &target;
-    Density cube;
-    Density cube_acceptor;
-    Density cube_donor;
+    Data_cache *cache;
+    std::shared_ptr<Density> cube;
+    std::shared_ptr<Density> cube_acceptor;
+    std::shared_ptr<Density> cube_donor;
     Integrals integrals;
-    Nanoparticle np;
+    std::shared_ptr<Nanoparticle> np;
+    std::vector<Chromophore> chromophores;
 };
 
 #endif
@@ -0,0 +1,215 @@
+#include "data_cache.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+///
+/// @brief Constructor for Data_cache.
+///
+Data_cache::Data_cache(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)) {}
+
+//----------------------------------------------------------------------
+///
+/// @brief Returns the density for the given role, reading it on a cache miss.
+///
+std::shared_ptr<Density> Data_cache::density(const Target &target, const std::string &what_dens)
+{
+    const Key key = density_key(target, what_dens);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Entry *entry = find(key); entry != nullptr && entry->density)
+        {
+            ++hits;
+            return entry->density;
+        }
+        ++misses;
+    }
+
+    auto cube = std::make_shared<Density>();
+    cube->read_density(target, false, what_dens);
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(Entry{key, cube, nullptr});
+
+    return cube;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Whether acceptor and donor hold the same grid values, remembered per
+/// pair of file versions.
+///
+bool Data_cache::same_grid_values(const Target &target)
+{
+    const Key acceptor = density_key(target, "Acceptor");
+    const Key donor = density_key(target, "Donor");
+    const Key acceptor_file{acceptor.path, acceptor.mtime}, donor_file{donor.path, donor.mtime};
+
+    std::shared_ptr<Density> acceptor_cube, donor_cube;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = identities.begin(); it != identities.end(); ++it)
+        {
+            if (it->acceptor == acceptor_file && it->donor == donor_file)
+            {
+                identities.splice(identities.begin(), identities, it);
+                ++hits;
+                return it->same;
+            }
+        }
+        if (Entry *entry = find(acceptor); entry != nullptr)
+            acceptor_cube = entry->density;
+        if (Entry *entry = find(donor); entry != nullptr)
+            donor_cube = entry->density;
+    }
+
+    bool same = false;
+    if (acceptor_cube && donor_cube)
+        same = acceptor_cube->same_grid_values(*donor_cube);
+    else
+        same = Density::same_grid_values(Density::density_files(target, "Acceptor"), Density::density_files(target, "Donor"));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (acceptor_cube && donor_cube)
+        ++hits;
+    else
+        ++misses;
+    identities.push_front(Identity_entry{acceptor_file, donor_file, same});
+    while (identities.size() > capacity)
+        identities.pop_back();
+
+    return same;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Returns the nanoparticle of the target, reading it on a cache miss.
+///
+std::shared_ptr<Nanoparticle> Data_cache::nanoparticle(const Target &target)
+{
+    // Nanoparticle data does not depend on cutoff or overlap options. A
+    // frequency list is keyed by the list and every log file it names, newest
+    // file time, and kept apart from the same file read as a single log
+    std::string filepath = target.nanoparticle_file;
+    fs::file_time_type mtime = fs::last_write_time(target.nanoparticle_file);
+    if (target.nanoparticle_frequencies)
+    {
+        for (const auto &[omega, path] : Nanoparticle::read_frequency_list(target.nanoparticle_file))
+        {
+            filepath += "\n" + path;
+            mtime = std::max(mtime, fs::last_write_time(path));
+        }
+    }
+
+    Key key{filepath, mtime};
+    key.nanoparticle_frequencies = target.nanoparticle_frequencies;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Entry *entry = find(key); entry != nullptr && entry->nanoparticle)
+        {
+            ++hits;
+            return entry->nanoparticle;
+        }
+        ++misses;
+    }
+
+    auto np = std::make_shared<Nanoparticle>();
+    np->read_nanoparticle(target);
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(Entry{key, nullptr, np});
+
+    return np;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Returns the compressed operator between two cached point sets.
+///
+/// Operators whose owners were evicted (or replaced by a newer file) are
+/// dropped; the operator itself is built outside the lock.
+///
+std::shared_ptr<H_matrix> Data_cache::h_matrix(const std::shared_ptr<const void> &rows_owner, std::span<const std::array<double, 3>> rows,
+                                               const std::shared_ptr<const void> &cols_owner, std::span<const std::array<double, 3>> cols,
+                                               double tolerance, bool &reused)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        operators.remove_if([](const Operator_entry &e)
+                            { return e.rows_owner.expired() || e.cols_owner.expired(); });
+
+        for (auto it = operators.begin(); it != operators.end(); ++it)
+        {
+            if (it->rows_owner.lock() == rows_owner && it->cols_owner.lock() == cols_owner && it->tolerance == tolerance)
+            {
+                operators.splice(operators.begin(), operators, it);
+                ++hits;
+                reused = true;
+                return operators.front().op;
+            }
+        }
+        ++misses;
+    }
+
+    auto op = std::make_shared<H_matrix>(rows, cols, tolerance);
+    reused = false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    operators.push_front(Operator_entry{rows_owner, cols_owner, tolerance, op});
+    while (operators.size() > capacity)
+        operators.pop_back();
+
+    return op;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Key of the density files of a role: one key for the whole list of a
+/// multi-state density, with the newest file time.
+///
+Data_cache::Key Data_cache::density_key(const Target &target, const std::string &what_dens)
+{
+    std::string filepath;
+    fs::file_time_type mtime{};
+    for (const auto &path : Density::density_files(target, what_dens))
+    {
+        filepath += (filepath.empty() ? "" : "\n") + path;
+        mtime = std::max(mtime, fs::last_write_time(path));
+    }
+
+    return Key{filepath, mtime,
+               target.cutoff, target.calc_overlap_int, target.integrate_density, target.is_cutoff_sweep_present};
+}
+//----------------------------------------------------------------------
+///
+/// @brief Looks up an entry and marks it as most recently used.
+///
+Data_cache::Entry *Data_cache::find(const Key &key)
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            entries.splice(entries.begin(), entries, it);
+            return &entries.front();
+        }
+    }
+    return nullptr;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Inserts an entry, dropping stale versions of the same file and
+/// evicting the least recently used entries above capacity.
+///
+void Data_cache::insert(Entry entry)
+{
+    const bool is_density = static_cast<bool>(entry.density);
+    entries.remove_if([&](const Entry &e)
+                      { return e.key.path == entry.key.path &&
+                               static_cast<bool>(e.density) == is_density &&
+                               e.key.mtime != entry.key.mtime; });
+
+    entries.push_front(std::move(entry));
+    while (entries.size() > capacity)
+        entries.pop_back();
+}
+//----------------------------------------------------------------------
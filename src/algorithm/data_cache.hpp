@@ -0,0 +1,124 @@
+#ifndef DATA_CACHE_HPP
+#define DATA_CACHE_HPP
+
+#include "target.hpp"
+#include "density.hpp"
+#include "nanoparticle.hpp"
+#include "h_matrix.hpp"
+
+#include <string>
+#include <list>
+#include <memory>
+#include <filesystem>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <array>
+
+///
+/// @class Data_cache
+/// @brief Least-recently-used cache of loaded densities and nanoparticles.
+///
+/// Entries are keyed by file path, modification time and every input option
+/// that changes the loaded object (cutoff, overlap, integration, sweep order), so a cached
+/// object is always identical to a freshly read one. Lookups are thread-safe;
+/// files are read outside the lock so concurrent loads still overlap.
+///
+/// Whether the acceptor and donor of a job hold the same grid values is kept
+/// per pair of file versions, so later jobs on the same cubes don't read them
+/// again to find out.
+///
+/// Compressed operators are kept too, tied to the cached objects holding their
+/// points: a later job on the same densities (or nanoparticle) and tolerance
+/// reuses the operator instead of rebuilding it.
+///
+class Data_cache
+{
+public:
+    /// Constructor
+    explicit Data_cache(std::size_t capacity = 8);
+
+    /// @brief Returns the density for the given role ("Cube", "Acceptor", "Donor"), reading it if needed.
+    std::shared_ptr<Density> density(const Target &target, const std::string &what_dens);
+
+    /// @brief Returns the nanoparticle of the target, reading it if needed.
+    std::shared_ptr<Nanoparticle> nanoparticle(const Target &target);
+
+    ///
+    /// @brief True if the acceptor and donor cubes of the target hold the same grid
+    /// values (Density::same_grid_values). Loaded densities are compared in memory;
+    /// the files are read only if neither the answer nor both densities are cached.
+    ///
+    bool same_grid_values(const Target &target);
+
+    ///
+    /// @brief Returns the compressed operator between the points of two cached
+    /// objects, building it if needed.
+    /// @param rows_owner Object holding the row points (e.g. acceptor density).
+    /// @param cols_owner Object holding the column points (donor density or nanoparticle).
+    /// @param reused Set to true if the operator came from the cache.
+    ///
+    std::shared_ptr<H_matrix> h_matrix(const std::shared_ptr<const void> &rows_owner, std::span<const std::array<double, 3>> rows,
+                                       const std::shared_ptr<const void> &cols_owner, std::span<const std::array<double, 3>> cols,
+                                       double tolerance, bool &reused);
+
+    /// Number of requests served from the cache
+    std::size_t hits = 0;
+
+    /// Number of requests that needed a file read
+    std::size_t misses = 0;
+
+private:
+    /// @brief Identifies one loaded file.
+    struct Key
+    {
+        std::string path;
+        std::filesystem::file_time_type mtime;
+        double cutoff = 0.0;
+        bool calc_overlap_int = false;
+        bool integrate_density = false;
+        bool cutoff_sweep = false; ///< Points sorted by magnitude
+        bool nanoparticle_frequencies = false; ///< Frequency list rather than a single log
+
+        bool operator==(const Key &other) const = default;
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<Density> density;
+        std::shared_ptr<Nanoparticle> nanoparticle;
+    };
+
+    /// @brief Key of the density files of a role.
+    static Key density_key(const Target &target, const std::string &what_dens);
+
+    /// @brief Moves the matching entry to the front and returns it, or nullptr.
+    Entry *find(const Key &key);
+
+    /// @brief Inserts a new entry at the front, evicting the least recently used one.
+    void insert(Entry entry);
+
+    struct Operator_entry
+    {
+        std::weak_ptr<const void> rows_owner;
+        std::weak_ptr<const void> cols_owner;
+        double tolerance = 0.0;
+        std::shared_ptr<H_matrix> op;
+    };
+
+    struct Identity_entry
+    {
+        Key acceptor; ///< Path and file time only
+        Key donor;
+        bool same = false;
+    };
+
+    std::size_t capacity;
+    std::list<Entry> entries; ///< Most recently used first
+    std::list<Operator_entry> operators; ///< Most recently used first
+    std::list<Identity_entry> identities; ///< Most recently used first
+    std::mutex mutex;         ///< Guards entries and counters
+};
+
+#endif // DATA_CACHE_HPP
@@ -0,0 +1,97 @@
+#include "server.hpp"
+#include "input.hpp"
+#include "output.hpp"
+#include "timer.hpp"
+#include "algorithm.hpp"
+
+#include <exception>
+#include <stdexcept>
+
+///
+/// @brief Constructor for Server.
+///
+Server::Server(const Target &defaults) : defaults(defaults), cache(defaults.cache_size) {}
+
+//----------------------------------------------------------------------
+///
+/// @brief Reads input file paths, one per line, and answers each job.
+///
+void Server::run(std::istream &in, std::ostream &reply)
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        // Trim leading and trailing whitespace
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+        // Skip empty lines or comment lines (starting with '#' or '!')
+        if (line.empty() || line[0] == '#' || line[0] == '!')
+            continue;
+
+        if (line == "quit")
+            break;
+
+        try
+        {
+            const std::string log_file = run_job(line);
+            reply << "ok " << log_file << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            reply << "error " << line << ": " << e.what() << std::endl;
+        }
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Runs one input file and returns the name of its log file.
+///
+std::string Server::run_job(const std::string &input_file)
+{
+    Output out;
+    Timer timer;
+    Input inp;
+    Target target;
+
+    target.n_threads_OMP = defaults.n_threads_OMP;
+    target.thread_binding = defaults.thread_binding;
+    target.perf_counters = defaults.perf_counters;
+    target.input_filename = input_file;
+    inp.input_filename = input_file;
+    out.out_file_fill(input_file);
+
+    try
+    {
+        timer.initialize();
+        timer.start("total");
+        if (target.perf_counters)
+            timer.count_events();
+
+        out.open();
+        inp.check_input_file(out);
+
+        out.print_banner();
+
+        inp.read(target);
+        inp.print_input_info(out, target);
+
+        Algorithm algorithm(out, target, &cache);
+        algorithm.run(target);
+
+        timer.finish("total");
+        timer.conclude(out);
+        out.write_results(target, timer);
+
+        out.close();
+    }
+    catch (const std::exception &e)
+    {
+        out.stream() << " Error: " << e.what() << std::endl;
+        out.close();
+        throw;
+    }
+
+    return out.output_filename;
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,42 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "target.hpp"
+#include "data_cache.hpp"
+
+#include <string>
+#include <istream>
+#include <ostream>
+
+///
+/// @class Server
+/// @brief Long-lived mode that runs many input files in one process.
+///
+/// Jobs are input file paths read one per line from a stream (stdin when
+/// launched as "FretLab -server"). Each job writes the same .log file as a
+/// batch run, and one reply line is written per job:
+///
+///     ok <log file>
+///     error <input file>: <message>
+///
+/// Densities and nanoparticles are kept in a Data_cache between jobs.
+/// A line "quit" or end of stream stops the server.
+///
+class Server
+{
+public:
+    /// Constructor: command-line settings shared by all jobs.
+    Server(const Target &defaults);
+
+    /// @brief Processes jobs from @p in until "quit" or end of stream.
+    void run(std::istream &in, std::ostream &reply);
+
+private:
+    /// @brief Runs one input file, exactly as the batch binary would.
+    std::string run_job(const std::string &input_file);
+
+    Target defaults;
+    Data_cache cache;
+};
+
+#endif // SERVER_HPP
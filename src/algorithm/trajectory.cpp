@@ -0,0 +1,226 @@
+#include "trajectory.hpp"
+#include "trajectory_reader.hpp"
+#include "chromophore.hpp"
+#include "integrals.hpp"
+#include "parameters.hpp"
+#include "bounded_queue.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <iomanip>
+#include <exception>
+#include <stdexcept>
+
+namespace
+{
+  /// @brief Acceptor and donor placed at the pose of one frame.
+  struct Posed_frame
+  {
+    std::size_t index = 0;
+    Chromophore acceptor;
+    Chromophore donor;
+  };
+
+  /// @brief Cube atoms of a density, as the reference of its pose fit.
+  std::vector<std::array<double, 3>> reference_atoms(const Density &density)
+  {
+    std::vector<std::array<double, 3>> atoms(density.natoms);
+    for (int i = 0; i < density.natoms; ++i)
+      atoms[i] = {density.x[i], density.y[i], density.z[i]};
+    return atoms;
+  }
+} // namespace
+
+///
+/// @brief Constructor for Trajectory.
+///
+Trajectory::Trajectory(const Target &target) : target(target) {}
+
+//----------------------------------------------------------------------
+///
+/// @brief Runs the reader, pose and coupling stages over the whole trajectory.
+///
+void Trajectory::run(const Density &acceptor, const Density *donor, const Nanoparticle *np, std::ostream &series,
+                     Potential_map *map)
+{
+  if (acceptor.nchannels > 1 || (donor != nullptr && donor->nchannels > 1))
+    throw std::runtime_error("Trajectories need one density (state) per molecule.");
+
+  const auto acceptor_atoms = reference_atoms(acceptor);
+  const auto donor_atoms = donor != nullptr ? reference_atoms(*donor) : std::vector<std::array<double, 3>>{};
+  const std::size_t natoms = acceptor_atoms.size() + donor_atoms.size();
+
+  Bounded_queue<Trajectory_frame> frames(Parameters::trajectory_queue_size);
+  Bounded_queue<Posed_frame> posed(Parameters::trajectory_queue_size);
+
+  // First error of any stage; the other stages are stopped by closing the queues
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto fail = [&](std::exception_ptr e)
+  {
+    {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = e;
+    }
+    frames.close();
+    posed.close();
+  };
+
+  //
+  // Stage 1: read frames
+  //
+  std::thread reader([&]
+                     {
+    try
+    {
+      Trajectory_reader trajectory(target.trajectory_file);
+      Trajectory_frame frame;
+      while (trajectory.next(frame))
+      {
+        if (frame.xyz.size() != natoms)
+          throw std::runtime_error("Frame " + std::to_string(frame.index) + " has " + std::to_string(frame.xyz.size()) +
+                                   " atoms, the densities have " + std::to_string(natoms) + ".");
+        if (!frames.push(std::move(frame)))
+          break;
+        frame = Trajectory_frame{};
+      }
+      frames.close();
+    }
+    catch (...)
+    {
+      fail(std::current_exception());
+    } });
+
+  //
+  // Stage 2: fit the pose of each molecule and place its reduced density
+  //
+  std::thread placer([&]
+                     {
+    try
+    {
+      while (auto frame = frames.pop())
+      {
+        const std::span<const std::array<double, 3>> atoms(frame->xyz);
+
+        Posed_frame out;
+        out.index = frame->index;
+        out.acceptor.place(acceptor, Chromophore::fit_pose(acceptor_atoms, atoms.first(acceptor_atoms.size())));
+        if (donor != nullptr)
+          out.donor.place(*donor, Chromophore::fit_pose(donor_atoms, atoms.subspan(acceptor_atoms.size())));
+
+        if (!posed.push(std::move(out)))
+          break;
+      }
+      posed.close();
+    }
+    catch (...)
+    {
+      fail(std::current_exception());
+    } });
+
+  //
+  // Stage 3 (this thread): couplings, written as soon as computed
+  //
+  try
+  {
+    write_header(np, series);
+
+    Integrals integrals;
+    integrals.screened = target.screening;
+    while (auto frame = posed.pop())
+    {
+      const double time = static_cast<double>(frame->index) * target.trajectory_timestep;
+      series << std::setw(10) << frame->index << std::scientific << std::setprecision(8) << std::setw(18) << time
+             << std::setprecision(16);
+
+      if (donor != nullptr)
+      {
+        integrals.acceptor_donor(frame->acceptor.weights, frame->acceptor.xyz, frame->donor.weights, frame->donor.xyz, false, 0.0);
+
+        const double total = integrals.coulomb_acceptor_donor;
+        const double keet = 2.0 * Parameters::pi * total * total * target.spectral_overlap;
+        series << std::setw(26) << total << std::setw(26) << keet;
+        accumulate({total, 0.0}, keet);
+      }
+      else
+      {
+        if (map != nullptr)
+          integrals.acceptor_np(frame->acceptor.weights, frame->acceptor.xyz, *map);
+        else
+          integrals.acceptor_np(frame->acceptor.weights, frame->acceptor.xyz, np->q, np->xyz, np->nfreq, np->mu);
+
+        for (const auto &value : integrals.acceptor_nanoparticle_spectrum)
+          series << std::setw(26) << value[0] << std::setw(26) << value[1];
+        accumulate(integrals.acceptor_nanoparticle_spectrum.front(), 0.0);
+      }
+      series << "\n";
+
+      if (nframes % Parameters::trajectory_flush_frames == 0)
+        series.flush();
+    }
+    series.flush();
+  }
+  catch (...)
+  {
+    fail(std::current_exception());
+  }
+
+  reader.join();
+  placer.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  if (nframes > 0)
+  {
+    mean[0] /= static_cast<double>(nframes);
+    mean[1] /= static_cast<double>(nframes);
+    mean_keet /= static_cast<double>(nframes);
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Writes the column header of the time series.
+///
+void Trajectory::write_header(const Nanoparticle *np, std::ostream &series) const
+{
+  series << "# FretLab trajectory couplings (a.u.), time = frame * " << target.trajectory_timestep << "\n";
+  series << "#" << std::setw(9) << "frame" << std::setw(18) << "time";
+  if (np == nullptr)
+  {
+    series << std::setw(26) << "coulomb" << std::setw(26) << "keet";
+  }
+  else if (np->frequencies.empty())
+  {
+    series << std::setw(26) << "re" << std::setw(26) << "im";
+  }
+  else
+  {
+    for (std::size_t k = 0; k < np->frequencies.size(); ++k)
+      series << std::setw(26) << "re(w" + std::to_string(k + 1) + ")" << std::setw(26) << "im(w" + std::to_string(k + 1) + ")";
+  }
+  series << "\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Adds one frame to the statistics.
+///
+void Trajectory::accumulate(std::array<double, 2> value, double keet)
+{
+  if (nframes == 0)
+  {
+    min = value;
+    max = value;
+  }
+  for (int k = 0; k < 2; ++k)
+  {
+    mean[k] += value[k];
+    min[k] = std::min(min[k], value[k]);
+    max[k] = std::max(max[k], value[k]);
+  }
+  mean_keet += keet;
+  ++nframes;
+}
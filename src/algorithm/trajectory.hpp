@@ -0,0 +1,67 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include "target.hpp"
+#include "density.hpp"
+#include "nanoparticle.hpp"
+#include "potential_map.hpp"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <ostream>
+
+///
+/// @class Trajectory
+/// @brief Couplings along an MD trajectory of rigid acceptor/donor molecules.
+///
+/// Every frame holds the atoms of the acceptor followed by those of the donor
+/// (acceptor only for acceptor-NP, where the nanoparticle stays fixed), in
+/// the order of the cube files. The rigid-body pose of each molecule is fitted
+/// to its cube atoms and applied to the preloaded reduced density.
+///
+/// Three threads form a pipeline connected by bounded queues:
+///
+///     reader (frames) -> pose fit + placement -> coupling + output
+///
+/// so memory stays constant whatever the trajectory length. One line per
+/// frame is written to the time series stream as soon as it is computed.
+///
+class Trajectory
+{
+public:
+    /// Constructor
+    explicit Trajectory(const Target &target);
+
+    ///
+    /// @brief Runs the pipeline over the whole trajectory.
+    /// @param acceptor Reduced acceptor density.
+    /// @param donor Reduced donor density (acceptor-donor), or nullptr.
+    /// @param np Nanoparticle (acceptor-NP), or nullptr.
+    /// @param series Time series output.
+    /// @param map Potential map of the nanoparticle (acceptor-NP), or nullptr for direct sums.
+    ///
+    void run(const Density &acceptor, const Density *donor, const Nanoparticle *np, std::ostream &series,
+             Potential_map *map = nullptr);
+
+    std::size_t nframes = 0; ///< Frames processed
+
+    // Statistics of the main coupling: total potential (acceptor-donor) or
+    // real and imaginary part at the first frequency (acceptor-NP)
+    std::array<double, 2> mean{};
+    std::array<double, 2> min{};
+    std::array<double, 2> max{};
+    double mean_keet = 0.0;
+
+private:
+    /// @brief Writes the column header of the time series.
+    void write_header(const Nanoparticle *np, std::ostream &series) const;
+
+    /// @brief Adds one frame to the statistics.
+    void accumulate(std::array<double, 2> value, double keet);
+
+    const Target &target;
+};
+
+#endif // TRAJECTORY_HPP
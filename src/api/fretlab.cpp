@@ -0,0 +1,93 @@
+#include "fretlab.hpp"
+#include "integrals.hpp"
+#include "density.hpp"
+#include "parameters.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+namespace fretlab
+{
+    //----------------------------------------------------------------------
+    ///
+    /// @brief Reduces a grid density to the points above the cutoff.
+    ///
+    Reduced_density reduce(const Grid &grid, double cutoff, bool keep_all)
+    {
+        const std::size_t npoints = static_cast<std::size_t>(grid.n[0]) * grid.n[1] * grid.n[2];
+        if (grid.values.size() != npoints)
+        {
+            throw std::invalid_argument("Grid values size does not match the grid dimensions.");
+        }
+
+        // Same layout as a one-channel cube file, reduced by the same code
+        Density density;
+        density.nx = grid.n[0];
+        density.ny = grid.n[1];
+        density.nz = grid.n[2];
+        density.xmin = grid.origin[0];
+        density.ymin = grid.origin[1];
+        density.zmin = grid.origin[2];
+        density.dx = {grid.spacing[0], 0.0, 0.0};
+        density.dy = {0.0, grid.spacing[1], 0.0};
+        density.dz = {0.0, 0.0, grid.spacing[2]};
+        density.volume = grid.spacing[0] * grid.spacing[1] * grid.spacing[2];
+
+        density.rho.resize(npoints);
+        for (std::size_t v = 0; v < npoints; ++v)
+        {
+            density.rho[v] = grid.values[v] * density.volume;
+            density.maxdens = std::max(density.maxdens, std::abs(density.rho[v]));
+        }
+        density.maxdens_channel = {density.maxdens};
+
+        density.reduce(cutoff, keep_all);
+
+        Reduced_density reduced;
+        reduced.weights.assign(density.rho_reduced.begin(), density.rho_reduced.end());
+        reduced.xyz.assign(density.xyz.begin(), density.xyz.end());
+        return reduced;
+    }
+    //----------------------------------------------------------------------
+    ///
+    /// @brief Acceptor-donor coupling over in-memory point sets.
+    ///
+    Acceptor_donor_result acceptor_donor(Point_set acceptor, Point_set donor, const Coupling_options &options)
+    {
+        if (acceptor.weights.size() != acceptor.xyz.size() || donor.weights.size() != donor.xyz.size())
+        {
+            throw std::invalid_argument("Point set weights and coordinates must have the same length.");
+        }
+
+        Integrals integrals;
+        integrals.acceptor_donor(acceptor.weights, acceptor.xyz, donor.weights, donor.xyz,
+                                 options.overlap, options.omega_0);
+
+        Acceptor_donor_result result;
+        result.coulomb = integrals.coulomb_acceptor_donor;
+        result.overlap = integrals.overlap_acceptor_donor;
+        result.total = result.coulomb + result.overlap;
+        result.keet = 2.0 * Parameters::pi * result.total * result.total * options.spectral_overlap;
+        return result;
+    }
+    //----------------------------------------------------------------------
+    ///
+    /// @brief Acceptor-nanoparticle coupling over in-memory point sets.
+    ///
+    Acceptor_np_result acceptor_np(Point_set acceptor, Site_set np)
+    {
+        if (acceptor.weights.size() != acceptor.xyz.size() || np.nfreq < 1 || np.q.size() != np.xyz.size() * np.nfreq ||
+            (!np.mu.empty() && np.mu.size() != np.q.size()))
+        {
+            throw std::invalid_argument("Charges/dipoles/weights and coordinates must have matching lengths.");
+        }
+
+        Integrals integrals;
+        integrals.acceptor_np(acceptor.weights, acceptor.xyz, np.q, np.xyz, np.nfreq, np.mu);
+
+        return Acceptor_np_result{integrals.overlap_acceptor_nanoparticle, integrals.acceptor_nanoparticle_spectrum};
+    }
+    //----------------------------------------------------------------------
+
+} // namespace fretlab
@@ -0,0 +1,128 @@
+#ifndef FRETLAB_HPP
+#define FRETLAB_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+
+///
+/// @namespace fretlab
+/// @brief In-memory interface to the FretLab coupling engine.
+///
+/// These functions take densities and nanoparticle sites as plain arrays and
+/// return structured results, without reading or writing any file. They are
+/// the entry points of the fretlab_core library for embedding FretLab in
+/// other programs; the FretLab executable uses the same kernels.
+///
+/// All quantities are in atomic units (coordinates in Bohr).
+///
+namespace fretlab
+{
+    /// API version, incremented on incompatible changes.
+    constexpr int api_version = 2;
+
+    ///
+    /// @brief A density as a set of weighted points.
+    ///
+    /// Weights are density values multiplied by the voxel volume, as stored in
+    /// Density::rho_reduced. Both spans must have the same length.
+    ///
+    struct Point_set
+    {
+        std::span<const double> weights;
+        std::span<const std::array<double, 3>> xyz;
+    };
+
+    ///
+    /// @brief Nanoparticle sites with complex charges (real, imaginary) and,
+    /// optionally, complex dipoles (real xyz, imaginary xyz).
+    ///
+    /// With nfreq > 1, q and mu hold nfreq sets per site, indexed
+    /// [site * nfreq + frequency], as in Nanoparticle. An empty mu means
+    /// charges only.
+    ///
+    struct Site_set
+    {
+        std::span<const std::array<double, 2>> q;
+        std::span<const std::array<double, 3>> xyz;
+        int nfreq = 1;
+        std::span<const std::array<double, 6>> mu;
+    };
+
+    ///
+    /// @brief A density on a regular orthogonal grid (cube file layout).
+    ///
+    /// Values are ordered with z running fastest, then y, then x, and are not
+    /// yet multiplied by the voxel volume.
+    ///
+    struct Grid
+    {
+        std::span<const double> values;
+        std::array<int, 3> n{};           ///< Number of points along x, y, z
+        std::array<double, 3> origin{};   ///< Position of the first point
+        std::array<double, 3> spacing{};  ///< Voxel size along x, y, z
+    };
+
+    ///
+    /// @brief Density reduced to the points that enter the integrals.
+    ///
+    struct Reduced_density
+    {
+        std::vector<double> weights;
+        std::vector<std::array<double, 3>> xyz;
+
+        Point_set points() const { return {weights, xyz}; }
+    };
+
+    ///
+    /// @brief Options of the acceptor-donor coupling.
+    ///
+    struct Coupling_options
+    {
+        bool overlap = false;          ///< Add the overlap term -omega_0 * sum(rho_A * rho_D)
+        double omega_0 = 0.0;          ///< Incident frequency (overlap term)
+        double spectral_overlap = 0.0; ///< Spectral overlap J (EET rate)
+    };
+
+    ///
+    /// @brief Acceptor-donor coupling results.
+    ///
+    struct Acceptor_donor_result
+    {
+        double coulomb = 0.0;
+        double overlap = 0.0;
+        double total = 0.0;   ///< coulomb + overlap
+        double keet = 0.0;    ///< 2 pi |V|^2 J
+    };
+
+    ///
+    /// @brief Acceptor-nanoparticle coupling results.
+    ///
+    struct Acceptor_np_result
+    {
+        std::array<double, 2> coupling{}; ///< Real and imaginary part (first frequency)
+        std::vector<std::array<double, 2>> spectrum; ///< Coupling at every frequency
+    };
+
+    ///
+    /// @brief Keeps the grid points with |rho * volume| > cutoff * max|rho * volume|
+    /// (all of them if keep_all is set, as needed by the overlap integral), with
+    /// the same reduction (Density::reduce) as the FretLab executable.
+    ///
+    Reduced_density reduce(const Grid &grid, double cutoff, bool keep_all = false);
+
+    ///
+    /// @brief Screened Coulomb (and optional overlap) coupling between two densities.
+    ///
+    Acceptor_donor_result acceptor_donor(Point_set acceptor, Point_set donor,
+                                         const Coupling_options &options = {});
+
+    ///
+    /// @brief Coupling between a density and the induced charges (and dipoles)
+    /// of a nanoparticle, at every frequency.
+    ///
+    Acceptor_np_result acceptor_np(Point_set acceptor, Site_set np);
+
+} // namespace fretlab
+
+#endif // FRETLAB_HPP
@@ -0,0 +1,197 @@
+#include "fretlab_c.h"
+#include "fretlab.hpp"
+#include "density.hpp"
+#include "nanoparticle.hpp"
+#include "target.hpp"
+
+#include <array>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+struct fretlab_density
+{
+    Density density;
+};
+
+struct fretlab_nanoparticle
+{
+    Nanoparticle np;
+};
+
+namespace
+{
+    thread_local std::string last_error;
+
+    // Runs f and converts any exception into an error code and message.
+    template <typename F, typename R>
+    R guarded(F &&f, R on_error)
+    {
+        try
+        {
+            last_error.clear();
+            return f();
+        }
+        catch (const std::exception &e)
+        {
+            last_error = e.what();
+        }
+        catch (...)
+        {
+            last_error = "Unknown error.";
+        }
+        return on_error;
+    }
+
+    std::span<const std::array<double, 3>> as_xyz(const double *xyz, size_t n)
+    {
+        return {reinterpret_cast<const std::array<double, 3> *>(xyz), n};
+    }
+
+    std::span<const std::array<double, 2>> as_q(const double *q, size_t n)
+    {
+        return {reinterpret_cast<const std::array<double, 2> *>(q), n};
+    }
+
+    std::span<const std::array<double, 6>> as_mu(const double *mu, size_t n)
+    {
+        if (mu == nullptr)
+            return {};
+        return {reinterpret_cast<const std::array<double, 6> *>(mu), n};
+    }
+} // namespace
+
+const char *fretlab_last_error(void) { return last_error.c_str(); }
+
+int fretlab_api_version(void) { return fretlab::api_version; }
+
+//----------------------------------------------------------------------
+fretlab_density *fretlab_density_read(const char *path, double cutoff, int keep_all)
+{
+    auto task = [&]
+    {
+        Target target;
+        target.acceptor_density_file = path;
+        target.cutoff = cutoff;
+        target.calc_overlap_int = keep_all != 0;
+
+        auto handle = std::make_unique<fretlab_density>();
+        handle->density.read_density(target, false, "Acceptor");
+        return handle.release();
+    };
+    return guarded(task, static_cast<fretlab_density *>(nullptr));
+}
+
+void fretlab_density_free(fretlab_density *density) { delete density; }
+
+size_t fretlab_density_size(const fretlab_density *density) { return density->density.rho_reduced.size(); }
+
+const double *fretlab_density_weights(const fretlab_density *density) { return density->density.rho_reduced.data(); }
+
+const double *fretlab_density_xyz(const fretlab_density *density) { return reinterpret_cast<const double *>(density->density.xyz.data()); }
+//----------------------------------------------------------------------
+fretlab_nanoparticle *fretlab_nanoparticle_read(const char *path, int frequency_list)
+{
+    auto task = [&]
+    {
+        Target target;
+        target.nanoparticle_file = path;
+        target.nanoparticle_frequencies = frequency_list != 0;
+
+        auto handle = std::make_unique<fretlab_nanoparticle>();
+        handle->np.read_nanoparticle(target);
+        return handle.release();
+    };
+    return guarded(task, static_cast<fretlab_nanoparticle *>(nullptr));
+}
+
+void fretlab_nanoparticle_free(fretlab_nanoparticle *np) { delete np; }
+
+size_t fretlab_nanoparticle_size(const fretlab_nanoparticle *np) { return np->np.xyz.size(); }
+
+int fretlab_nanoparticle_nfreq(const fretlab_nanoparticle *np) { return np->np.nfreq; }
+
+const double *fretlab_nanoparticle_frequencies(const fretlab_nanoparticle *np)
+{
+    return np->np.frequencies.empty() ? nullptr : np->np.frequencies.data();
+}
+
+const double *fretlab_nanoparticle_q(const fretlab_nanoparticle *np) { return reinterpret_cast<const double *>(np->np.q.data()); }
+
+const double *fretlab_nanoparticle_mu(const fretlab_nanoparticle *np)
+{
+    return np->np.charges_and_dipoles ? reinterpret_cast<const double *>(np->np.mu.data()) : nullptr;
+}
+
+const double *fretlab_nanoparticle_xyz(const fretlab_nanoparticle *np) { return reinterpret_cast<const double *>(np->np.xyz.data()); }
+//----------------------------------------------------------------------
+long fretlab_reduce(const double *values, const int n[3], const double origin[3], const double spacing[3],
+                    double cutoff, int keep_all, double *weights, double *xyz)
+{
+    auto task = [&]
+    {
+        const size_t npoints = static_cast<size_t>(n[0]) * n[1] * n[2];
+        const fretlab::Grid grid{{values, npoints}, {n[0], n[1], n[2]},
+                                 {origin[0], origin[1], origin[2]}, {spacing[0], spacing[1], spacing[2]}};
+
+        const auto reduced = fretlab::reduce(grid, cutoff, keep_all != 0);
+        if (weights != nullptr && xyz != nullptr)
+        {
+            for (size_t i = 0; i < reduced.weights.size(); ++i)
+            {
+                weights[i] = reduced.weights[i];
+                xyz[3 * i + 0] = reduced.xyz[i][0];
+                xyz[3 * i + 1] = reduced.xyz[i][1];
+                xyz[3 * i + 2] = reduced.xyz[i][2];
+            }
+        }
+        return static_cast<long>(reduced.weights.size());
+    };
+    return guarded(task, -1L);
+}
+//----------------------------------------------------------------------
+int fretlab_acceptor_donor(const double *w_acc, const double *xyz_acc, size_t n_acc,
+                           const double *w_don, const double *xyz_don, size_t n_don,
+                           int overlap, double omega_0, double spectral_overlap, double result[4])
+{
+    auto task = [&]
+    {
+        fretlab::Coupling_options options;
+        options.overlap = overlap != 0;
+        options.omega_0 = omega_0;
+        options.spectral_overlap = spectral_overlap;
+
+        const auto r = fretlab::acceptor_donor({{w_acc, n_acc}, as_xyz(xyz_acc, n_acc)},
+                                               {{w_don, n_don}, as_xyz(xyz_don, n_don)}, options);
+        result[0] = r.coulomb;
+        result[1] = r.overlap;
+        result[2] = r.total;
+        result[3] = r.keet;
+        return 0;
+    };
+    return guarded(task, -1);
+}
+//----------------------------------------------------------------------
+int fretlab_acceptor_np(const double *w_acc, const double *xyz_acc, size_t n_acc,
+                        const double *q, const double *mu, const double *xyz_np, size_t n_np, int nfreq,
+                        double *result)
+{
+    auto task = [&]
+    {
+        if (nfreq < 1)
+            throw std::invalid_argument("The number of frequencies must be positive.");
+
+        const size_t nsets = n_np * static_cast<size_t>(nfreq);
+        const auto r = fretlab::acceptor_np({{w_acc, n_acc}, as_xyz(xyz_acc, n_acc)},
+                                            {as_q(q, nsets), as_xyz(xyz_np, n_np), nfreq, as_mu(mu, nsets)});
+        for (int k = 0; k < nfreq; ++k)
+        {
+            result[2 * k] = r.spectrum[k][0];
+            result[2 * k + 1] = r.spectrum[k][1];
+        }
+        return 0;
+    };
+    return guarded(task, -1);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,77 @@
+#ifndef FRETLAB_C_H
+#define FRETLAB_C_H
+
+/*
+ * C interface to the FretLab coupling engine (libfretlab).
+ *
+ * Used by the Python bindings (python/fretlab.py) through ctypes, but usable
+ * from any language with a C FFI. Arrays are passed as pointers to contiguous
+ * doubles and are never copied: coordinates are n x 3, charges n x 2 and
+ * dipoles n x 6 (real xyz, imaginary xyz). With nfreq frequencies, charges
+ * and dipoles hold nfreq sets per site, indexed [site * nfreq + frequency].
+ *
+ * Functions returning int give 0 on success and -1 on error; the message of
+ * the last error on the calling thread is returned by fretlab_last_error().
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fretlab_density fretlab_density;
+typedef struct fretlab_nanoparticle fretlab_nanoparticle;
+
+const char *fretlab_last_error(void);
+int fretlab_api_version(void);
+
+/* Densities read from cube files (reduced with cutoff; all points if keep_all) */
+fretlab_density *fretlab_density_read(const char *path, double cutoff, int keep_all);
+void fretlab_density_free(fretlab_density *density);
+size_t fretlab_density_size(const fretlab_density *density);
+const double *fretlab_density_weights(const fretlab_density *density);
+const double *fretlab_density_xyz(const fretlab_density *density);
+
+/*
+ * Nanoparticles read from a log file, or from a frequency list file (one
+ * "frequency  log file" pair per line) if frequency_list is set. The size is
+ * the number of sites; mu is NULL for a charges-only model and frequencies
+ * is NULL for a single log file.
+ */
+fretlab_nanoparticle *fretlab_nanoparticle_read(const char *path, int frequency_list);
+void fretlab_nanoparticle_free(fretlab_nanoparticle *np);
+size_t fretlab_nanoparticle_size(const fretlab_nanoparticle *np);
+int fretlab_nanoparticle_nfreq(const fretlab_nanoparticle *np);
+const double *fretlab_nanoparticle_frequencies(const fretlab_nanoparticle *np);
+const double *fretlab_nanoparticle_q(const fretlab_nanoparticle *np);
+const double *fretlab_nanoparticle_mu(const fretlab_nanoparticle *np);
+const double *fretlab_nanoparticle_xyz(const fretlab_nanoparticle *np);
+
+/*
+ * Reduces a grid (z fastest, values not volume weighted). With weights and
+ * xyz set to NULL only the number of reduced points is computed. Returns the
+ * number of points, or -1 on error.
+ */
+long fretlab_reduce(const double *values, const int n[3], const double origin[3], const double spacing[3],
+                    double cutoff, int keep_all, double *weights, double *xyz);
+
+/* result: coulomb, overlap, total, keet */
+int fretlab_acceptor_donor(const double *w_acc, const double *xyz_acc, size_t n_acc,
+                           const double *w_don, const double *xyz_don, size_t n_don,
+                           int overlap, double omega_0, double spectral_overlap, double result[4]);
+
+/*
+ * Coupling with n_np sites and nfreq charge (and dipole, if mu is not NULL)
+ * sets per site. result: real and imaginary part at every frequency, 2 * nfreq
+ * values.
+ */
+int fretlab_acceptor_np(const double *w_acc, const double *xyz_acc, size_t n_acc,
+                        const double *q, const double *mu, const double *xyz_np, size_t n_np, int nfreq,
+                        double *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRETLAB_C_H */
@@ -0,0 +1,256 @@
+#include "synthetic.hpp"
+#include "density.hpp"
+#include "nanoparticle.hpp"
+#include "integrals.hpp"
+#include "target.hpp"
+#include "string_manipulation.hpp"
+
+#include <omp.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <filesystem>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+//---------------------------------------------------------------------------
+//
+//   fretlab_bench: synthetic Gaussian densities with exact couplings.
+//
+//   fretlab_bench [-sizes 16,24,32] [-threads 1,2,4] [-separation R]
+//                 [-cutoff c] [-sites N] [-bare] [-tolerance t] [-write dir]
+//
+//   Without -write, writes the cubes of every grid size to a scratch
+//   directory and times Density::read_density and the Integrals kernels for
+//   every thread count, reporting throughput and the error against the
+//   analytic couplings. With -tolerance, exits with 1 if an error exceeds it.
+//   With -write, writes the cubes, nanoparticle log, FretLab inputs and the
+//   exact couplings of the first size to dir instead.
+//
+//---------------------------------------------------------------------------
+
+namespace
+{
+  struct Options
+  {
+    std::vector<int> sizes = {16, 24, 32};
+    std::vector<int> threads = {1};
+    double separation = 10.0; ///< Acceptor-donor distance; the NP plane is at -separation (Bohr)
+    double cutoff = 1.0e-12;
+    int sites = 400;
+    bool screened = true;
+    double tolerance = 0.0; ///< 0: no check
+    std::string write_dir;
+  };
+  //----------------------------------------------------------------------
+  std::vector<int> int_list(const std::string &value)
+  {
+    String_manipulation str_manipulation;
+    std::vector<int> list;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+      int number = 0;
+      str_manipulation.string_to_int(item, number);
+      if (number < 1)
+        throw std::runtime_error("List values must be positive: '" + value + "'");
+      list.push_back(number);
+    }
+    if (list.empty())
+      throw std::runtime_error("Empty list: '" + value + "'");
+    return list;
+  }
+  //----------------------------------------------------------------------
+  Options parse_options(int argc, char *argv[])
+  {
+    String_manipulation str_manipulation;
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string a = argv[i];
+      if (a == "-bare")
+      {
+        options.screened = false;
+        continue;
+      }
+      if (i + 1 >= argc)
+        throw std::runtime_error("Missing value for " + a);
+      const std::string value = argv[++i];
+
+      if (a == "-sizes")
+        options.sizes = int_list(value);
+      else if (a == "-threads")
+        options.threads = int_list(value);
+      else if (a == "-separation")
+        str_manipulation.string_to_float(value, options.separation);
+      else if (a == "-cutoff")
+        str_manipulation.string_to_float(value, options.cutoff);
+      else if (a == "-sites")
+        str_manipulation.string_to_int(value, options.sites);
+      else if (a == "-tolerance")
+        str_manipulation.string_to_float(value, options.tolerance);
+      else if (a == "-write")
+        options.write_dir = value;
+      else
+        throw std::runtime_error("Unknown option: " + a);
+    }
+
+    if (options.sites < 1 || options.cutoff < 0.0 || options.separation <= 0.0)
+      throw std::runtime_error("Sites and separation must be positive, and the cutoff non-negative.");
+    return options;
+  }
+  //----------------------------------------------------------------------
+  double seconds_since(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Writes the inputs of one case and the FretLab input files.
+  ///
+  void write_case(const Options &options, const std::vector<Synthetic::Gaussian> &acceptor,
+                  const std::vector<Synthetic::Gaussian> &donor, const std::vector<Synthetic::Site> &sites)
+  {
+    fs::create_directories(options.write_dir);
+    const fs::path dir = options.write_dir;
+    const int n = options.sizes.front();
+
+    Synthetic::write_cube((dir / "acceptor.cub").string(), Synthetic::grid_around(acceptor, n), acceptor);
+    Synthetic::write_cube((dir / "donor.cub").string(), Synthetic::grid_around(donor, n), donor);
+    Synthetic::write_np_log((dir / "nanoparticle.log").string(), sites);
+
+    const std::string screening = options.screened ? "" : "screening: no\n";
+    std::ofstream(dir / "acceptor_donor.inp") << "acceptor density: acceptor.cub\ndonor density: donor.cub\n"
+                                              << "cutoff: " << options.cutoff << "\nspectral overlap: 1.0\n" << screening;
+    std::ofstream(dir / "acceptor_np.inp") << "acceptor density: acceptor.cub\nnanoparticle: nanoparticle.log\n"
+                                           << "cutoff: " << options.cutoff << "\n" << screening;
+
+    const auto exact_np = Synthetic::acceptor_np(acceptor, sites, options.screened);
+    std::ofstream exact(dir / "exact.txt");
+    exact << std::scientific << std::setprecision(16)
+          << "acceptor-donor " << Synthetic::acceptor_donor(acceptor, donor, options.screened) << "\n"
+          << "acceptor-np    " << exact_np[0] << " " << exact_np[1] << "\n";
+
+    std::cout << " Wrote " << n << "^3 case to " << dir.string() << " (exact couplings in exact.txt)\n";
+  }
+} // namespace
+//---------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  try
+  {
+    Options options = parse_options(argc, argv);
+
+    const auto acceptor = Synthetic::dipolar_pair({0.0, 0.0, 0.0}, 1.0, 1.0, 1.5);
+    const auto donor = Synthetic::dipolar_pair({options.separation, 0.0, 0.0}, 1.0, 1.0, 1.5);
+    const auto sites = Synthetic::site_lattice(options.sites, -options.separation, 2.0);
+
+    if (!options.write_dir.empty())
+    {
+      write_case(options, acceptor, donor, sites);
+      return 0;
+    }
+
+#ifndef _OPENMP
+    if (options.threads.size() > 1 || options.threads.front() > 1)
+      std::cout << " Warning: built without OpenMP; running with 1 thread.\n";
+    options.threads = {1};
+#endif
+
+    const double exact_ad = Synthetic::acceptor_donor(acceptor, donor, options.screened);
+    const auto exact_np = Synthetic::acceptor_np(acceptor, sites, options.screened);
+
+    const fs::path scratch = fs::temp_directory_path() / ("fretlab_bench_" + std::to_string(getpid()));
+    fs::create_directories(scratch);
+
+    Target target;
+    target.acceptor_density_files = {(scratch / "acceptor.cub").string()};
+    target.donor_density_files = {(scratch / "donor.cub").string()};
+    target.nanoparticle_file = (scratch / "nanoparticle.log").string();
+    target.cutoff = options.cutoff;
+    target.is_cutoff_present = true;
+
+    Synthetic::write_np_log(target.nanoparticle_file, sites);
+    Nanoparticle np;
+    np.read_nanoparticle(target);
+
+    std::cout << std::scientific << std::setprecision(10)
+              << "\n Exact acceptor-donor coupling : " << exact_ad << " a.u.\n"
+              << " Exact acceptor-NP coupling    : " << exact_np[0] << " + " << exact_np[1] << " i a.u.  ("
+              << options.sites << " sites)\n"
+              << " Kernel: " << (options.screened ? "screened" : "bare") << ", cutoff " << std::setprecision(2)
+              << options.cutoff << "\n\n";
+
+    std::cout << "     n    points_A    points_D  threads    read (s)     A-D (s)     pairs/s   A-D error    A-NP (s)  A-NP error\n";
+
+    double worst = 0.0;
+    for (const int n : options.sizes)
+    {
+      Synthetic::write_cube(target.acceptor_density_files.front(), Synthetic::grid_around(acceptor, n), acceptor);
+      Synthetic::write_cube(target.donor_density_files.front(), Synthetic::grid_around(donor, n), donor);
+
+      for (const int t : options.threads)
+      {
+#ifdef _OPENMP
+        omp_set_num_threads(t);
+#endif
+        auto start = std::chrono::steady_clock::now();
+        Density cube_acceptor, cube_donor;
+        cube_acceptor.read_density(target, false, "Acceptor");
+        cube_donor.read_density(target, false, "Donor");
+        const double read_time = seconds_since(start);
+
+        Integrals integrals;
+        integrals.screened = options.screened;
+
+        start = std::chrono::steady_clock::now();
+        integrals.acceptor_donor(target, cube_acceptor, cube_donor);
+        const double ad_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        integrals.acceptor_np(target, cube_acceptor, np);
+        const double np_time = seconds_since(start);
+
+        const double pairs = static_cast<double>(cube_acceptor.xyz.size()) * cube_donor.xyz.size();
+        const double ad_error = std::abs(integrals.coulomb_acceptor_donor - exact_ad) / std::abs(exact_ad);
+        const double np_error = std::hypot(integrals.overlap_acceptor_nanoparticle[0] - exact_np[0],
+                                           integrals.overlap_acceptor_nanoparticle[1] - exact_np[1]) /
+                                std::hypot(exact_np[0], exact_np[1]);
+        worst = std::max({worst, ad_error, np_error});
+
+        std::cout << std::setw(6) << n << std::setw(12) << cube_acceptor.xyz.size() << std::setw(12) << cube_donor.xyz.size()
+                  << std::setw(9) << t << std::fixed << std::setprecision(4) << std::setw(12) << read_time
+                  << std::setw(12) << ad_time << std::scientific << std::setprecision(3)
+                  << std::setw(12) << pairs / ad_time << std::setw(12) << ad_error
+                  << std::fixed << std::setprecision(4) << std::setw(12) << np_time
+                  << std::scientific << std::setprecision(3) << std::setw(12) << np_error << "\n";
+      }
+    }
+
+    fs::remove_all(scratch);
+
+    if (options.tolerance > 0.0 && worst > options.tolerance)
+    {
+      std::cout << "\n Error " << worst << " above tolerance " << options.tolerance << "\n";
+      return 1;
+    }
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "\n ERROR: " << e.what() << "\n" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
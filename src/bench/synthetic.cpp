@@ -0,0 +1,224 @@
+#include "synthetic.hpp"
+#include "parameters.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+  ///
+  /// @brief Interaction of two unit charges smeared with 1 / mu = 1 / alpha + 1 / beta (+ a^2) at distance R.
+  ///
+  double smeared(double inv_mu, double dist)
+  {
+    const double root_mu = 1.0 / std::sqrt(inv_mu);
+    if (dist < 1.0e-12)
+      return 2.0 * root_mu / std::sqrt(Parameters::pi);
+    return std::erf(root_mu * dist) / dist;
+  }
+  //----------------------------------------------------------------------
+  double distance(const std::array<double, 3> &a, const std::array<double, 3> &b)
+  {
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+  }
+  //----------------------------------------------------------------------
+  struct File_closer
+  {
+    void operator()(std::FILE *file) const { std::fclose(file); }
+  };
+
+  std::unique_ptr<std::FILE, File_closer> open_for_writing(const std::string &path)
+  {
+    std::unique_ptr<std::FILE, File_closer> file(std::fopen(path.c_str(), "w"));
+    if (!file)
+      throw std::runtime_error("Could not write file " + path);
+    return file;
+  }
+} // namespace
+//----------------------------------------------------------------------
+namespace Synthetic
+{
+  ///
+  /// @brief +charge at center + separation / 2 z, -charge at center - separation / 2 z.
+  ///
+  std::vector<Gaussian> dipolar_pair(const std::array<double, 3> &center, double charge, double exponent, double separation)
+  {
+    Gaussian plus{charge, exponent, center};
+    Gaussian minus{-charge, exponent, center};
+    plus.center[2] += 0.5 * separation;
+    minus.center[2] -= 0.5 * separation;
+    return {plus, minus};
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Square lattice of sites in the plane x = x_plane, centered on the y and z axes.
+  ///
+  std::vector<Site> site_lattice(int nsites, double x_plane, double spacing)
+  {
+    const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nsites)))));
+    std::vector<Site> sites;
+    sites.reserve(nsites);
+
+    for (int k = 0; k < nsites; ++k)
+    {
+      const int iy = k / side;
+      const int iz = k % side;
+      Site site;
+      site.center = {x_plane, (iy - 0.5 * (side - 1)) * spacing, (iz - 0.5 * (side - 1)) * spacing};
+      site.q = {1.0e-3 * std::cos(0.7 * k), 1.0e-4 * std::sin(1.3 * k)};
+      sites.push_back(site);
+    }
+    return sites;
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Cubic grid covering every Gaussian up to exp(-alpha r^2) = 1e-12.
+  ///
+  Grid grid_around(std::span<const Gaussian> gaussians, int n)
+  {
+    if (gaussians.empty() || n < 2)
+      throw std::invalid_argument("A grid needs Gaussians and at least 2 points per side.");
+
+    std::array<double, 3> low, high;
+    low.fill(1.0e300);
+    high.fill(-1.0e300);
+    for (const auto &g : gaussians)
+    {
+      const double reach = std::sqrt(-std::log(1.0e-12) / g.exponent);
+      for (int k = 0; k < 3; ++k)
+      {
+        low[k] = std::min(low[k], g.center[k] - reach);
+        high[k] = std::max(high[k], g.center[k] + reach);
+      }
+    }
+
+    const double side = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2]});
+    Grid grid;
+    grid.n = n;
+    grid.spacing = side / (n - 1);
+    for (int k = 0; k < 3; ++k)
+      grid.origin[k] = 0.5 * (low[k] + high[k]) - 0.5 * side;
+    return grid;
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Writes a cube file (z fastest, six values per line, full precision).
+  ///
+  void write_cube(const std::string &path, const Grid &grid, std::span<const Gaussian> gaussians)
+  {
+    auto file = open_for_writing(path);
+    std::FILE *out = file.get();
+
+    std::fprintf(out, " FretLab synthetic density\n %zu normalized Gaussians\n", gaussians.size());
+    std::fprintf(out, "%5d%12.6f%12.6f%12.6f\n", 1, grid.origin[0], grid.origin[1], grid.origin[2]);
+    std::fprintf(out, "%5d%12.6f%12.6f%12.6f\n", grid.n, grid.spacing, 0.0, 0.0);
+    std::fprintf(out, "%5d%12.6f%12.6f%12.6f\n", grid.n, 0.0, grid.spacing, 0.0);
+    std::fprintf(out, "%5d%12.6f%12.6f%12.6f\n", grid.n, 0.0, 0.0, grid.spacing);
+
+    // One dummy atom at the first Gaussian
+    const auto &c = gaussians.front().center;
+    std::fprintf(out, "%5d%12.6f%12.6f%12.6f%12.6f\n", 1, 0.0, c[0], c[1], c[2]);
+
+    // The spacing is written with 6 decimals; evaluate on the grid FretLab reads back
+    char text[32];
+    std::snprintf(text, sizeof(text), "%12.6f", grid.spacing);
+    const double h = std::strtod(text, nullptr);
+    std::array<double, 3> origin;
+    for (int k = 0; k < 3; ++k)
+    {
+      std::snprintf(text, sizeof(text), "%12.6f", grid.origin[k]);
+      origin[k] = std::strtod(text, nullptr);
+    }
+
+    std::vector<double> norm(gaussians.size());
+    for (std::size_t g = 0; g < gaussians.size(); ++g)
+      norm[g] = gaussians[g].charge * std::pow(gaussians[g].exponent / Parameters::pi, 1.5);
+
+    std::vector<double> line(grid.n);
+    for (int i = 0; i < grid.n; ++i)
+    {
+      for (int j = 0; j < grid.n; ++j)
+      {
+        for (int k = 0; k < grid.n; ++k)
+        {
+          const std::array<double, 3> r = {origin[0] + h * i, origin[1] + h * j, origin[2] + h * k};
+          double value = 0.0;
+          for (std::size_t g = 0; g < gaussians.size(); ++g)
+          {
+            const double d = distance(r, gaussians[g].center);
+            value += norm[g] * std::exp(-gaussians[g].exponent * d * d);
+          }
+          line[k] = value;
+        }
+
+        for (int k = 0; k < grid.n; ++k)
+          std::fprintf(out, (k % 6 == 5 || k == grid.n - 1) ? " %.12E\n" : " %.12E", line[k]);
+      }
+    }
+
+    if (std::ferror(out))
+      throw std::runtime_error("Could not write file " + path);
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Writes a nanoparticle log with the FRET block of the sites.
+  ///
+  void write_np_log(const std::string &path, std::span<const Site> sites)
+  {
+    auto file = open_for_writing(path);
+    std::FILE *out = file.get();
+
+    std::fprintf(out, "%s\n%s\n", Parameters::fret_start.c_str(), Parameters::charges_header.c_str());
+    for (const auto &site : sites)
+      std::fprintf(out, " %24.16E %24.16E %24.16f %24.16f %24.16f\n",
+                   site.q[0], site.q[1], site.center[0], site.center[1], site.center[2]);
+    std::fprintf(out, "%s\n", Parameters::fret_end.c_str());
+
+    if (std::ferror(out))
+      throw std::runtime_error("Could not write file " + path);
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Sum over Gaussian pairs of Q_A Q_B erf(sqrt(mu) R) / R.
+  ///
+  double acceptor_donor(std::span<const Gaussian> acceptor, std::span<const Gaussian> donor, bool screened)
+  {
+    const double a2 = screened ? Parameters::QMscrnFact * Parameters::QMscrnFact : 0.0;
+
+    double coupling = 0.0;
+    for (const auto &ga : acceptor)
+      for (const auto &gd : donor)
+        coupling += ga.charge * gd.charge *
+                    smeared(1.0 / ga.exponent + 1.0 / gd.exponent + a2, distance(ga.center, gd.center));
+    return coupling;
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief -sum over Gaussians and sites of Q q erf(sqrt(mu) R) / R (ADF density sign).
+  ///
+  std::array<double, 2> acceptor_np(std::span<const Gaussian> acceptor, std::span<const Site> sites, bool screened)
+  {
+    const double a2 = screened ? Parameters::QMscrnFact * Parameters::QMscrnFact : 0.0;
+
+    std::array<double, 2> coupling = {0.0, 0.0};
+    for (const auto &ga : acceptor)
+    {
+      for (const auto &site : sites)
+      {
+        const double factor = -ga.charge * smeared(1.0 / ga.exponent + a2, distance(ga.center, site.center));
+        coupling[0] += factor * site.q[0];
+        coupling[1] += factor * site.q[1];
+      }
+    }
+    return coupling;
+  }
+  //----------------------------------------------------------------------
+
+} // namespace Synthetic
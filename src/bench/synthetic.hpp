@@ -0,0 +1,66 @@
+#ifndef SYNTHETIC_HPP
+#define SYNTHETIC_HPP
+
+#include <span>
+#include <array>
+#include <string>
+#include <vector>
+
+/// @brief Synthetic inputs with exact couplings: densities made of normalized
+/// Gaussian charges Q (alpha / pi)^(3/2) exp(-alpha |r - center|^2) and
+/// nanoparticles made of point charges.
+///
+/// The kernel erf(r / a) / r is the potential of a normalized Gaussian of
+/// exponent 1 / a^2, so the screened interaction of two Gaussians is that of
+/// two point charges smeared with 1 / mu = 1 / alpha + 1 / beta + a^2:
+///
+///     Q_A Q_B erf(sqrt(mu) R) / R
+///
+/// (bare kernel: no a^2 term; point charges: 1 / beta = 0).
+namespace Synthetic
+{
+  struct Gaussian
+  {
+    double charge = 1.0;
+    double exponent = 1.0;
+    std::array<double, 3> center{};
+  };
+
+  struct Site
+  {
+    std::array<double, 2> q{};     ///< Real, imaginary charge
+    std::array<double, 3> center{};
+  };
+
+  /// @brief Cube grid: origin, spacing (Bohr) and points per side.
+  struct Grid
+  {
+    std::array<double, 3> origin{};
+    double spacing = 0.0;
+    int n = 0;
+  };
+
+  /// @brief Transition-density-like pair of Gaussians (+charge, -charge) along z around center.
+  std::vector<Gaussian> dipolar_pair(const std::array<double, 3> &center, double charge, double exponent, double separation);
+
+  /// @brief Sites on a square lattice in the plane x = x_plane, with oscillating complex charges.
+  std::vector<Site> site_lattice(int nsites, double x_plane, double spacing);
+
+  /// @brief n^3 grid around the Gaussians, wide enough that the density drops below 1e-12 of its peak.
+  Grid grid_around(std::span<const Gaussian> gaussians, int n);
+
+  /// @brief Writes the density of the Gaussians on the grid as a cube file.
+  void write_cube(const std::string &path, const Grid &grid, std::span<const Gaussian> gaussians);
+
+  /// @brief Writes the sites as a nanoparticle log (charges only).
+  void write_np_log(const std::string &path, std::span<const Site> sites);
+
+  /// @brief Exact acceptor-donor coupling.
+  double acceptor_donor(std::span<const Gaussian> acceptor, std::span<const Gaussian> donor, bool screened = true);
+
+  /// @brief Exact acceptor-NP coupling (real, imaginary), with the sign convention of Integrals::acceptor_np.
+  std::array<double, 2> acceptor_np(std::span<const Gaussian> acceptor, std::span<const Site> sites, bool screened = true);
+
+} // namespace Synthetic
+
+#endif // SYNTHETIC_HPP
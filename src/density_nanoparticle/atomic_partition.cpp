@@ -0,0 +1,185 @@
+#include "atomic_partition.hpp"
+#include "parameters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    double distance(const std::array<double, 3>& a, const std::array<double, 3>& b) {
+        const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    ///
+    /// @brief Stratmann-Scuseria-Frisch cell function s(mu): the share of atom A
+    /// against atom B at a point with mu = (r_A - r_B) / R_AB.
+    ///
+    double cell_function(double mu) {
+        const double a = Parameters::becke_cutoff;
+        if (mu <= -a) return 1.0;
+        if (mu >= a) return 0.0;
+
+        const double x = mu / a, x2 = x * x;
+        const double g = x * (35.0 - x2 * (35.0 - x2 * (21.0 - 5.0 * x2))) / 16.0;
+        return 0.5 * (1.0 - g);
+    }
+}
+
+///
+/// @brief Sorts the atoms into the cells of a grid spanning their bounding box.
+///
+Atomic_partition::Atomic_partition(const std::vector<double>& x, const std::vector<double>& y,
+                                   const std::vector<double>& z, AtomicPartition method)
+    : method(method), cell_size(Parameters::partition_cell_size) {
+    if (method == AtomicPartition::None) {
+        throw std::runtime_error("Atomic partition needs Voronoi or Becke weights.");
+    }
+    if (x.empty() || x.size() != y.size() || x.size() != z.size()) {
+        throw std::runtime_error("Atomic partition needs the atoms of the cube file.");
+    }
+
+    atoms.resize(x.size());
+    for (std::size_t a = 0; a < x.size(); ++a) atoms[a] = {x[a], y[a], z[a]};
+
+    for (int axis = 0; axis < 3; ++axis) {
+        const auto [lo, hi] = std::minmax_element(atoms.begin(), atoms.end(),
+            [axis](const auto& p, const auto& q) { return p[axis] < q[axis]; });
+        origin[axis] = (*lo)[axis];
+        ncells[axis] = static_cast<int>(((*hi)[axis] - (*lo)[axis]) / cell_size) + 1;
+    }
+
+    // Counting sort of the atoms by cell
+    auto index = [&](const std::array<double, 3>& p) {
+        return (static_cast<std::size_t>(cell_of(p[0], 0)) * ncells[1] + cell_of(p[1], 1)) * ncells[2] + cell_of(p[2], 2);
+    };
+    cell_start.assign(static_cast<std::size_t>(ncells[0]) * ncells[1] * ncells[2] + 1, 0);
+    for (const auto& p : atoms) ++cell_start[index(p) + 1];
+    for (std::size_t c = 1; c < cell_start.size(); ++c) cell_start[c] += cell_start[c - 1];
+
+    cell_atoms.resize(atoms.size());
+    std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (std::size_t a = 0; a < atoms.size(); ++a) cell_atoms[fill[index(atoms[a])]++] = static_cast<int>(a);
+}
+
+int Atomic_partition::cell_of(double coordinate, int axis) const {
+    const double c = std::floor((coordinate - origin[axis]) / cell_size);
+    return static_cast<int>(std::clamp(c, 0.0, static_cast<double>(ncells[axis] - 1)));
+}
+
+///
+/// @brief Visits shells of cells around the cell of the point until the next
+/// shell is farther than the nearest atom found.
+///
+int Atomic_partition::nearest(const std::array<double, 3>& r, double& best) const {
+    const int cx = cell_of(r[0], 0), cy = cell_of(r[1], 1), cz = cell_of(r[2], 2);
+    const int smax = std::max({cx, ncells[0] - 1 - cx, cy, ncells[1] - 1 - cy, cz, ncells[2] - 1 - cz});
+
+    int found = -1;
+    best = 0.0;
+    for (int s = 0; s <= smax; ++s) {
+        for (int ix = std::max(cx - s, 0); ix <= std::min(cx + s, ncells[0] - 1); ++ix) {
+            for (int iy = std::max(cy - s, 0); iy <= std::min(cy + s, ncells[1] - 1); ++iy) {
+                for (int iz = std::max(cz - s, 0); iz <= std::min(cz + s, ncells[2] - 1); ++iz) {
+                    if (std::max({std::abs(ix - cx), std::abs(iy - cy), std::abs(iz - cz)}) != s) continue;
+
+                    const std::size_t c = (static_cast<std::size_t>(ix) * ncells[1] + iy) * ncells[2] + iz;
+                    for (int k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+                        const int a = cell_atoms[k];
+                        const double d = distance(r, atoms[a]);
+                        if (found < 0 || d < best || (d == best && a < found)) {
+                            found = a;
+                            best = d;
+                        }
+                    }
+                }
+            }
+        }
+        // Atoms of shell s + 1 are at least s cells away
+        if (found >= 0 && s * cell_size > best) break;
+    }
+    return found;
+}
+
+void Atomic_partition::within(const std::array<double, 3>& r, double radius, std::vector<int>& found) const {
+    const int x0 = cell_of(r[0] - radius, 0), x1 = cell_of(r[0] + radius, 0);
+    const int y0 = cell_of(r[1] - radius, 1), y1 = cell_of(r[1] + radius, 1);
+    const int z0 = cell_of(r[2] - radius, 2), z1 = cell_of(r[2] + radius, 2);
+
+    for (int ix = x0; ix <= x1; ++ix) {
+        for (int iy = y0; iy <= y1; ++iy) {
+            for (int iz = z0; iz <= z1; ++iz) {
+                const std::size_t c = (static_cast<std::size_t>(ix) * ncells[1] + iy) * ncells[2] + iz;
+                for (int k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+                    if (distance(r, atoms[cell_atoms[k]]) <= radius) found.push_back(cell_atoms[k]);
+                }
+            }
+        }
+    }
+}
+
+///
+/// @brief Voronoi: the nearest atom. Becke: normalized products of cell
+/// functions. An atom A has a non-zero product only if r_A < d (1 + a) / (1 - a),
+/// with d the nearest atom distance, and only atoms B with r_B < r_A (1 + a) / (1 - a)
+/// take a share of it. If no atom takes a share of the nearest one, it gets the
+/// whole point without computing the other products.
+///
+void Atomic_partition::weights(const std::array<double, 3>& r, std::vector<std::pair<int, double>>& weights,
+                               Workspace& work) const {
+    weights.clear();
+
+    double nearest_distance = 0.0;
+    const int closest = nearest(r, nearest_distance);
+    if (method == AtomicPartition::Voronoi || atoms.size() == 1) {
+        weights.emplace_back(closest, 1.0);
+        return;
+    }
+
+    const double a = Parameters::becke_cutoff;
+    const double reach = (1.0 + a) / (1.0 - a);
+
+    work.candidates.clear();
+    within(r, nearest_distance * reach, work.candidates);
+
+    bool alone = true;
+    double farthest = 0.0;
+    for (const int b : work.candidates) {
+        const double rb = distance(r, atoms[b]);
+        farthest = std::max(farthest, rb);
+        if (b != closest && rb - nearest_distance < a * distance(atoms[closest], atoms[b])) alone = false;
+    }
+    if (alone) {
+        weights.emplace_back(closest, 1.0);
+        return;
+    }
+
+    // Every atom that can take a share of a candidate, with its distance
+    work.neighbours.clear();
+    within(r, farthest * reach, work.neighbours);
+    std::sort(work.neighbours.begin(), work.neighbours.end());
+    work.distances.resize(work.neighbours.size());
+    for (std::size_t j = 0; j < work.neighbours.size(); ++j) work.distances[j] = distance(r, atoms[work.neighbours[j]]);
+
+    double total = 0.0;
+    for (const int candidate : work.candidates) {
+        const auto i = static_cast<std::size_t>(
+            std::lower_bound(work.neighbours.begin(), work.neighbours.end(), candidate) - work.neighbours.begin());
+        const double ra = work.distances[i];
+
+        double product = 1.0;
+        for (std::size_t j = 0; j < work.neighbours.size() && product > 0.0; ++j) {
+            if (j == i || work.distances[j] >= ra * reach) continue;
+            const double rab = distance(atoms[candidate], atoms[work.neighbours[j]]);
+            product *= cell_function(rab > 0.0 ? (ra - work.distances[j]) / rab : 0.0);
+        }
+        if (product > 0.0) {
+            weights.emplace_back(candidate, product);
+            total += product;
+        }
+    }
+
+    std::sort(weights.begin(), weights.end());
+    for (auto& weight : weights) weight.second /= total;
+}
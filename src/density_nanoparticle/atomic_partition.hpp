@@ -0,0 +1,69 @@
+#ifndef ATOMIC_PARTITION_HPP
+#define ATOMIC_PARTITION_HPP
+
+#include "enum.hpp"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+///
+/// @class Atomic_partition
+/// @brief Weights that share every point of space among a set of atoms.
+///
+/// Voronoi gives each point to its nearest atom. Becke shares it with the
+/// fuzzy cells of Becke (J. Chem. Phys. 88, 2547 (1988)), using the cell
+/// function of Stratmann, Scuseria and Frisch (Chem. Phys. Lett. 257, 213
+/// (1996)), which is exactly 0 or 1 when one atom is much closer than the
+/// other. Only atoms within a few times the nearest atom distance then have
+/// non-zero weights; they are found with a uniform grid of cells over the atoms.
+///
+class Atomic_partition {
+public:
+    /// Scratch space of one thread.
+    struct Workspace {
+        std::vector<int> candidates, neighbours;
+        std::vector<double> distances;
+    };
+
+    /**
+     * @brief Indexes the atoms.
+     * @param x, y, z Atomic positions (Bohr).
+     * @param method Voronoi or Becke.
+     */
+    Atomic_partition(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z,
+                     AtomicPartition method);
+
+    /**
+     * @brief Weights of the atoms at a point, as (atom, weight) pairs adding up to one.
+     * @param r Point (Bohr).
+     * @param weights Overwritten with the atoms of non-zero weight.
+     * @param work Scratch space, reused between calls of the same thread.
+     */
+    void weights(const std::array<double, 3>& r, std::vector<std::pair<int, double>>& weights, Workspace& work) const;
+
+    /**
+     * @brief Nearest atom to a point (the lowest index among equidistant ones).
+     * @param r Point (Bohr).
+     * @param distance Set to the distance to the atom.
+     */
+    int nearest(const std::array<double, 3>& r, double& distance) const;
+
+private:
+    AtomicPartition method;
+    std::vector<std::array<double, 3>> atoms;
+
+    // Cells of the index: atoms of cell c are cell_atoms[cell_start[c] .. cell_start[c + 1])
+    std::array<double, 3> origin{};
+    std::array<int, 3> ncells{};
+    double cell_size = 1.0;
+    std::vector<int> cell_start, cell_atoms;
+
+    /// @brief Cell of a point along one axis, clamped to the index.
+    int cell_of(double coordinate, int axis) const;
+
+    /// @brief Appends the atoms closer than radius to a point.
+    void within(const std::array<double, 3>& r, double radius, std::vector<int>& found) const;
+};
+
+#endif // ATOMIC_PARTITION_HPP
@@ -0,0 +1,249 @@
+#include "chromophore.hpp"
+#include "linear_algebra.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+///
+/// @brief Places the reduced density with the given pose.
+///
+void Chromophore::place(const Density &density, const Pose &pose)
+{
+  const std::size_t npoints = density.xyz.size();
+  const int nchannels = density.nchannels;
+  const auto &R = pose.rotation;
+  const auto &t = pose.translation;
+
+  weights.resize(npoints);
+  xyz.resize(npoints);
+  center = {0.0, 0.0, 0.0};
+
+  for (std::size_t p = 0; p < npoints; ++p)
+  {
+    const auto &r = density.xyz[p];
+    for (int k = 0; k < 3; ++k)
+    {
+      xyz[p][k] = R[3 * k] * r[0] + R[3 * k + 1] * r[1] + R[3 * k + 2] * r[2] + t[k];
+      center[k] += xyz[p][k];
+    }
+    weights[p] = density.rho_reduced[p * nchannels];
+  }
+
+  if (npoints > 0)
+    for (int k = 0; k < 3; ++k)
+      center[k] /= static_cast<double>(npoints);
+
+  radius = 0.0;
+  for (const auto &r : xyz)
+  {
+    const double dx = r[0] - center[0], dy = r[1] - center[1], dz = r[2] - center[2];
+    radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Places the reduced density with the given pose and builds the cell index.
+///
+void Chromophore::build(const Density &density, const Pose &pose, double cell_size)
+{
+  place(density, pose);
+  const std::size_t npoints = xyz.size();
+
+  //
+  // Cell index: points binned on a cubic grid of side cell_size
+  //
+  std::map<std::tuple<long, long, long>, std::vector<std::size_t>> bins;
+  for (std::size_t p = 0; p < npoints; ++p)
+  {
+    bins[{static_cast<long>(std::floor(xyz[p][0] / cell_size)),
+          static_cast<long>(std::floor(xyz[p][1] / cell_size)),
+          static_cast<long>(std::floor(xyz[p][2] / cell_size))}]
+        .push_back(p);
+  }
+
+  cells.clear();
+  cells.reserve(bins.size());
+  for (const auto &[key, members] : bins)
+  {
+    Cell cell;
+    for (auto p : members)
+      for (int k = 0; k < 3; ++k)
+        cell.center[k] += xyz[p][k];
+    for (int k = 0; k < 3; ++k)
+      cell.center[k] /= static_cast<double>(members.size());
+
+    for (auto p : members)
+    {
+      const double w = weights[p];
+      const double dx = xyz[p][0] - cell.center[0];
+      const double dy = xyz[p][1] - cell.center[1];
+      const double dz = xyz[p][2] - cell.center[2];
+
+      cell.charge += w;
+      cell.dipole[0] += w * dx;
+      cell.dipole[1] += w * dy;
+      cell.dipole[2] += w * dz;
+      cell.quadrupole[0] += w * dx * dx;
+      cell.quadrupole[1] += w * dy * dy;
+      cell.quadrupole[2] += w * dz * dz;
+      cell.quadrupole[3] += w * dx * dy;
+      cell.quadrupole[4] += w * dx * dz;
+      cell.quadrupole[5] += w * dy * dz;
+    }
+    cells.push_back(cell);
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Charge - charge, charge - dipole, dipole - dipole and charge -
+/// quadrupole terms of the 1 / r interaction between the two cells.
+///
+double Chromophore::Cell::coulomb(const Cell &other) const
+{
+  const double rx = other.center[0] - center[0];
+  const double ry = other.center[1] - center[1];
+  const double rz = other.center[2] - center[2];
+  const double r2 = rx * rx + ry * ry + rz * rz;
+  const double inv_r = 1.0 / std::sqrt(r2);
+  const double inv_r3 = inv_r * inv_r * inv_r;
+  const double inv_r5 = inv_r3 * inv_r * inv_r;
+
+  // T2 : Q = (3 R.Q.R - R^2 tr Q) / R^5
+  auto contract = [&](const std::array<double, 6> &Q)
+  {
+    const double rqr = rx * rx * Q[0] + ry * ry * Q[1] + rz * rz * Q[2] +
+                       2.0 * (rx * ry * Q[3] + rx * rz * Q[4] + ry * rz * Q[5]);
+    return (3.0 * rqr - r2 * (Q[0] + Q[1] + Q[2])) * inv_r5;
+  };
+
+  const double ra_mu = rx * dipole[0] + ry * dipole[1] + rz * dipole[2];
+  const double rb_mu = rx * other.dipole[0] + ry * other.dipole[1] + rz * other.dipole[2];
+  const double mu_mu = dipole[0] * other.dipole[0] + dipole[1] * other.dipole[1] + dipole[2] * other.dipole[2];
+
+  return charge * other.charge * inv_r                                          // charge - charge
+         - (charge * rb_mu - other.charge * ra_mu) * inv_r3                      // charge - dipole
+         - (3.0 * ra_mu * rb_mu - r2 * mu_mu) * inv_r5                           // dipole - dipole
+         + 0.5 * (charge * contract(other.quadrupole) + other.charge * contract(quadrupole)); // charge - quadrupole
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads the rigid-body poses of an aggregate, one per line.
+///
+/// Empty lines and lines starting with '#' or '!' are skipped. Rotations must
+/// be orthonormal.
+///
+std::vector<Pose> Chromophore::read_poses(const std::string &filepath)
+{
+  std::ifstream file(filepath);
+  if (!file)
+    throw std::runtime_error("Could not open poses file: " + filepath);
+
+  std::vector<Pose> poses;
+  std::string line;
+  int line_number = 0;
+  while (std::getline(file, line))
+  {
+    ++line_number;
+    line.erase(0, line.find_first_not_of(" \t\r"));
+    if (line.empty() || line[0] == '#' || line[0] == '!')
+      continue;
+
+    std::istringstream fields(line);
+    std::vector<double> values;
+    double value;
+    while (fields >> value)
+      values.push_back(value);
+    if (!fields.eof())
+      throw std::runtime_error("Invalid number in " + filepath + ", line " + std::to_string(line_number));
+
+    Pose pose;
+    if (values.size() == 12)
+    {
+      std::copy(values.begin(), values.begin() + 9, pose.rotation.begin());
+      std::copy(values.begin() + 9, values.end(), pose.translation.begin());
+    }
+    else if (values.size() == 3)
+    {
+      std::copy(values.begin(), values.end(), pose.translation.begin());
+    }
+    else
+    {
+      throw std::runtime_error("Pose in " + filepath + ", line " + std::to_string(line_number) +
+                               " needs 12 (rotation + translation) or 3 (translation) values.");
+    }
+
+    // R * R^T must be the identity
+    const auto &R = pose.rotation;
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+      {
+        const double dot = R[3 * i] * R[3 * j] + R[3 * i + 1] * R[3 * j + 1] + R[3 * i + 2] * R[3 * j + 2];
+        if (std::abs(dot - (i == j ? 1.0 : 0.0)) > 1.0e-6)
+          throw std::runtime_error("Rotation in " + filepath + ", line " + std::to_string(line_number) + " is not orthonormal.");
+      }
+
+    poses.push_back(pose);
+  }
+
+  return poses;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Least-squares rigid-body fit of current onto reference points.
+///
+/// The optimal rotation is the eigenvector of the largest eigenvalue of
+/// Horn's 4x4 matrix built from the cross-covariance of the centred points.
+///
+Pose Chromophore::fit_pose(std::span<const std::array<double, 3>> reference, std::span<const std::array<double, 3>> current)
+{
+  const std::size_t n = reference.size();
+  if (n == 0 || current.size() != n)
+    throw std::runtime_error("Pose fit needs the same, non-zero number of reference and current points.");
+
+  std::array<double, 3> ref_center{}, cur_center{};
+  for (std::size_t i = 0; i < n; ++i)
+    for (int k = 0; k < 3; ++k)
+    {
+      ref_center[k] += reference[i][k] / static_cast<double>(n);
+      cur_center[k] += current[i][k] / static_cast<double>(n);
+    }
+
+  // Cross-covariance S(a, b) = sum (ref_a)(cur_b)
+  std::array<double, 9> S{};
+  for (std::size_t i = 0; i < n; ++i)
+    for (int a = 0; a < 3; ++a)
+      for (int b = 0; b < 3; ++b)
+        S[3 * a + b] += (reference[i][a] - ref_center[a]) * (current[i][b] - cur_center[b]);
+
+  const double Sxx = S[0], Sxy = S[1], Sxz = S[2];
+  const double Syx = S[3], Syy = S[4], Syz = S[5];
+  const double Szx = S[6], Szy = S[7], Szz = S[8];
+
+  std::vector<double> N = {
+      Sxx + Syy + Szz, Syz - Szy, Szx - Sxz, Sxy - Syx,
+      Syz - Szy, Sxx - Syy - Szz, Sxy + Syx, Szx + Sxz,
+      Szx - Sxz, Sxy + Syx, -Sxx + Syy - Szz, Syz + Szy,
+      Sxy - Syx, Szx + Sxz, Syz + Szy, -Sxx - Syy + Szz};
+
+  std::vector<double> eigenvalues, eigenvectors;
+  symmetric_eigen(4, N, eigenvalues, eigenvectors);
+
+  // Unit quaternion (w, x, y, z) of the largest eigenvalue
+  const double w = eigenvectors[12], x = eigenvectors[13], y = eigenvectors[14], z = eigenvectors[15];
+
+  Pose pose;
+  pose.rotation = {1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y - w * z), 2.0 * (x * z + w * y),
+                   2.0 * (x * y + w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z - w * x),
+                   2.0 * (x * z - w * y), 2.0 * (y * z + w * x), 1.0 - 2.0 * (x * x + y * y)};
+
+  const auto &R = pose.rotation;
+  for (int k = 0; k < 3; ++k)
+    pose.translation[k] = cur_center[k] - (R[3 * k] * ref_center[0] + R[3 * k + 1] * ref_center[1] + R[3 * k + 2] * ref_center[2]);
+
+  return pose;
+}
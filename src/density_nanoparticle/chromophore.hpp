@@ -0,0 +1,83 @@
+#ifndef CHROMOPHORE_HPP
+#define CHROMOPHORE_HPP
+
+#include "density.hpp"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <span>
+
+///
+/// @struct Pose
+/// @brief Rigid-body placement of a density: x' = rotation * x + translation (Bohr).
+///
+struct Pose
+{
+  std::array<double, 9> rotation = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0}; ///< Row-major 3x3 rotation
+  std::array<double, 3> translation{};
+};
+
+///
+/// @class Chromophore
+/// @brief Reduced transition density of one member of an aggregate, placed in
+/// the aggregate frame, with a cell index used for multipole shortcuts.
+///
+class Chromophore
+{
+public:
+  /// @brief Point cell of the index, with moments relative to the cell centroid.
+  struct Cell
+  {
+    std::array<double, 3> center{};     ///< Centroid of the cell points
+    double charge = 0.0;                ///< Sum of weights
+    std::array<double, 3> dipole{};     ///< First moment
+    std::array<double, 6> quadrupole{}; ///< Second moment: xx, yy, zz, xy, xz, yz
+
+    /// @brief Bare Coulomb interaction with another cell, Taylor expanded to
+    /// second order in the offsets of the points from both centers.
+    double coulomb(const Cell &other) const;
+  };
+
+  std::string label;                        ///< File the density was read from
+
+  std::vector<double> weights;              ///< Reduced density values
+  std::vector<std::array<double, 3>> xyz;   ///< Posed coordinates of the reduced points
+
+  std::array<double, 3> center{};           ///< Centroid of the reduced points
+  double radius = 0.0;                      ///< Bounding sphere radius around center
+
+  std::vector<Cell> cells;                  ///< Cell index of the points
+
+  /**
+   * @brief Places the reduced density (channel 0) with the given pose (no cell index).
+   * @param density Reduced density.
+   * @param pose Rigid-body pose in the aggregate frame.
+   */
+  void place(const Density &density, const Pose &pose);
+
+  /**
+   * @brief Places the reduced density (channel 0) with the given pose and builds the cell index.
+   * @param density Reduced density.
+   * @param pose Rigid-body pose in the aggregate frame.
+   * @param cell_size Side of the index cells (Bohr).
+   */
+  void build(const Density &density, const Pose &pose, double cell_size);
+
+  /**
+   * @brief Reads one pose per line: 9 rotation entries (row-major) and 3 translation
+   * components, or only the 3 translation components. Lengths in Bohr.
+   * @param filepath Path to the poses file.
+   */
+  static std::vector<Pose> read_poses(const std::string &filepath);
+
+  /**
+   * @brief Least-squares rigid-body fit (Horn's quaternion method): the pose
+   * that best maps the reference points onto the current ones.
+   * @param reference Points in the frame of the density (e.g. cube atoms).
+   * @param current Same points, in the same order, in the new frame.
+   */
+  static Pose fit_pose(std::span<const std::array<double, 3>> reference, std::span<const std::array<double, 3>> current);
+};
+
+#endif // CHROMOPHORE_HPP
@@ -1,6 +1,10 @@
 #include "density.hpp"
 #include "parameters.hpp"
 #include "target.hpp"
+#include "decompress.hpp"
+#include "perf_counters.hpp"
+#include "compensated_sum.hpp"
+#include "atomic_partition.hpp"
 
 #include <fstream>
 #include <sstream>
@@ -8,6 +12,15 @@
 #include <cmath>
 #include <stdexcept>
 #include <iomanip>
+#include <numeric>
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+#include <optional>
+#include <utility>
+#include <cstring>
+#include <filesystem>
+#include <omp.h>
 
 ///
 /// @brief Returns the element label (e.g., "H", "C") for a given atomic number.
@@ -29,128 +42,530 @@ std::string Density::map_atomic_number_to_label(int Z) const {
 ///
 /// @brief Loads a cube file and initializes the density grid and atomic data.
 ///
+/// Several cube files sharing one grid (e.g. transition densities of
+/// different states) are loaded as channels of the same density.
+///
 //void Density::read_density(const std::string& filepath, bool rotate, const std::string& what_dens) {
 void Density::read_density(const Target& target, bool rotate, const std::string& what_dens) {
 
-    // Check density file final purpose: cube integration, acceptor, or donor density.
-    std::string filepath;
+    const std::vector<std::string> filepaths = density_files(target, what_dens);
+
+    nchannels = filepaths.size();
+    {
+        Perf_counters::Phase phase("Cube read");
+        for (int c = 0; c < nchannels; ++c) {
+            read_cube(filepaths[c], c);
+        }
+    }
+
+    // NOTE: geometry center and rotation will be added later
+    if (target.integrate_density) {
+        n_points_reduced = 0;
+        rho_reduced.clear();
+        xyz.clear();
+        return;
+    }
+
+    Perf_counters::Phase phase("Reduction");
+    reduce(target.cutoff, target.calc_overlap_int, target.is_cutoff_sweep_present, what_dens);
+}
+
+///
+/// @brief Saves the reduced density of the grid and the associated coordinates.
+///
+/// A point is kept if any channel is above the cutoff, so all channels share
+/// the same reduced points. Used by read_density and by the in-memory API
+/// (fretlab::reduce), so both keep the same points in the same order.
+///
+void Density::reduce(double cutoff, bool keep_all, bool sorted, const std::string& what_dens) {
+
+    n_points_reduced = 0;
+    rho_reduced.clear();
+    xyz.clear();
+
+    const std::size_t nvox = static_cast<std::size_t>(nx) * ny * nz;
+
+    auto keep = [&](std::size_t v) {
+        if (keep_all) return true;
+        for (int c = 0; c < nchannels; ++c) {
+            if (std::abs(rho[c * nvox + v]) > maxdens_channel[c] * cutoff) return true;
+        }
+        return false;
+    };
+
+    // Count the points of every x plane first, so the reduced arrays are
+    // allocated only once and the planes can be filled in parallel
+    const std::size_t plane = static_cast<std::size_t>(ny) * nz;
+    std::vector<std::size_t> offset(nx + 1, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < nx; ++i) {
+        std::size_t count = 0;
+        for (std::size_t v = i * plane; v < (i + 1) * plane; ++v) {
+            if (keep(v)) ++count;
+        }
+        offset[i + 1] = count;
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    const std::size_t nkeep = offset[nx];
+    if (nkeep > static_cast<std::size_t>(Parameters::ncellmax)) {
+        throw std::runtime_error("Too many points (" + std::to_string(nkeep) + ") in " + what_dens + " density. Increase cutoff or ncellmax.");
+    }
+
+    first_touch(rho_reduced, nkeep, nchannels);
+    first_touch(xyz, nkeep);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < nx; ++i) {
+        const double x_tmp = xmin + dx[0] * i;
+        std::size_t p = offset[i];
+        std::size_t v = i * plane;
+
+        for (int j = 0; j < ny; ++j) {
+            const double y_tmp = ymin + dy[1] * j;
+
+            for (int k = 0; k < nz; ++k, ++v) {
+                const double z_tmp = zmin + dz[2] * k;
+
+                if (keep(v)) {
+                    for (int c = 0; c < nchannels; ++c) {
+                        rho_reduced[p * nchannels + c] = rho[c * nvox + v];
+                    }
+                    xyz[p] = {x_tmp, y_tmp, z_tmp};
+                    ++p;
+                }
+            }
+        }
+    }
+    n_points_reduced = static_cast<int>(nkeep);
+
+    if (sorted) sort_by_magnitude();
+    compute_moments();
+}
+
+///
+/// @brief Files of a density role: cube integration, acceptor, or donor density
+/// (several files are the states sharing one grid).
+///
+std::vector<std::string> Density::density_files(const Target& target, const std::string& what_dens) {
+
+    std::vector<std::string> filepaths;
 
     if (what_dens=="Cube"){
-       filepath = target.density_file_integration;
+       filepaths = {target.density_file_integration};
     } else if (what_dens=="Acceptor"){
-       filepath = target.acceptor_density_file;
+       filepaths = target.acceptor_density_files;
+       if (filepaths.empty()) filepaths = {target.acceptor_density_file};
     } else if (what_dens=="Donor"){
-       filepath = target.donor_density_file;
+       filepaths = target.donor_density_files;
+       if (filepaths.empty()) filepaths = {target.donor_density_file};
     } else {
         throw std::runtime_error("Unknown density file mode to read.");
     }
+    return filepaths;
+}
 
-    // Check file existance.
-    std::ifstream infile(filepath);
-    if (!infile) {
-        throw std::runtime_error("File: " + filepath + "not found.");
+namespace {
+    ///
+    /// @brief Cube file opened past its header, with what fixes its grid values.
+    ///
+    struct Cube_values {
+        Input_file file;
+        std::string voxels;                  ///< The three voxel lines
+        std::optional<std::uintmax_t> bytes; ///< Size of the value section (plain files)
+
+        explicit Cube_values(const std::string& path) : file(path) {
+            std::string line;
+            std::uintmax_t header = 0;
+            auto next_line = [&]() -> const std::string& {
+                if (!std::getline(file, line)) {
+                    throw std::runtime_error("Cube file " + path + " ended inside its header.");
+                }
+                header += line.size() + 1;
+                return line;
+            };
+
+            next_line();                                // two comment lines
+            next_line();
+            const int natoms_c = std::abs(std::atoi(next_line().c_str()));
+            for (int k = 0; k < 3; ++k) {               // three voxel lines
+                voxels += next_line();
+                voxels += '\n';
+            }
+            for (int i = 0; i < natoms_c; ++i) next_line();
+
+            if (detect_compression(path) == Compression::None) {
+                bytes = std::filesystem::file_size(path) - header;
+            }
+        }
+    };
+}
+
+///
+/// @brief True if two lists of cube files hold the same grid values, without
+/// parsing them.
+///
+/// Compares the voxel lines and the values, but not the comments, origin or
+/// atoms: cubes of the same density moved rigidly by a translation (e.g. the
+/// two molecules of homo-FRET) hold the same grid values. The headers and the
+/// sizes of the value sections (plain files) of every pair are compared
+/// first; only if they all match are the values compared, block by block,
+/// stopping at the first difference.
+///
+bool Density::same_grid_values(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+
+    if (a.size() != b.size()) return false;
+
+    for (std::size_t k = 0; k < a.size(); ++k) {
+        const Cube_values va(a[k]), vb(b[k]);
+        if (va.voxels != vb.voxels || (va.bytes && vb.bytes && *va.bytes != *vb.bytes)) return false;
+    }
+
+    std::vector<char> block_a(Parameters::read_buffer_size), block_b(Parameters::read_buffer_size);
+    for (std::size_t k = 0; k < a.size(); ++k) {
+        Cube_values va(a[k]), vb(b[k]);
+        while (true) {
+            va.file.read(block_a.data(), block_a.size());
+            vb.file.read(block_b.data(), block_b.size());
+            const auto na = va.file.gcount(), nb = vb.file.gcount();
+            if (na != nb || std::memcmp(block_a.data(), block_b.data(), static_cast<std::size_t>(na)) != 0) return false;
+            if (na == 0) break;
+        }
+    }
+    return true;
+}
+
+///
+/// @brief True if two loaded densities have the same voxels and grid values.
+///
+bool Density::same_grid_values(const Density& other) const {
+    return nchannels == other.nchannels && nx == other.nx && ny == other.ny && nz == other.nz &&
+           dx == other.dx && dy == other.dy && dz == other.dz && rho == other.rho;
+}
+
+///
+/// @brief Builds this density from another one with the same grid values
+/// (same_grid_values): only the cube header and atoms are read, and the reduced
+/// points are those of the reference moved to this cube's origin.
+///
+void Density::read_translated(const Target& target, const std::string& what_dens, const Density& reference) {
+
+    const std::vector<std::string> filepaths = density_files(target, what_dens);
+    if (static_cast<int>(filepaths.size()) != reference.nchannels) {
+        throw std::runtime_error("Translated density needs as many files as its reference.");
     }
 
-    // Skip header lines
-    std::getline(infile, str1);
-    std::getline(infile, str2);
+    nchannels = reference.nchannels;
+    {
+        Perf_counters::Phase phase("Cube read");
+        read_cube(filepaths.front(), 0, true);
+    }
+
+    if (nx != reference.nx || ny != reference.ny || nz != reference.nz ||
+        dx != reference.dx || dy != reference.dy || dz != reference.dz) {
+        throw std::runtime_error("Cube file " + filepaths.front() + " does not share the grid of its reference density.");
+    }
+
+    maxdens = reference.maxdens;
+    maxdens_channel = reference.maxdens_channel;
+    integral = reference.integral;
+
+    const std::array<double, 3> shift = {xmin - reference.xmin, ymin - reference.ymin, zmin - reference.zmin};
+
+    n_points_reduced = reference.n_points_reduced;
+    magnitude = reference.magnitude;
+
+    const long long npoints = reference.xyz.size();
+    first_touch(rho_reduced, npoints, nchannels);
+    first_touch(xyz, npoints);
+
+    #pragma omp parallel for schedule(static)
+    for (long long p = 0; p < npoints; ++p) {
+        std::copy_n(&reference.rho_reduced[p * nchannels], nchannels, &rho_reduced[p * nchannels]);
+        for (int k = 0; k < 3; ++k) xyz[p][k] = reference.xyz[p][k] + shift[k];
+    }
+
+    moments = reference.moments;
+    for (int k = 0; k < 3; ++k) {
+        moments.center[k] += shift[k];
+        moments.positive_center[k] += shift[k];
+        moments.negative_center[k] += shift[k];
+    }
+}
+
+///
+/// @brief True if both densities have the same origin and atoms.
+///
+bool Density::same_placement(const Density& other) const {
+    return xmin == other.xmin && ymin == other.ymin && zmin == other.zmin &&
+           x == other.x && y == other.y && z == other.z;
+}
+
+///
+/// @brief Moments of the first channel about the centroid of the reduced
+/// points, and the weighted centers of its positive and negative parts.
+///
+void Density::compute_moments() {
+    moments = Moments{};
+    const std::size_t n = xyz.size();
+    if (n == 0) return;
+
+    for (std::size_t p = 0; p < n; ++p) {
+        for (int k = 0; k < 3; ++k) moments.center[k] += xyz[p][k];
+    }
+    for (int k = 0; k < 3; ++k) moments.center[k] /= static_cast<double>(n);
+
+    for (std::size_t p = 0; p < n; ++p) {
+        const double w = rho_reduced[p * nchannels];
+        const double rx = xyz[p][0] - moments.center[0];
+        const double ry = xyz[p][1] - moments.center[1];
+        const double rz = xyz[p][2] - moments.center[2];
+
+        moments.radius = std::max(moments.radius, std::sqrt(rx * rx + ry * ry + rz * rz));
+        moments.charge += w;
+        moments.dipole[0] += w * rx;
+        moments.dipole[1] += w * ry;
+        moments.dipole[2] += w * rz;
+        moments.quadrupole[0] += w * rx * rx;
+        moments.quadrupole[1] += w * ry * ry;
+        moments.quadrupole[2] += w * rz * rz;
+        moments.quadrupole[3] += w * rx * ry;
+        moments.quadrupole[4] += w * rx * rz;
+        moments.quadrupole[5] += w * ry * rz;
+
+        double& part = w > 0.0 ? moments.positive : moments.negative;
+        std::array<double, 3>& part_center = w > 0.0 ? moments.positive_center : moments.negative_center;
+        part += w;
+        for (int k = 0; k < 3; ++k) part_center[k] += w * xyz[p][k];
+    }
+
+    for (int k = 0; k < 3; ++k) {
+        moments.positive_center[k] = moments.positive != 0.0 ? moments.positive_center[k] / moments.positive : moments.center[k];
+        moments.negative_center[k] = moments.negative != 0.0 ? moments.negative_center[k] / moments.negative : moments.center[k];
+    }
+}
+
+///
+/// @brief Sorts the reduced points by decreasing relative magnitude (cutoff sweeps).
+///
+/// Ties keep the grid order, so the points kept by a cutoff are the same set as
+/// in a normal run with that cutoff.
+///
+void Density::sort_by_magnitude() {
+
+    const std::size_t n = n_points_reduced;
+
+    std::vector<double> level(n, 0.0);
+    for (std::size_t p = 0; p < n; ++p) {
+        for (int c = 0; c < nchannels; ++c) {
+            level[p] = std::max(level[p], std::abs(rho_reduced[p * nchannels + c]) / maxdens_channel[c]);
+        }
+    }
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return level[a] > level[b]; });
+
+    First_touch_vector<double> rho_sorted;
+    First_touch_vector<std::array<double, 3>> xyz_sorted;
+    first_touch(rho_sorted, n, nchannels);
+    first_touch(xyz_sorted, n);
+    magnitude.resize(n);
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t p = 0; p < n; ++p) {
+        std::copy_n(&rho_reduced[order[p] * nchannels], nchannels, &rho_sorted[p * nchannels]);
+        xyz_sorted[p] = xyz[order[p]];
+        magnitude[p] = level[order[p]];
+    }
+
+    rho_reduced = std::move(rho_sorted);
+    xyz = std::move(xyz_sorted);
+}
+
+///
+/// @brief Number of sorted reduced points kept by a cutoff.
+///
+int Density::points_above(double cutoff) const {
+
+    if (magnitude.size() != xyz.size()) {
+        throw std::runtime_error("Density points are not sorted for a cutoff sweep.");
+    }
+
+    const auto end = std::partition_point(magnitude.begin(), magnitude.end(), [&](double m) { return m > cutoff; });
+    return static_cast<int>(end - magnitude.begin());
+}
+
+///
+/// @brief Reads one cube file into the given channel of the density grid.
+///
+/// The first channel defines the grid and the atoms; further channels must
+/// use exactly the same grid.
+///
+void Density::read_cube(const std::string& filepath, int channel, bool header_only) {
+
+    // Check file existance. Blocks of Parameters::read_buffer_size keep the
+    // number of read calls low on network filesystems; parsing starts with the
+    // first block. Compressed cubes are decompressed block by block as well.
+    Input_file infile(filepath);
+
+    // Header lines
+    std::string header1, header2;
+    std::getline(infile, header1);
+    std::getline(infile, header2);
 
     // Read grid and origin info
-    infile >> natoms >> xmin >> ymin >> zmin;
-    infile >> nx >> dx[0] >> dx[1] >> dx[2];
-    infile >> ny >> dy[0] >> dy[1] >> dy[2];
-    infile >> nz >> dz[0] >> dz[1] >> dz[2];
-
-    // Ensure voxel matrix is diagonal. Compute voxel volume.
-    if (dx[1] != 0.0 || dx[2] != 0.0 ||
-        dy[0] != 0.0 || dy[2] != 0.0 ||
-        dz[0] != 0.0 || dz[1] != 0.0) {
-        throw std::runtime_error("Cube file conflict: dx, dy, dz matrix is not diagonal.");
-    }
-    volume = dx[0] * dy[1] * dz[2];
-
-    // Initialize atom vectors
-    atomic_number.resize(natoms);
-    atomic_label.resize(natoms);
-    atomic_charge.resize(natoms);
-    x.resize(natoms);
-    y.resize(natoms);
-    z.resize(natoms);
-
-    // Read atom block
-    nelectrons = 0;
-    for (int i = 0; i < natoms; ++i) {
-        infile >> atomic_number[i] >> atomic_charge[i] >> x[i] >> y[i] >> z[i];
-        nelectrons += atomic_number[i];
-        atomic_label[i] = map_atomic_number_to_label(atomic_number[i]);
-    }
-
-    // Allocate 3D density grid
-    rho.resize(nx, std::vector<std::vector<double>>(ny, std::vector<double>(nz)));
+    int natoms_c = 0, nx_c = 0, ny_c = 0, nz_c = 0;
+    double xmin_c = 0.0, ymin_c = 0.0, zmin_c = 0.0;
+    std::array<double, 3> dx_c{}, dy_c{}, dz_c{};
 
-    // Read density values, weight by voxel volume, and find maximum density value
-    maxdens = 0.0;
-    for (int i = 0; i < nx; ++i) {
-        for (int j = 0; j < ny; ++j) {
-            for (int k = 0; k < nz; ++k) {
-                infile >> rho[i][j][k];
-                rho[i][j][k] *= volume;
-                maxdens = std::max(maxdens, std::abs(rho[i][j][k]));
-            }
+    infile >> natoms_c >> xmin_c >> ymin_c >> zmin_c;
+    infile >> nx_c >> dx_c[0] >> dx_c[1] >> dx_c[2];
+    infile >> ny_c >> dy_c[0] >> dy_c[1] >> dy_c[2];
+    infile >> nz_c >> dz_c[0] >> dz_c[1] >> dz_c[2];
+
+    if (channel == 0) {
+        str1 = header1;
+        str2 = header2;
+        natoms = natoms_c;
+        xmin = xmin_c; ymin = ymin_c; zmin = zmin_c;
+        nx = nx_c; ny = ny_c; nz = nz_c;
+        dx = dx_c; dy = dy_c; dz = dz_c;
+
+        // Ensure voxel matrix is diagonal. Compute voxel volume.
+        if (dx[1] != 0.0 || dx[2] != 0.0 ||
+            dy[0] != 0.0 || dy[2] != 0.0 ||
+            dz[0] != 0.0 || dz[1] != 0.0) {
+            throw std::runtime_error("Cube file conflict: dx, dy, dz matrix is not diagonal.");
         }
+        volume = dx[0] * dy[1] * dz[2];
+    } else if (nx_c != nx || ny_c != ny || nz_c != nz ||
+               xmin_c != xmin || ymin_c != ymin || zmin_c != zmin ||
+               dx_c != dx || dy_c != dy || dz_c != dz) {
+        throw std::runtime_error("Cube file " + filepath + " does not share the grid of the first density file.");
     }
 
-    // NOTE: reduction, geometry center, and rotation will be added later
-    // 
-    // debugpgi
-    // Save reducde density of the cube, and calculate associated coordinates
-    //
-    if (!target.integrate_density) {
-        rho_reduced.resize(Parameters::ncellmax);
-        xyz.resize(Parameters::ncellmax);
-    
-        double x_tmp = 0.0, y_tmp = 0.0, z_tmp = 0.0;
-    
-        for (int i = 0; i < nx; ++i) {
-            x_tmp = xmin + dx[0] * i;
-    
-            for (int j = 0; j < ny; ++j) {
-                y_tmp = ymin + dy[1] * j;
-    
-                for (int k = 0; k < nz; ++k) {
-                    z_tmp = zmin + dz[2] * k;
-    
-                    if (std::abs(rho[i][j][k]) > maxdens * target.cutoff || target.calc_overlap_int) {
-
-                        if (n_points_reduced >= Parameters::ncellmax) {
-                            throw std::runtime_error("Too many points (" + std::to_string(n_points_reduced) + ") in " + what_dens + " density file. Increase cutoff or ncellmax.");
-                        }
-                        rho_reduced[n_points_reduced] = rho[i][j][k];
-                        xyz[n_points_reduced] = {x_tmp, y_tmp, z_tmp};
-                        ++n_points_reduced;
-                    }
-                }
-            }
+    // Read atom block (atoms of further channels are skipped)
+    if (channel == 0) {
+        atomic_number.resize(natoms);
+        atomic_label.resize(natoms);
+        atomic_charge.resize(natoms);
+        x.resize(natoms);
+        y.resize(natoms);
+        z.resize(natoms);
+
+        nelectrons = 0;
+        for (int i = 0; i < natoms; ++i) {
+            infile >> atomic_number[i] >> atomic_charge[i] >> x[i] >> y[i] >> z[i];
+            nelectrons += atomic_number[i];
+            atomic_label[i] = map_atomic_number_to_label(atomic_number[i]);
+        }
+    } else {
+        std::string line;
+        std::getline(infile, line); // rest of the last grid line
+        for (int i = 0; i < natoms_c; ++i) {
+            std::getline(infile, line);
+        }
+    }
+
+    if (header_only) {
+        if (!infile) {
+            throw std::runtime_error("Cube file " + filepath + " ended inside its header.");
         }
+        return;
+    }
+
+    // Allocate density grid (all channels, channel-major)
+    const std::size_t nvox = static_cast<std::size_t>(nx) * ny * nz;
+    if (channel == 0) {
+        rho.assign(nvox * nchannels, 0.0);
+        maxdens_channel.assign(nchannels, 0.0);
     }
 
-    // Resize vectors to actual number of points
-    rho_reduced.resize(n_points_reduced);
-    xyz.resize(n_points_reduced);
+    // Read density values, weight by voxel volume, and find maximum density value
+    double *values = rho.data() + channel * nvox;
+    double maxval = 0.0;
+    for (std::size_t v = 0; v < nvox; ++v) {
+        infile >> values[v];
+        values[v] *= volume;
+        maxval = std::max(maxval, std::abs(values[v]));
+    }
+    if (!infile) {
+        throw std::runtime_error("Cube file " + filepath + " ended before all density values were read.");
+    }
 
-    infile.close();
+    maxdens_channel[channel] = maxval;
+    if (channel == 0) maxdens = maxval;
 }
 
 ///
 /// @brief Integrates the full density grid by summing all density values.
 ///
-void Density::int_density() {
-    for (int i = 0; i < nx; ++i) {
-        for (int j = 0; j < ny; ++j) {
-            for (int k = 0; k < nz; ++k) {
-                integral += rho[i][j][k];
+/// Only the first channel is integrated. Every x plane is summed with
+/// compensated sums by one thread, and the planes are added in order, so the
+/// result does not depend on the number of threads. With a partition, the
+/// share of every voxel owned by each atom is summed as well.
+///
+void Density::int_density(AtomicPartition partition) {
+    const std::size_t plane = static_cast<std::size_t>(ny) * nz;
+    constexpr int lanes = 4;
+
+    this->partition = partition;
+    population.clear();
+
+    std::vector<Compensated_sum> plane_sum(nx);
+    std::vector<Compensated_sum> plane_population;
+    std::optional<Atomic_partition> cells;
+    if (partition != AtomicPartition::None) {
+        cells.emplace(x, y, z, partition);
+        plane_population.resize(static_cast<std::size_t>(nx) * natoms);
+    }
+
+    #pragma omp parallel
+    {
+        Atomic_partition::Workspace work;
+        std::vector<std::pair<int, double>> weights;
+
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < nx; ++i) {
+            const double* values = rho.data() + i * plane;
+
+            // Independent lanes, so the compensated updates can be vectorized
+            std::array<Compensated_sum, lanes> lane{};
+            std::size_t v = 0;
+            for (; v + lanes <= plane; v += lanes) {
+                for (int l = 0; l < lanes; ++l) lane[l].add(values[v + l]);
+            }
+            for (; v < plane; ++v) lane[0].add(values[v]);
+            for (int l = 0; l < lanes; ++l) plane_sum[i].add(lane[l]);
+
+            if (!cells) continue;
+
+            Compensated_sum* atom_sum = plane_population.data() + static_cast<std::size_t>(i) * natoms;
+            const double x_tmp = xmin + dx[0] * i;
+            v = 0;
+            for (int j = 0; j < ny; ++j) {
+                const double y_tmp = ymin + dy[1] * j;
+                for (int k = 0; k < nz; ++k, ++v) {
+                    if (values[v] == 0.0) continue;
+                    cells->weights({x_tmp, y_tmp, zmin + dz[2] * k}, weights, work);
+                    for (const auto& [atom, weight] : weights) atom_sum[atom].add(weight * values[v]);
+                }
             }
         }
     }
+
+    Compensated_sum total;
+    for (const auto& sum : plane_sum) total.add(sum);
+    integral = total.value();
+
+    if (cells) {
+        population.resize(natoms);
+        for (int a = 0; a < natoms; ++a) {
+            Compensated_sum atom_total;
+            for (int i = 0; i < nx; ++i) atom_total.add(plane_population[static_cast<std::size_t>(i) * natoms + a]);
+            population[a] = atom_total.value();
+        }
+    }
 }
- 
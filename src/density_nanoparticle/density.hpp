@@ -2,10 +2,12 @@
 #define DENSITY_HPP
 
 #include "target.hpp"
+#include "numa.hpp"
 
 #include <string>
 #include <vector>
 #include <array>
+#include <cstdint>
 
 ///
 /// @class Density
@@ -30,15 +32,41 @@ public:
     double xmin = 0.0, ymin = 0.0, zmin = 0.0;
     std::array<double, 3> dx{}, dy{}, dz{};      ///< Voxel vectors in each direction
 
-    std::vector<std::vector<std::vector<double>>> rho;
-
-    std::vector<double> rho_reduced;
-    std::vector<std::array<double, 3>> xyz;
+    int nchannels = 1;                           ///< Number of densities sharing the grid
+
+    /// Density values weighted by voxel volume. Channel-major; inside a channel
+    /// z runs fastest: rho[(c * nx + i) * ny * nz + j * nz + k]
+    std::vector<double> rho;
+
+    // Reduced points, placed on the NUMA nodes of the threads that use them
+    // (point p by the thread that gets p in a static schedule)
+    First_touch_vector<double> rho_reduced;                 ///< Reduced density, indexed [point * nchannels + channel]
+    First_touch_vector<std::array<double, 3>> xyz;          ///< Coordinates of the reduced points
+
+    /// Cutoff sweeps only: max over channels of |rho| / maxdens_channel of every
+    /// reduced point. Points are then sorted by it, largest first, so the points
+    /// kept by any cutoff are a prefix of the reduced arrays.
+    std::vector<double> magnitude;
+
+    /// Moments of the reduced points of the first channel, for the dipole prescreen
+    struct Moments {
+        std::array<double, 3> center{};           ///< Centroid of the reduced points
+        double radius = 0.0;                      ///< Bounding sphere radius around center
+        double charge = 0.0;                      ///< Sum of the weights
+        std::array<double, 3> dipole{};           ///< First moment about center
+        std::array<double, 6> quadrupole{};       ///< Second moment about center: xx, yy, zz, xy, xz, yz
+        double positive = 0.0, negative = 0.0;    ///< Sums of the positive and of the negative weights
+        std::array<double, 3> positive_center{}, negative_center{}; ///< Weighted centers of each sign
+    };
+    Moments moments;
 
     double maxdens = 0.0, volume = 0.0;
+    std::vector<double> maxdens_channel;         ///< Maximum |rho| of every channel
     std::array<double, 3> geom_center{}, geom_center_mol{};
 
     double integral = 0.0;  ///< Integral of the density over the full grid
+    AtomicPartition partition = AtomicPartition::None;  ///< Partition used for population
+    std::vector<double> population;  ///< Integral of the density in the partition cell of every atom
 
     // Functions to handle density data
     /**
@@ -51,13 +79,75 @@ public:
     void read_density(const Target& target, bool rotate = false, const std::string& what_dens = "");
 
 
+    /**
+     * @brief Keeps the grid points above cutoff * maxdens_channel in any channel
+     * (all points if keep_all), in grid order, then fills moments.
+     * @param sorted Sort the points by magnitude afterwards (cutoff sweeps).
+     * @param what_dens Density role, for error messages.
+     */
+    void reduce(double cutoff, bool keep_all, bool sorted = false, const std::string& what_dens = "Grid");
+
+    /**
+     * @brief Builds the density from a reference with the same grid values (same
+     * same_grid_values), reading only the header of its cube: the reduced points are
+     * those of the reference translated to this cube's origin.
+     */
+    void read_translated(const Target& target, const std::string& what_dens, const Density& reference);
+
+    /**
+     * @brief True if both densities have the same origin and atoms.
+     */
+    bool same_placement(const Density& other) const;
+
+    /**
+     * @brief Density files of a role ("Cube", "Acceptor", "Donor").
+     */
+    static std::vector<std::string> density_files(const Target& target, const std::string& what_dens);
+
+    /**
+     * @brief True if two lists of cube files hold the same grid values (voxel
+     * lines and values, not origin or atoms), compared as raw text without
+     * parsing; headers and sizes are compared before any value is read.
+     */
+    static bool same_grid_values(const std::vector<std::string>& a, const std::vector<std::string>& b);
+
+    /**
+     * @brief Same test on two loaded densities (voxels and grid values), without
+     * reading their files.
+     */
+    bool same_grid_values(const Density& other) const;
+
+    /**
+     * @brief Number of reduced points kept by a cutoff (a prefix of the sorted points).
+     */
+    int points_above(double cutoff) const;
+
     /** 
      * @brief Integrates the full density grid.
+     * @param partition Also integrates the share of every atom (population).
      */
-    void int_density();
+    void int_density(AtomicPartition partition = AtomicPartition::None);
 
 
 private:
+    /**
+     * @brief Reads one cube file into a channel of the density grid.
+     * @param filepath Path to the cube file.
+     * @param channel Channel index; channel 0 defines grid and atoms.
+     * @param header_only Stop after the atoms (no density values).
+     */
+    void read_cube(const std::string& filepath, int channel, bool header_only = false);
+
+    /**
+     * @brief Fills moments from the reduced points.
+     */
+    void compute_moments();
+
+    /**
+     * @brief Sorts the reduced points by decreasing magnitude (fills magnitude).
+     */
+    void sort_by_magnitude();
+
     /**
      * @brief Maps atomic number to corresponding element label.
      * @param Z Atomic number
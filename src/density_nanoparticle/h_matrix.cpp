@@ -0,0 +1,420 @@
+#include "h_matrix.hpp"
+#include "parameters.hpp"
+#include "linear_algebra.hpp"
+#include "kernels.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+namespace
+{
+  /// @brief Diagonal length of a bounding box.
+  double diameter(const std::array<double, 3> &low, const std::array<double, 3> &high)
+  {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; ++k)
+      d2 += (high[k] - low[k]) * (high[k] - low[k]);
+    return std::sqrt(d2);
+  }
+
+  /// @brief Distance between two bounding boxes (0 if they overlap).
+  double box_distance(const std::array<double, 3> &low_a, const std::array<double, 3> &high_a,
+                      const std::array<double, 3> &low_b, const std::array<double, 3> &high_b)
+  {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; ++k)
+    {
+      const double gap = std::max({0.0, low_a[k] - high_b[k], low_b[k] - high_a[k]});
+      d2 += gap * gap;
+    }
+    return std::sqrt(d2);
+  }
+} // namespace
+
+///
+/// @brief Constructor for H_matrix.
+///
+H_matrix::H_matrix(std::span<const std::array<double, 3>> rows, std::span<const std::array<double, 3>> cols, double tolerance)
+    : tolerance(tolerance), nrows(rows.size()), ncols(cols.size())
+{
+  if (tolerance <= 0.0)
+    throw std::invalid_argument("Compression tolerance must be positive.");
+
+  if (nrows == 0 || ncols == 0)
+    return;
+
+  build_clusters(rows, row_permutation, row_clusters);
+  build_clusters(cols, col_permutation, col_clusters);
+
+  row_xyz.resize(nrows);
+  for (std::size_t p = 0; p < nrows; ++p)
+    row_xyz[p] = rows[row_permutation[p]];
+  col_xyz.resize(ncols);
+  for (std::size_t p = 0; p < ncols; ++p)
+    col_xyz[p] = cols[col_permutation[p]];
+
+  build_blocks(0, 0);
+
+  const int nblocks = blocks.size();
+#pragma omp parallel for schedule(dynamic)
+  for (int b = 0; b < nblocks; ++b)
+    fill_block(blocks[b]);
+
+  for (const auto &block : blocks)
+  {
+    if (block.low_rank)
+    {
+      ++low_rank_blocks;
+      max_rank = std::max(max_rank, block.rank);
+    }
+    else
+    {
+      ++dense_blocks;
+    }
+    stored_values += block.U.size() + block.V.size();
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Builds the cluster tree by bisecting bounding boxes at the median
+/// of their longest side. Cluster 0 is the root.
+///
+void H_matrix::build_clusters(std::span<const std::array<double, 3>> points, std::vector<int> &permutation,
+                              std::vector<Cluster> &clusters)
+{
+  permutation.resize(points.size());
+  std::iota(permutation.begin(), permutation.end(), 0);
+  clusters.clear();
+
+  // Explicit stack of clusters to split
+  clusters.push_back({0, static_cast<int>(points.size())});
+  std::vector<int> pending = {0};
+
+  while (!pending.empty())
+  {
+    const int c = pending.back();
+    pending.pop_back();
+
+    Cluster cluster = clusters[c];
+    cluster.low = points[permutation[cluster.begin]];
+    cluster.high = cluster.low;
+    for (int p = cluster.begin; p < cluster.end; ++p)
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        cluster.low[k] = std::min(cluster.low[k], points[permutation[p]][k]);
+        cluster.high[k] = std::max(cluster.high[k], points[permutation[p]][k]);
+      }
+    }
+
+    if (cluster.end - cluster.begin > Parameters::h_matrix_leaf_size)
+    {
+      int axis = 0;
+      for (int k = 1; k < 3; ++k)
+        if (cluster.high[k] - cluster.low[k] > cluster.high[axis] - cluster.low[axis])
+          axis = k;
+
+      const int middle = (cluster.begin + cluster.end) / 2;
+      std::nth_element(permutation.begin() + cluster.begin, permutation.begin() + middle, permutation.begin() + cluster.end,
+                       [&](int a, int b)
+                       { return points[a][axis] < points[b][axis]; });
+
+      cluster.child[0] = clusters.size();
+      cluster.child[1] = clusters.size() + 1;
+      clusters.push_back({cluster.begin, middle});
+      clusters.push_back({middle, cluster.end});
+      pending.push_back(cluster.child[0]);
+      pending.push_back(cluster.child[1]);
+    }
+
+    clusters[c] = cluster;
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Recursively partitions the operator into admissible (low-rank) and
+/// small dense blocks.
+///
+void H_matrix::build_blocks(int row_cluster, int col_cluster)
+{
+  const Cluster &r = row_clusters[row_cluster];
+  const Cluster &c = col_clusters[col_cluster];
+
+  const double distance = box_distance(r.low, r.high, c.low, c.high);
+  const bool admissible = distance > 0.0 &&
+                          std::min(diameter(r.low, r.high), diameter(c.low, c.high)) <= Parameters::h_matrix_eta * distance;
+  const bool row_leaf = r.child[0] < 0;
+  const bool col_leaf = c.child[0] < 0;
+
+  if (admissible || (row_leaf && col_leaf))
+  {
+    Block block;
+    block.row_begin = r.begin;
+    block.row_end = r.end;
+    block.col_begin = c.begin;
+    block.col_end = c.end;
+    block.low_rank = admissible;
+    blocks.push_back(std::move(block));
+    return;
+  }
+
+  const int row_children[2] = {r.child[0], r.child[1]};
+  const int col_children[2] = {c.child[0], c.child[1]};
+
+  if (row_leaf)
+  {
+    for (int cc : col_children)
+      build_blocks(row_cluster, cc);
+  }
+  else if (col_leaf)
+  {
+    for (int rc : row_children)
+      build_blocks(rc, col_cluster);
+  }
+  else
+  {
+    for (int rc : row_children)
+      for (int cc : col_children)
+        build_blocks(rc, cc);
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Screened Coulomb kernel between permuted row i and column j.
+///
+double H_matrix::kernel(int i, int j) const
+{
+  const double dx = row_xyz[i][0] - col_xyz[j][0];
+  const double dy = row_xyz[i][1] - col_xyz[j][1];
+  const double dz = row_xyz[i][2] - col_xyz[j][2];
+  const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+  return coulomb_kernel<Screening::Screened>(dist);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Fills a block. Admissible blocks are approximated by ACA with
+/// partial pivoting: one kernel row and one column per rank, stopped when
+/// the last update is below tolerance times the estimated Frobenius norm of
+/// the approximation. Blocks whose rank would not save memory are stored dense.
+///
+void H_matrix::fill_block(Block &block) const
+{
+  const int m = block.row_end - block.row_begin;
+  const int n = block.col_end - block.col_begin;
+
+  if (block.low_rank)
+  {
+    const int max_rank = (m * n) / (m + n);
+
+    std::vector<double> &U = block.U;
+    std::vector<double> &V = block.V;
+    std::vector<char> row_used(m, 0);
+    std::vector<double> row(n), col(m);
+
+    double norm2 = 0.0;
+    int rank = 0;
+    int pivot = 0;
+    bool converged = false;
+
+    while (rank < max_rank)
+    {
+      row_used[pivot] = 1;
+
+      // Residual row of the pivot
+      for (int j = 0; j < n; ++j)
+      {
+        double value = kernel(block.row_begin + pivot, block.col_begin + j);
+        for (int l = 0; l < rank; ++l)
+          value -= U[l * m + pivot] * V[l * n + j];
+        row[j] = value;
+      }
+
+      int column = 0;
+      for (int j = 1; j < n; ++j)
+        if (std::abs(row[j]) > std::abs(row[column]))
+          column = j;
+
+      if (row[column] == 0.0)
+      {
+        // Row already reproduced: try the next unused one
+        const auto next = std::find(row_used.begin(), row_used.end(), 0);
+        if (next == row_used.end())
+        {
+          converged = true;
+          break;
+        }
+        pivot = next - row_used.begin();
+        continue;
+      }
+
+      const double inv_pivot = 1.0 / row[column];
+      for (int j = 0; j < n; ++j)
+        row[j] *= inv_pivot;
+
+      // Residual column of the pivot
+      for (int i = 0; i < m; ++i)
+      {
+        double value = kernel(block.row_begin + i, block.col_begin + column);
+        for (int l = 0; l < rank; ++l)
+          value -= V[l * n + column] * U[l * m + i];
+        col[i] = value;
+      }
+
+      // Frobenius norm of the approximation, updated with the new rank-1 term
+      double uu = 0.0, vv = 0.0, cross = 0.0;
+      for (int i = 0; i < m; ++i)
+        uu += col[i] * col[i];
+      for (int j = 0; j < n; ++j)
+        vv += row[j] * row[j];
+      for (int l = 0; l < rank; ++l)
+      {
+        double ul = 0.0, vl = 0.0;
+        for (int i = 0; i < m; ++i)
+          ul += col[i] * U[l * m + i];
+        for (int j = 0; j < n; ++j)
+          vl += row[j] * V[l * n + j];
+        cross += ul * vl;
+      }
+      norm2 += uu * vv + 2.0 * cross;
+
+      U.insert(U.end(), col.begin(), col.end());
+      V.insert(V.end(), row.begin(), row.end());
+      ++rank;
+
+      if (std::sqrt(uu * vv) <= tolerance * std::sqrt(norm2))
+      {
+        converged = true;
+        break;
+      }
+
+      // Next pivot: largest entry of the new column among unused rows
+      int next = -1;
+      for (int i = 0; i < m; ++i)
+        if (!row_used[i] && (next < 0 || std::abs(col[i]) > std::abs(col[next])))
+          next = i;
+      if (next < 0)
+      {
+        converged = true;
+        break;
+      }
+      pivot = next;
+    }
+
+    if (converged)
+    {
+      block.rank = rank;
+      U.shrink_to_fit();
+      V.shrink_to_fit();
+      return;
+    }
+
+    block.low_rank = false;
+    block.rank = 0;
+    V.clear();
+    V.shrink_to_fit();
+  }
+
+  block.U.resize(static_cast<std::size_t>(m) * n);
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < m; ++i)
+      block.U[i + static_cast<std::size_t>(j) * m] = kernel(block.row_begin + i, block.col_begin + j);
+}
+//----------------------------------------------------------------------
+///
+/// @brief y = K x for nrhs weight vectors; blocks are applied in parallel
+/// with matrix products (X is nrhs x points column-major, as stored).
+///
+void H_matrix::apply(std::span<const double> x, int nrhs, std::span<double> y) const
+{
+  if (nrhs < 1 || x.size() != ncols * nrhs || y.size() != nrows * nrhs)
+    throw std::invalid_argument("Weights do not match the compressed operator size.");
+
+  // Weights in cluster order
+  std::vector<double> x_perm(x.size());
+  for (std::size_t p = 0; p < ncols; ++p)
+    std::copy_n(&x[static_cast<std::size_t>(col_permutation[p]) * nrhs], nrhs, &x_perm[p * nrhs]);
+
+  std::vector<double> y_perm(y.size(), 0.0);
+  const int nblocks = blocks.size();
+
+#pragma omp parallel
+  {
+    std::vector<double> y_local(y.size(), 0.0);
+    std::vector<double> t;
+
+#pragma omp for schedule(dynamic)
+    for (int b = 0; b < nblocks; ++b)
+    {
+      const Block &block = blocks[b];
+      const int m = block.row_end - block.row_begin;
+      const int n = block.col_end - block.col_begin;
+      const double *xb = &x_perm[static_cast<std::size_t>(block.col_begin) * nrhs];
+      double *yb = &y_local[static_cast<std::size_t>(block.row_begin) * nrhs];
+
+      if (block.low_rank)
+      {
+        // T = X V, then Y += T U^T
+        t.assign(static_cast<std::size_t>(nrhs) * block.rank, 0.0);
+        gemm('N', 'N', nrhs, block.rank, n, 1.0, xb, nrhs, block.V.data(), n, 0.0, t.data(), nrhs);
+        gemm('N', 'T', nrhs, m, block.rank, 1.0, t.data(), nrhs, block.U.data(), m, 1.0, yb, nrhs);
+      }
+      else
+      {
+        gemm('N', 'T', nrhs, m, n, 1.0, xb, nrhs, block.U.data(), m, 1.0, yb, nrhs);
+      }
+    }
+
+#pragma omp critical
+    for (std::size_t k = 0; k < y_perm.size(); ++k)
+      y_perm[k] += y_local[k];
+  }
+
+  for (std::size_t p = 0; p < nrows; ++p)
+    std::copy_n(&y_perm[p * nrhs], nrhs, &y[static_cast<std::size_t>(row_permutation[p]) * nrhs]);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Relative error of apply() against the direct sum, on
+/// h_matrix_sample_rows rows spread over the operator.
+///
+double H_matrix::sampled_error(std::span<const double> x, int nrhs) const
+{
+  if (nrows == 0 || ncols == 0)
+    return 0.0;
+
+  std::vector<double> y(nrows * nrhs);
+  apply(x, nrhs, y);
+
+  const int nsamples = std::min<std::size_t>(Parameters::h_matrix_sample_rows, nrows);
+  double diff2 = 0.0, exact2 = 0.0;
+
+#pragma omp parallel for reduction(+ : diff2, exact2) schedule(dynamic)
+  for (int s = 0; s < nsamples; ++s)
+  {
+    const int p = static_cast<std::size_t>(s) * nrows / nsamples;
+    const std::size_t row = row_permutation[p];
+
+    std::vector<double> exact(nrhs, 0.0);
+    for (std::size_t q = 0; q < ncols; ++q)
+    {
+      const double k = kernel(p, q);
+      const double *xq = &x[static_cast<std::size_t>(col_permutation[q]) * nrhs];
+      for (int r = 0; r < nrhs; ++r)
+        exact[r] += k * xq[r];
+    }
+
+    for (int r = 0; r < nrhs; ++r)
+    {
+      const double d = y[row * nrhs + r] - exact[r];
+      diff2 += d * d;
+      exact2 += exact[r] * exact[r];
+    }
+  }
+
+  return exact2 > 0.0 ? std::sqrt(diff2 / exact2) : std::sqrt(diff2);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,100 @@
+#ifndef H_MATRIX_HPP
+#define H_MATRIX_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstddef>
+
+///
+/// @class H_matrix
+/// @brief Hierarchical low-rank representation of the screened Coulomb
+/// operator K(i, j) = erf(r_ij / QMscrnFact) / r_ij between two point sets.
+///
+/// Both point sets are organised in cluster trees (bisection of bounding
+/// boxes). Pairs of clusters that are far apart compared to their size
+/// (admissible) are stored as low-rank factors U V^T obtained by adaptive
+/// cross approximation (ACA) with partial pivoting; the remaining small
+/// blocks are stored dense. Building costs about as much as one direct
+/// evaluation, and every product with new weights is then near-linear, so
+/// the operator pays off for several states, frequencies or jobs on the
+/// same geometry.
+///
+class H_matrix
+{
+public:
+  /**
+   * @brief Builds the operator (in parallel over blocks).
+   * @param rows Row points (e.g. acceptor).
+   * @param cols Column points (e.g. donor or nanoparticle sites).
+   * @param tolerance Relative accuracy of the low-rank blocks.
+   */
+  H_matrix(std::span<const std::array<double, 3>> rows, std::span<const std::array<double, 3>> cols, double tolerance);
+
+  /**
+   * @brief y = K x for nrhs weight vectors at once.
+   * @param x Column weights, indexed [point * nrhs + r].
+   * @param nrhs Number of weight vectors.
+   * @param y Result, indexed [row point * nrhs + r].
+   */
+  void apply(std::span<const double> x, int nrhs, std::span<double> y) const;
+
+  /**
+   * @brief Relative error of apply() for the given weights, measured against the
+   * direct sum on a sample of rows.
+   */
+  double sampled_error(std::span<const double> x, int nrhs) const;
+
+  double tolerance;
+
+  // Statistics
+  std::size_t nrows = 0, ncols = 0;
+  std::size_t low_rank_blocks = 0;
+  std::size_t dense_blocks = 0;
+  int max_rank = 0;
+  std::size_t stored_values = 0; ///< Doubles held by all blocks
+
+  /// @brief Memory of the compressed operator (bytes).
+  std::size_t memory_bytes() const { return stored_values * sizeof(double); }
+
+  /// @brief Memory the dense operator would need (bytes).
+  std::size_t dense_bytes() const { return nrows * ncols * sizeof(double); }
+
+private:
+  struct Cluster
+  {
+    int begin = 0, end = 0;               ///< Range in the permuted point order
+    std::array<double, 3> low{}, high{};  ///< Bounding box
+    int child[2] = {-1, -1};
+  };
+
+  struct Block
+  {
+    int row_begin = 0, row_end = 0;
+    int col_begin = 0, col_end = 0;
+    bool low_rank = false;
+    int rank = 0;
+    std::vector<double> U; ///< Column-major rows x rank (low rank), or rows x cols (dense)
+    std::vector<double> V; ///< Column-major cols x rank (low rank only)
+  };
+
+  /// @brief Builds the cluster tree of points; fills the permutation.
+  static void build_clusters(std::span<const std::array<double, 3>> points, std::vector<int> &permutation,
+                             std::vector<Cluster> &clusters);
+
+  /// @brief Splits the pair of clusters until blocks are admissible or leaves.
+  void build_blocks(int row_cluster, int col_cluster);
+
+  /// @brief Fills a block: ACA for admissible blocks (dense if it does not pay off).
+  void fill_block(Block &block) const;
+
+  /// @brief Kernel entry between row i and column j of the permuted orders.
+  double kernel(int i, int j) const;
+
+  std::vector<std::array<double, 3>> row_xyz, col_xyz; ///< Points in permuted order
+  std::vector<int> row_permutation, col_permutation;    ///< Permuted position -> original index
+  std::vector<Cluster> row_clusters, col_clusters;
+  std::vector<Block> blocks;
+};
+
+#endif // H_MATRIX_HPP
@@ -2,68 +2,791 @@
 #include "target.hpp"
 #include "density.hpp"
 #include "parameters.hpp"
+#include "linear_algebra.hpp"
+#include "kernels.hpp"
+#include "checkpoint.hpp"
+#include "hash.hpp"
+#include "progress.hpp"
+#include "sampled_coupling.hpp"
+#include "chromophore.hpp"
+#include "ranks.hpp"
 
 #include <cmath>
 #include <omp.h>
 #include <ostream>
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <vector>
 
 ///
 /// @brief Computes the Coulomb and overlap integrals between acceptor and donor densities.
 ///
 void Integrals::acceptor_donor(const Target &target, const Density &acceptor, const Density &donor)
 {
-  int n_acc = acceptor.n_points_reduced;
-  int n_don = donor.n_points_reduced;
+  if (!target.checkpoint_file.empty())
+  {
+    acceptor_donor_checkpointed(target, acceptor, donor);
+    return;
+  }
+
+  if (target.is_monte_carlo_present)
+  {
+    if (acceptor.nchannels > 1 || donor.nchannels > 1)
+      throw std::runtime_error("Monte Carlo couplings support one acceptor and one donor state.");
+    acceptor_donor_sampled(acceptor.rho_reduced, acceptor.xyz, donor.rho_reduced, donor.xyz,
+                           target.monte_carlo_tolerance, target.monte_carlo_seed);
+    return;
+  }
 
-  // Direct references (no deep copies). Needed for multithreaded performance.
-  const auto &rho_acc = acceptor.rho_reduced;
-  const auto &rho_don = donor.rho_reduced;
-  const auto &xyz_acc = acceptor.xyz;
-  const auto &xyz_don = donor.xyz;
+  if (target.is_dipole_prescreen_present)
+  {
+    if (acceptor.nchannels > 1 || donor.nchannels > 1)
+      throw std::runtime_error("The dipole prescreen supports one acceptor and one donor state.");
+    if (!dipole_prescreen(acceptor.moments, donor.moments, target.dipole_prescreen_tolerance))
+      return;
+  }
+
+  // Same density at the same place: the pair matrix is symmetric
+  if (&acceptor == &donor)
+  {
+    acceptor_donor_symmetric(acceptor.rho_reduced, acceptor.xyz, acceptor.nchannels,
+                             target.calc_overlap_int, target.omega_0);
+    return;
+  }
 
-  double int_coulomb = 0.0;
-  double int_overlap = 0.0;
+  if (acceptor.nchannels > 1 || donor.nchannels > 1)
+  {
+    acceptor_donor_matrix(acceptor.rho_reduced, acceptor.xyz, acceptor.nchannels,
+                          donor.rho_reduced, donor.xyz, donor.nchannels,
+                          target.calc_overlap_int, target.omega_0);
+    return;
+  }
 
-  bool calc_overlap = target.calc_overlap_int;
+  acceptor_donor(acceptor.rho_reduced, acceptor.xyz, donor.rho_reduced, donor.xyz,
+                 target.calc_overlap_int, target.omega_0);
+}
+//----------------------------------------------------------------------
+namespace
+{
+  ///
+  /// @brief Coulomb (and overlap) sums of two reduced point sets, one
+  /// instantiation per interaction type. The overlap pairs points with the
+  /// same index, so it is a separate loop rather than a test in the pair loop.
+  /// Only the acceptor rows [i_begin, i_end) are summed.
+  ///
+  template <bool Overlap, Screening S>
+  std::array<double, 2> coulomb_pairs(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                                      std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don,
+                                      int i_begin, int i_end)
+  {
+    const int n_don = rho_don.size();
 
-  // QMscrnFact is a constant defined in Parameters
-  const double inv_QMscrnFact = 1.0 / Parameters::QMscrnFact;
+    double int_coulomb = 0.0;
+    double int_overlap = 0.0;
 
 // For parallel computation if OMP is ON
 #pragma omp parallel for reduction(+ : int_coulomb, int_overlap) schedule(static)
-  for (int i = 0; i < n_acc; ++i)
+    for (int i = i_begin; i < i_end; ++i)
+    {
+      if constexpr (Overlap)
+      {
+        if (i < n_don)
+          int_overlap += rho_acc[i] * rho_don[i];
+      }
+
+      double row = 0.0;
+      for (int j = 0; j < n_don; ++j)
+      {
+        const double dx = xyz_acc[i][0] - xyz_don[j][0];
+        const double dy = xyz_acc[i][1] - xyz_don[j][1];
+        const double dz = xyz_acc[i][2] - xyz_don[j][2];
+        const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        row += rho_don[j] * coulomb_kernel<S>(dist);
+      }
+      int_coulomb += rho_acc[i] * row;
+      Progress::add(n_don);
+    }
+
+    return {int_coulomb, int_overlap};
+  }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Computes the Coulomb and overlap integrals between two reduced point sets.
+///
+void Integrals::acceptor_donor(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                               std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don,
+                               bool calc_overlap, double omega_0)
+{
+  // Rows of this rank (all of them without MPI)
+  const auto [i_begin, i_end] = Ranks::share(rho_acc.size());
+  Progress::expect(static_cast<std::uint64_t>(i_end - i_begin) * rho_don.size());
+
+  auto sums = with_flag(calc_overlap, [&](auto overlap)
+                        { return with_screening(screened, [&](auto s)
+                                                { return coulomb_pairs<overlap.value, s.value>(rho_acc, xyz_acc, rho_don, xyz_don, i_begin, i_end); }); });
+  Ranks::sum(sums);
+
+  coulomb_acceptor_donor = sums[0];
+  if (calc_overlap)
+    overlap_acceptor_donor = -omega_0 * sums[1];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Estimates the acceptor-donor Coulomb coupling by importance sampling
+/// (see Sampled_coupling), with its standard error.
+///
+void Integrals::acceptor_donor_sampled(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                                       std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don,
+                                       double tolerance, std::uint64_t seed)
+{
+  Sampled_coupling sampled(rho_acc, xyz_acc, rho_don, 1, xyz_don, screened);
+  sampled.estimate(tolerance, seed);
+
+  coulomb_acceptor_donor = sampled.value[0];
+  overlap_acceptor_donor = 0.0;
+
+  monte_carlo_error = sampled.error;
+  monte_carlo_samples = sampled.samples;
+  monte_carlo_near_pairs = sampled.near_pairs;
+  monte_carlo_far_pairs = sampled.far_pairs;
+  monte_carlo_converged = sampled.converged;
+  monte_carlo_exact = sampled.exact;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Couplings of three models built from the moments of the densities:
+///
+///   - ideal dipoles: (mu_A . mu_D - 3 (mu_A . R)(mu_D . R) / R^2) / R^3
+///   - extended dipoles: the positive and the negative weights of each
+///     density as two point charges at their weighted centers
+///   - cell multipoles (Chromophore::Cell::coulomb): charge, dipole and the
+///     charge - quadrupole terms
+///
+/// The error of the multipole coupling is estimated as the largest of its
+/// distance to the two dipole models and of the size of the first neglected
+/// (dipole - quadrupole) term, 3 (|mu_A| |Q_D| + |Q_A| |mu_D|) / R^4. The
+/// models use the bare kernel; with screening, point pairs are at least the
+/// gap apart, so |V| erfc(gap / QMscrnFact) is added to the error.
+///
+bool Integrals::dipole_prescreen(const Density::Moments &acceptor, const Density::Moments &donor, double tolerance)
+{
+  std::array<double, 3> r{};
+  for (int k = 0; k < 3; ++k)
+    r[k] = donor.center[k] - acceptor.center[k];
+  const double distance = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+
+  prescreen_distance = distance;
+  prescreen_gap = distance - acceptor.radius - donor.radius;
+  prescreen_promoted = true;
+  prescreen_dipole = prescreen_extended_dipole = prescreen_multipole = prescreen_error = 0.0;
+  if (prescreen_gap <= 0.0)
+    return true;
+
+  auto dot = [](const std::array<double, 3> &a, const std::array<double, 3> &b)
+  { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+
+  const double inv_r = 1.0 / distance;
+  prescreen_dipole = (dot(acceptor.dipole, donor.dipole) -
+                      3.0 * dot(acceptor.dipole, r) * dot(donor.dipole, r) * inv_r * inv_r) *
+                     inv_r * inv_r * inv_r;
+
+  const std::array<std::pair<double, std::array<double, 3>>, 2> acceptor_charges = {
+      std::pair{acceptor.positive, acceptor.positive_center}, std::pair{acceptor.negative, acceptor.negative_center}};
+  const std::array<std::pair<double, std::array<double, 3>>, 2> donor_charges = {
+      std::pair{donor.positive, donor.positive_center}, std::pair{donor.negative, donor.negative_center}};
+  for (const auto &[qa, ra] : acceptor_charges)
+    for (const auto &[qd, rd] : donor_charges)
+    {
+      const double dx = ra[0] - rd[0], dy = ra[1] - rd[1], dz = ra[2] - rd[2];
+      prescreen_extended_dipole += qa * qd / std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+  Chromophore::Cell cell_acceptor{acceptor.center, acceptor.charge, acceptor.dipole, acceptor.quadrupole};
+  Chromophore::Cell cell_donor{donor.center, donor.charge, donor.dipole, donor.quadrupole};
+  prescreen_multipole = cell_acceptor.coulomb(cell_donor);
+
+  auto norm = [](const std::array<double, 6> &q)
+  { return std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + 2.0 * (q[3] * q[3] + q[4] * q[4] + q[5] * q[5])); };
+  const double dipole_quadrupole = 3.0 * (std::sqrt(dot(acceptor.dipole, acceptor.dipole)) * norm(donor.quadrupole) +
+                                          norm(acceptor.quadrupole) * std::sqrt(dot(donor.dipole, donor.dipole))) *
+                                   std::pow(inv_r, 4);
+
+  prescreen_error = std::max({std::abs(prescreen_multipole - prescreen_dipole),
+                              std::abs(prescreen_multipole - prescreen_extended_dipole), dipole_quadrupole});
+  if (screened)
+    prescreen_error += std::abs(prescreen_multipole) * std::erfc(prescreen_gap / Parameters::QMscrnFact);
+  prescreen_promoted = prescreen_error > tolerance * std::abs(prescreen_multipole);
+  if (prescreen_promoted)
+    return true;
+
+  coulomb_acceptor_donor = prescreen_multipole;
+  overlap_acceptor_donor = 0.0;
+  return false;
+}
+//----------------------------------------------------------------------
+namespace
+{
+  ///
+  /// @brief Adds the Coulomb coupling of every acceptor state with every donor
+  /// state to C (S_A x S_D, column-major).
+  ///
+  /// The pair sum is split into tiles of acceptor x donor points. For each tile
+  /// the kernel K (TI x TJ) is evaluated once and shared by all states:
+  ///
+  ///     C(S_A x S_D) += A_tile(S_A x TI) * K(TI x TJ) * D_tile(S_D x TJ)^T
+  ///
+  /// which are two small matrix products (BLAS dgemm when available).
+  ///
+  template <Screening S>
+  void add_coulomb_tiles(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc, int sa,
+                         std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don, int sd,
+                         std::vector<double> &coulomb)
   {
-    for (int j = 0; j < n_don; ++j)
+    const int n_acc = xyz_acc.size();
+    const int n_don = xyz_don.size();
+
+    const int tile = Parameters::coupling_tile_size;
+    const int n_tiles_acc = (n_acc + tile - 1) / tile;
+
+#pragma omp parallel
     {
-      if (calc_overlap && i == j)
+      std::vector<double> kernel(static_cast<std::size_t>(tile) * tile);
+      std::vector<double> partial(static_cast<std::size_t>(sa) * tile);
+      std::vector<double> coulomb_local(sa * sd, 0.0);
+
+#pragma omp for schedule(dynamic)
+      for (int ti = 0; ti < n_tiles_acc; ++ti)
       {
-        int_overlap += rho_acc[i] * rho_don[j];
+        const int i0 = ti * tile;
+        const int ni = std::min(tile, n_acc - i0);
+
+        for (int j0 = 0; j0 < n_don; j0 += tile)
+        {
+          const int nj = std::min(tile, n_don - j0);
+
+          // Coulomb kernel of the tile, K(i, j) column-major
+          for (int j = 0; j < nj; ++j)
+          {
+            const auto &rj = xyz_don[j0 + j];
+            for (int i = 0; i < ni; ++i)
+            {
+              const auto &ri = xyz_acc[i0 + i];
+              const double dx = ri[0] - rj[0];
+              const double dy = ri[1] - rj[1];
+              const double dz = ri[2] - rj[2];
+              const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+              kernel[i + j * ni] = coulomb_kernel<S>(dist);
+            }
+          }
+
+          // partial(S_A x TJ) = A_tile * K
+          gemm('N', 'N', sa, nj, ni, 1.0, &rho_acc[static_cast<std::size_t>(i0) * sa], sa,
+               kernel.data(), ni, 0.0, partial.data(), sa);
+
+          // C += partial * D_tile^T
+          gemm('N', 'T', sa, sd, nj, 1.0, partial.data(), sa,
+               &rho_don[static_cast<std::size_t>(j0) * sd], sd, 1.0, coulomb_local.data(), sa);
+          Progress::add(static_cast<std::uint64_t>(ni) * nj);
+        }
       }
 
-      double dx = xyz_acc[i][0] - xyz_don[j][0];
-      double dy = xyz_acc[i][1] - xyz_don[j][1];
-      double dz = xyz_acc[i][2] - xyz_don[j][2];
+#pragma omp critical
+      for (int k = 0; k < sa * sd; ++k)
+        coulomb[k] += coulomb_local[k];
+    }
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Same as add_coulomb_tiles for a point set with itself. Only the
+  /// tiles (ti, tj) with tj >= ti are evaluated, and only the lower triangle
+  /// of the diagonal tiles' kernel; each off-diagonal tile also adds the
+  /// transpose of its contribution, which stands for tile (tj, ti). Only
+  /// the tile rows [ti_begin, ti_end) are done if given (-1: all).
+  ///
+  template <Screening S>
+  void add_coulomb_tiles_symmetric(std::span<const double> rho, std::span<const std::array<double, 3>> xyz, int ns,
+                                   std::vector<double> &coulomb, int ti_begin = 0, int ti_end = -1)
+  {
+    const int n = xyz.size();
+
+    const int tile = Parameters::coupling_tile_size;
+    const int n_tiles = (n + tile - 1) / tile;
+    if (ti_end < 0)
+      ti_end = n_tiles;
+
+#pragma omp parallel
+    {
+      std::vector<double> kernel(static_cast<std::size_t>(tile) * tile);
+      std::vector<double> partial(static_cast<std::size_t>(ns) * tile);
+      std::vector<double> block(ns * ns);
+      std::vector<double> coulomb_local(ns * ns, 0.0);
+
+#pragma omp for schedule(dynamic)
+      for (int ti = ti_begin; ti < ti_end; ++ti)
+      {
+        const int i0 = ti * tile;
+        const int ni = std::min(tile, n - i0);
+
+        for (int tj = ti; tj < n_tiles; ++tj)
+        {
+          const int j0 = tj * tile;
+          const int nj = std::min(tile, n - j0);
+
+          for (int j = 0; j < nj; ++j)
+          {
+            const auto &rj = xyz[j0 + j];
+            const int i_start = (ti == tj) ? j : 0;
+            for (int i = i_start; i < ni; ++i)
+            {
+              const auto &ri = xyz[i0 + i];
+              const double dx = ri[0] - rj[0];
+              const double dy = ri[1] - rj[1];
+              const double dz = ri[2] - rj[2];
+              const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+              kernel[i + j * ni] = coulomb_kernel<S>(dist);
+            }
+          }
 
-      double dist2 = dx * dx + dy * dy + dz * dz;
-      double dist = std::sqrt(dist2);
+          // Diagonal tile: mirror the lower triangle
+          if (ti == tj)
+            for (int j = 0; j < nj; ++j)
+              for (int i = 0; i < j; ++i)
+                kernel[i + j * ni] = kernel[j + i * ni];
 
-      if (dist <= 1.0e-14)
-        continue;
+          gemm('N', 'N', ns, nj, ni, 1.0, &rho[static_cast<std::size_t>(i0) * ns], ns,
+               kernel.data(), ni, 0.0, partial.data(), ns);
+          gemm('N', 'T', ns, ns, nj, 1.0, partial.data(), ns,
+               &rho[static_cast<std::size_t>(j0) * ns], ns, 0.0, block.data(), ns);
 
-      // Screening factor to avoid singularities
-      double invdist = 1.0 / dist;
-      double sf = dist * inv_QMscrnFact;
-      double screen_pot = std::erf(sf);
+          for (int t = 0; t < ns; ++t)
+            for (int s = 0; s < ns; ++s)
+              coulomb_local[s + t * ns] += (ti == tj) ? block[s + t * ns] : block[s + t * ns] + block[t + s * ns];
+          Progress::add((ti == tj) ? static_cast<std::uint64_t>(ni) * (ni + 1) / 2 : static_cast<std::uint64_t>(ni) * nj);
+        }
+      }
 
-      int_coulomb += rho_acc[i] * rho_don[j] * invdist * screen_pot;
+#pragma omp critical
+      for (int k = 0; k < ns * ns; ++k)
+        coulomb[k] += coulomb_local[k];
     }
   }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Computes the Coulomb (and overlap) coupling matrix between all
+/// acceptor and donor states sharing one grid per molecule.
+///
+void Integrals::acceptor_donor_matrix(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc, int nstates_acc,
+                                      std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don, int nstates_don,
+                                      bool calc_overlap, double omega_0)
+{
+  const int n_acc = xyz_acc.size();
+  const int n_don = xyz_don.size();
+  const int sa = nstates_acc;
+  const int sd = nstates_don;
+
+  if (sa < 1 || sd < 1 || rho_acc.size() != xyz_acc.size() * sa || rho_don.size() != xyz_don.size() * sd)
+    throw std::invalid_argument("Density values do not match points x states.");
+
+  nstates_acceptor = sa;
+  nstates_donor = sd;
+  coulomb_matrix.assign(sa * sd, 0.0);
+  overlap_matrix.assign(sa * sd, 0.0);
+
+  // Whole acceptor tiles of this rank
+  const int tile = Parameters::coupling_tile_size;
+  const auto [t_begin, t_end] = Ranks::share((n_acc + tile - 1) / tile);
+  const int i0 = std::min(t_begin * tile, n_acc);
+  const int ni = std::min(t_end * tile, n_acc) - i0;
+
+  Progress::expect(static_cast<std::uint64_t>(ni) * n_don);
+  with_screening(screened, [&](auto s)
+                 { add_coulomb_tiles<s.value>(rho_acc.subspan(static_cast<std::size_t>(i0) * sa, static_cast<std::size_t>(ni) * sa),
+                                              xyz_acc.subspan(i0, ni), sa, rho_don, xyz_don, sd, coulomb_matrix); });
+  Ranks::sum(coulomb_matrix);
+
+  // Overlap pairs points with the same index (all grid points are kept)
+  if (calc_overlap)
+  {
+    const int n = std::min(n_acc, n_don);
+    gemm('N', 'T', sa, sd, n, -omega_0, rho_acc.data(), sa, rho_don.data(), sd, 0.0, overlap_matrix.data(), sa);
+  }
+
+  coulomb_acceptor_donor = coulomb_matrix[0];
+  overlap_acceptor_donor = overlap_matrix[0];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Coupling matrix of a density with itself (acceptor and donor are the
+/// same file at the same place): half of the symmetric pair matrix is evaluated.
+///
+void Integrals::acceptor_donor_symmetric(std::span<const double> rho, std::span<const std::array<double, 3>> xyz, int nstates,
+                                         bool calc_overlap, double omega_0)
+{
+  const int n = xyz.size();
+  const int ns = nstates;
+
+  if (ns < 1 || rho.size() != xyz.size() * ns)
+    throw std::invalid_argument("Density values do not match points x states.");
+
+  nstates_acceptor = ns;
+  nstates_donor = ns;
+  coulomb_matrix.assign(ns * ns, 0.0);
+  overlap_matrix.assign(ns * ns, 0.0);
+
+  // Tile rows of this rank; point row i pairs with the n - i points j >= i
+  const int tile = Parameters::coupling_tile_size;
+  const auto [t_begin, t_end] = Ranks::share((n + tile - 1) / tile);
+  const std::uint64_t i0 = std::min(t_begin * tile, n);
+  const std::uint64_t i1 = std::min(t_end * tile, n);
+
+  Progress::expect((i1 - i0) * n - (i0 + i1 - 1) * (i1 - i0) / 2);
+  with_screening(screened, [&](auto s)
+                 { add_coulomb_tiles_symmetric<s.value>(rho, xyz, ns, coulomb_matrix, t_begin, t_end); });
+  Ranks::sum(coulomb_matrix);
+
+  if (calc_overlap)
+    gemm('N', 'T', ns, ns, n, -omega_0, rho.data(), ns, rho.data(), ns, 0.0, overlap_matrix.data(), ns);
+
+  coulomb_acceptor_donor = coulomb_matrix[0];
+  overlap_acceptor_donor = overlap_matrix[0];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Coupling matrix of the acceptor and donor states, resumable.
+///
+/// The acceptor points are processed in Parameters::checkpoint_chunks chunks
+/// of whole tiles, in order, so the finished work is always the first rows;
+/// after each chunk the partial Coulomb matrix is handed to the checkpoint,
+/// which saves it every target.checkpoint_interval seconds. The checkpoint is
+/// tied to the reduced densities and kernel by a fingerprint. The overlap is
+/// a single pass over the points and is not checkpointed.
+///
+void Integrals::acceptor_donor_checkpointed(const Target &target, const Density &acceptor, const Density &donor)
+{
+  const bool symmetric = &acceptor == &donor;
+  const int n_acc = acceptor.xyz.size();
+  const int n_don = donor.xyz.size();
+  const int sa = acceptor.nchannels;
+  const int sd = donor.nchannels;
+
+  const std::array<std::int32_t, 4> settings = {symmetric, screened, sa, sd};
+  std::uint64_t fingerprint = fnv1a(settings.data(), sizeof(settings));
+  fingerprint = fnv1a(acceptor.rho_reduced.data(), acceptor.rho_reduced.size() * sizeof(double), fingerprint);
+  fingerprint = fnv1a(acceptor.xyz.data(), acceptor.xyz.size() * sizeof(acceptor.xyz[0]), fingerprint);
+  fingerprint = fnv1a(donor.rho_reduced.data(), donor.rho_reduced.size() * sizeof(double), fingerprint);
+  fingerprint = fnv1a(donor.xyz.data(), donor.xyz.size() * sizeof(donor.xyz[0]), fingerprint);
+
+  Checkpoint checkpoint(target.checkpoint_file, fingerprint, n_acc, sa * sd, target.checkpoint_interval);
+  checkpoint.load();
+
+  nstates_acceptor = sa;
+  nstates_donor = sd;
+  coulomb_matrix = checkpoint.values;
+  overlap_matrix.assign(sa * sd, 0.0);
+
+  // Whole tiles per chunk, independent of the thread count
+  const int tile = Parameters::coupling_tile_size;
+  const int chunk_tiles = std::max(1, (n_acc + tile * Parameters::checkpoint_chunks - 1) / (tile * Parameters::checkpoint_chunks));
+  const int chunk = chunk_tiles * tile;
+
+  // Pairs left: each acceptor point i pairs with n_don points, or with the n - i points j >= i
+  const std::uint64_t left = n_acc - checkpoint.rows_done;
+  Progress::expect(symmetric ? left * (left + 1) / 2 : left * n_don);
+
+  for (int i0 = checkpoint.rows_done; i0 < n_acc; i0 += chunk)
+  {
+    const int ni = std::min(chunk, n_acc - i0);
+
+    with_screening(screened, [&](auto s)
+                   {
+                     if (symmetric)
+                       add_coulomb_tiles_symmetric<s.value>(acceptor.rho_reduced, acceptor.xyz, sa, coulomb_matrix,
+                                                            i0 / tile, (i0 + ni + tile - 1) / tile);
+                     else
+                       add_coulomb_tiles<s.value>(std::span<const double>(acceptor.rho_reduced).subspan(static_cast<std::size_t>(i0) * sa, static_cast<std::size_t>(ni) * sa),
+                                                  std::span<const std::array<double, 3>>(acceptor.xyz).subspan(i0, ni), sa,
+                                                  donor.rho_reduced, donor.xyz, sd, coulomb_matrix); });
+
+    checkpoint.update(i0 + ni, coulomb_matrix);
+  }
+
+  if (target.calc_overlap_int)
+  {
+    const int n = std::min(n_acc, n_don);
+    gemm('N', 'T', sa, sd, n, -target.omega_0, acceptor.rho_reduced.data(), sa, donor.rho_reduced.data(), sd,
+         0.0, overlap_matrix.data(), sa);
+  }
+
+  checkpoint_rows = n_acc;
+  checkpoint_rows_resumed = checkpoint.rows_resumed;
+  checkpoint_saves = checkpoint.saves;
+  checkpoint.remove();
+
+  coulomb_acceptor_donor = coulomb_matrix[0];
+  overlap_acceptor_donor = overlap_matrix[0];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Computes the Coulomb (and overlap) coupling matrix with a compressed
+/// operator: Y = K D for all donor states at once, then C = A^T Y.
+///
+void Integrals::acceptor_donor(const H_matrix &op, std::span<const double> rho_acc, int nstates_acc,
+                               std::span<const double> rho_don, int nstates_don, bool calc_overlap, double omega_0)
+{
+  const int n_acc = op.nrows;
+  const int n_don = op.ncols;
+  const int sa = nstates_acc;
+  const int sd = nstates_don;
+
+  if (sa < 1 || sd < 1 || rho_acc.size() != op.nrows * sa || rho_don.size() != op.ncols * sd)
+    throw std::invalid_argument("Density values do not match points x states.");
+
+  nstates_acceptor = sa;
+  nstates_donor = sd;
+  coulomb_matrix.assign(sa * sd, 0.0);
+  overlap_matrix.assign(sa * sd, 0.0);
+
+  std::vector<double> potential(static_cast<std::size_t>(n_acc) * sd);
+  op.apply(rho_don, sd, potential);
+
+  gemm('N', 'T', sa, sd, n_acc, 1.0, rho_acc.data(), sa, potential.data(), sd, 0.0, coulomb_matrix.data(), sa);
 
-  coulomb_acceptor_donor = int_coulomb;
   if (calc_overlap)
-    overlap_acceptor_donor = -target.omega_0 * int_overlap;
+  {
+    const int n = std::min(n_acc, n_don);
+    gemm('N', 'T', sa, sd, n, -omega_0, rho_acc.data(), sa, rho_don.data(), sd, 0.0, overlap_matrix.data(), sa);
+  }
+
+  compression_error = op.sampled_error(rho_don, sd);
+  coulomb_acceptor_donor = coulomb_matrix[0];
+  overlap_acceptor_donor = overlap_matrix[0];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Acceptor-donor couplings for a list of decreasing cutoffs.
+///
+/// With both densities sorted by magnitude, the points of a cutoff are a prefix
+/// [0, n) of each. Going from (na, nd) to (na', nd') points adds
+///
+///     A[na, na') x D[0, nd')  +  A[0, na) x D[nd, nd')
+///
+/// so every pair of points is evaluated once over the whole sweep.
+///
+void Integrals::cutoff_sweep(const Density &acceptor, const Density &donor, std::span<const double> cutoffs, double tolerance)
+{
+  const int sa = acceptor.nchannels;
+  const int sd = donor.nchannels;
+  const std::span<const double> rho_acc(acceptor.rho_reduced);
+  const std::span<const double> rho_don(donor.rho_reduced);
+  const std::span<const std::array<double, 3>> xyz_acc(acceptor.xyz);
+  const std::span<const std::array<double, 3>> xyz_don(donor.xyz);
+
+  nstates_acceptor = sa;
+  nstates_donor = sd;
+  coulomb_matrix.assign(sa * sd, 0.0);
+  overlap_matrix.assign(sa * sd, 0.0);
+  sweep.clear();
+  sweep_converged = false;
+
+  std::vector<double> previous;
+  int na = 0, nd = 0;
+
+  for (const double cutoff : cutoffs)
+  {
+    const int na_new = acceptor.points_above(cutoff);
+    const int nd_new = donor.points_above(cutoff);
+    Progress::expect(static_cast<std::uint64_t>(na_new - na) * nd_new + static_cast<std::uint64_t>(na) * (nd_new - nd));
+
+    with_screening(screened, [&](auto s)
+                   {
+      add_coulomb_tiles<s.value>(rho_acc.subspan(na * sa, (na_new - na) * sa), xyz_acc.subspan(na, na_new - na), sa,
+                                 rho_don.first(nd_new * sd), xyz_don.first(nd_new), sd, coulomb_matrix);
+      add_coulomb_tiles<s.value>(rho_acc.first(na * sa), xyz_acc.first(na), sa,
+                                 rho_don.subspan(nd * sd, (nd_new - nd) * sd), xyz_don.subspan(nd, nd_new - nd), sd, coulomb_matrix); });
+    na = na_new;
+    nd = nd_new;
+
+    Sweep_step step{cutoff, na, nd, {coulomb_matrix[0], 0.0}};
+    if (!previous.empty())
+    {
+      double largest = 0.0;
+      for (std::size_t k = 0; k < coulomb_matrix.size(); ++k)
+      {
+        step.change = std::max(step.change, std::abs(coulomb_matrix[k] - previous[k]));
+        largest = std::max(largest, std::abs(coulomb_matrix[k]));
+      }
+      if (largest > 0.0)
+        step.change /= largest;
+    }
+    sweep.push_back(step);
+    previous = coulomb_matrix;
+
+    if (sweep.size() > 1 && step.change <= tolerance)
+    {
+      sweep_converged = true;
+      break;
+    }
+  }
+
+  coulomb_acceptor_donor = coulomb_matrix[0];
+  overlap_acceptor_donor = 0.0;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Acceptor-NP couplings for a list of decreasing cutoffs: each cutoff
+/// adds the new (sorted) acceptor points against all nanoparticle sites.
+///
+void Integrals::cutoff_sweep(const Density &acceptor, const Nanoparticle &np, std::span<const double> cutoffs, double tolerance)
+{
+  if (acceptor.nchannels > 1)
+    throw std::runtime_error("Several acceptor states are only supported for acceptor-donor couplings.");
+
+  const std::span<const double> rho_acc(acceptor.rho_reduced);
+  const std::span<const std::array<double, 3>> xyz_acc(acceptor.xyz);
+
+  std::vector<std::array<double, 2>> total(np.nfreq, {0.0, 0.0});
+  sweep.clear();
+  sweep_converged = false;
+
+  int na = 0;
+  for (const double cutoff : cutoffs)
+  {
+    const int na_new = acceptor.points_above(cutoff);
+
+    acceptor_np(rho_acc.subspan(na, na_new - na), xyz_acc.subspan(na, na_new - na), np.q, np.xyz, np.nfreq, np.mu);
+    na = na_new;
+
+    Sweep_step step{cutoff, na, static_cast<int>(np.xyz.size())};
+    double largest = 0.0;
+    for (int k = 0; k < np.nfreq; ++k)
+    {
+      for (int part = 0; part < 2; ++part)
+      {
+        total[k][part] += acceptor_nanoparticle_spectrum[k][part];
+        step.change = std::max(step.change, std::abs(acceptor_nanoparticle_spectrum[k][part]));
+        largest = std::max(largest, std::abs(total[k][part]));
+      }
+    }
+    if (largest > 0.0)
+      step.change /= largest;
+    step.coupling = total[0];
+    if (sweep.empty())
+      step.change = 0.0;
+    sweep.push_back(step);
+
+    if (sweep.size() > 1 && step.change <= tolerance)
+    {
+      sweep_converged = true;
+      break;
+    }
+  }
+
+  acceptor_nanoparticle_spectrum = total;
+  overlap_acceptor_nanoparticle = total[0];
+}
+//----------------------------------------------------------------------
+namespace
+{
+  ///
+  /// @brief Coulomb interaction of two point sets, serial (called per pair).
+  ///
+  template <Screening S>
+  double pair_coulomb(const Chromophore &a, const Chromophore &b)
+  {
+    double sum = 0.0;
+
+    for (std::size_t i = 0; i < a.xyz.size(); ++i)
+    {
+      double row = 0.0;
+      for (std::size_t j = 0; j < b.xyz.size(); ++j)
+      {
+        const double dx = a.xyz[i][0] - b.xyz[j][0];
+        const double dy = a.xyz[i][1] - b.xyz[j][1];
+        const double dz = a.xyz[i][2] - b.xyz[j][2];
+        const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        row += b.weights[j] * coulomb_kernel<S>(dist);
+      }
+      sum += a.weights[i] * row;
+    }
+    return sum;
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Interaction of two well separated chromophores from their cell
+  /// moments, Taylor expanded to second order in the offsets inside each cell.
+  /// The screening is dropped: erf(r / QMscrnFact) is 1 to double precision.
+  ///
+  double multipole_coulomb(const Chromophore &a, const Chromophore &b)
+  {
+    double sum = 0.0;
+
+    for (const auto &ca : a.cells)
+      for (const auto &cb : b.cells)
+        sum += ca.coulomb(cb);
+
+    return sum;
+  }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Computes the symmetric Coulomb coupling matrix of an aggregate.
+///
+/// Pairs are distributed over threads; each pair is evaluated either exactly or,
+/// when the bounding spheres are far apart, from the cell multipoles.
+///
+void Integrals::aggregate(std::span<const Chromophore> chromophores, double multipole_distance)
+{
+  const int n = chromophores.size();
+
+  nchromophores = n;
+  aggregate_matrix.assign(static_cast<std::size_t>(n) * n, 0.0);
+
+  std::vector<std::array<int, 2>> pairs;
+  pairs.reserve(static_cast<std::size_t>(n) * (n - 1) / 2);
+  for (int a = 0; a < n; ++a)
+    for (int b = a + 1; b < n; ++b)
+      pairs.push_back({a, b});
+
+  const int npairs = pairs.size();
+  int multipole_pairs = 0;
+
+  // Exact pair kernel, chosen once
+  const auto exact_coulomb = screened ? pair_coulomb<Screening::Screened> : pair_coulomb<Screening::Bare>;
+
+#pragma omp parallel for reduction(+ : multipole_pairs) schedule(dynamic)
+  for (int p = 0; p < npairs; ++p)
+  {
+    const auto &ca = chromophores[pairs[p][0]];
+    const auto &cb = chromophores[pairs[p][1]];
+
+    const double dx = ca.center[0] - cb.center[0];
+    const double dy = ca.center[1] - cb.center[1];
+    const double dz = ca.center[2] - cb.center[2];
+    const double gap = std::sqrt(dx * dx + dy * dy + dz * dz) - ca.radius - cb.radius;
+
+    double value;
+    if (multipole_distance > 0.0 && gap > multipole_distance)
+    {
+      value = multipole_coulomb(ca, cb);
+      ++multipole_pairs;
+    }
+    else
+    {
+      value = exact_coulomb(ca, cb);
+    }
+
+    aggregate_matrix[pairs[p][0] * n + pairs[p][1]] = value;
+    aggregate_matrix[pairs[p][1] * n + pairs[p][0]] = value;
+  }
+
+  aggregate_multipole_pairs = multipole_pairs;
 }
 //----------------------------------------------------------------------
 ///
@@ -71,70 +794,231 @@ void Integrals::acceptor_donor(const Target &target, const Density &acceptor, co
 ///
 void Integrals::acceptor_np(const Target &target, const Density &acceptor, const Nanoparticle &np)
 {
-  const int n_acc = acceptor.n_points_reduced;
-  const int n_np = np.natoms;
-
-  const auto &rho_acc = acceptor.rho_reduced;
-  const auto &xyz_acc = acceptor.xyz;
-  const auto &xyz_np = np.xyz;
+  if (acceptor.nchannels > 1)
+    throw std::runtime_error("Several acceptor states are only supported for acceptor-donor couplings.");
 
-  const double inv_QMscrnFact = 1.0 / Parameters::QMscrnFact;
+  if (target.is_monte_carlo_present)
+  {
+    if (!np.charges)
+      throw std::runtime_error("Monte Carlo couplings need a nanoparticle with charges only.");
+    acceptor_np_sampled(acceptor.rho_reduced, acceptor.xyz, np.q, np.xyz, np.nfreq,
+                        target.monte_carlo_tolerance, target.monte_carlo_seed);
+  }
+  else if (np.charges)
+    acceptor_np(acceptor.rho_reduced, acceptor.xyz, np.q, np.xyz, np.nfreq);
+  else if (np.charges_and_dipoles)
+    acceptor_np(acceptor.rho_reduced, acceptor.xyz, np.q, np.xyz, np.nfreq, np.mu);
+  else
+    throw std::runtime_error(
+        "Nanoparticle model not recognized. Check input file: " + target.nanoparticle_input_file);
 
-  if (np.charges)
+  acceptor_nanoparticle_frequencies = np.frequencies;
+}
+//----------------------------------------------------------------------
+namespace
+{
+  ///
+  /// @brief Adds the coupling of every acceptor point with the NP sources of
+  /// every frequency to sums[2 k + part], one instantiation per source and
+  /// screening type. Only the acceptor rows [i_begin, i_end) are summed. Complex sources are two real weight sets (real and
+  /// imaginary parts) sharing the distance factors of a pair.
+  ///
+  template <Source Src, Screening S>
+  void np_pairs(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                std::span<const std::array<double, 2>> mm_q, std::span<const std::array<double, 6>> mm_mu,
+                std::span<const std::array<double, 3>> xyz_np, int nfreq, int i_begin, int i_end, std::vector<double> &sums)
   {
-    const auto &mm_q = np.q; // vector<array<double,2>>
+    const int n_np = xyz_np.size();
 
-    double acceptor_np_int_re_q = 0.0;
-    double acceptor_np_int_im_q = 0.0;
+    double *acceptor_np_int = sums.data();
 
-    // #pragma omp parallel for reduction(+ : acceptor_np_int_re_q, acceptor_np_int_im_q) schedule(static)
-    for (int i = 0; i < n_acc; ++i)
+#pragma omp parallel for reduction(+ : acceptor_np_int[:2 * nfreq]) schedule(static)
+    for (int i = i_begin; i < i_end; ++i)
     {
       for (int j = 0; j < n_np; ++j)
       {
         const double dx = xyz_acc[i][0] - xyz_np[j][0];
         const double dy = xyz_acc[i][1] - xyz_np[j][1];
         const double dz = xyz_acc[i][2] - xyz_np[j][2];
+        const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
 
-        const double dist2 = dx * dx + dy * dy + dz * dz;
-        const double dist = std::sqrt(dist2);
+        // Change sign: ADF prints densities with opposite sign
+        const double weight = -rho_acc[i] * coulomb_kernel<S>(dist);
 
-        if (dist <= 1.0e-14)
-          continue;
+        const std::array<double, 2> *q_site = &mm_q[static_cast<std::size_t>(j) * nfreq];
+        for (int k = 0; k < nfreq; ++k)
+        {
+          acceptor_np_int[2 * k] += weight * q_site[k][0];
+          acceptor_np_int[2 * k + 1] += weight * q_site[k][1];
+        }
 
-        const double invdist = 1.0 / dist;
-        const double sf = dist * inv_QMscrnFact;
-        const double screen_pot = std::erf(sf);
+        if constexpr (Src == Source::Dipole)
+        {
+          // Dipole term -mu . r G(|r|), r from the site to the acceptor point
+          // (V_environment^mu in the README), with the same ADF sign change
+          const double weight_mu = rho_acc[i] * dipole_kernel<S>(dist);
 
-        // Change sign: ADF prints densities with opposite sign
-        acceptor_np_int_re_q += -rho_acc[i] * mm_q[j][0] * invdist * screen_pot;
-        acceptor_np_int_im_q += -rho_acc[i] * mm_q[j][1] * invdist * screen_pot;
+          const std::array<double, 6> *mu_site = &mm_mu[static_cast<std::size_t>(j) * nfreq];
+          for (int k = 0; k < nfreq; ++k)
+          {
+            acceptor_np_int[2 * k] += weight_mu * (mu_site[k][0] * dx + mu_site[k][1] * dy + mu_site[k][2] * dz);
+            acceptor_np_int[2 * k + 1] += weight_mu * (mu_site[k][3] * dx + mu_site[k][4] * dy + mu_site[k][5] * dz);
+          }
+        }
       }
+      Progress::add(n_np);
     }
-
-    overlap_acceptor_nanoparticle[0] = acceptor_np_int_re_q;
-    overlap_acceptor_nanoparticle[1] = acceptor_np_int_im_q;
   }
-  else if (np.charges_and_dipoles)
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Computes the coupling between a reduced density and NP charges (and
+/// dipoles, when mm_mu is not empty).
+///
+/// Multi right-hand side kernel: the distance factors of every acceptor-site
+/// pair are computed once and applied to all nfreq source sets of the site,
+/// so K frequencies cost about as much as one.
+///
+void Integrals::acceptor_np(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                            std::span<const std::array<double, 2>> mm_q, std::span<const std::array<double, 3>> xyz_np,
+                            int nfreq, std::span<const std::array<double, 6>> mm_mu)
+{
+  if (nfreq < 1 || mm_q.size() != xyz_np.size() * nfreq)
+    throw std::invalid_argument("Nanoparticle charges do not match sites x frequencies.");
+  if (!mm_mu.empty() && mm_mu.size() != mm_q.size())
+    throw std::invalid_argument("Nanoparticle dipoles do not match sites x frequencies.");
+
+  // Real and imaginary sums of every frequency, interleaved
+  std::vector<double> sums(2 * nfreq, 0.0);
+
+  // Rows of this rank (all of them without MPI)
+  const auto [i_begin, i_end] = Ranks::share(rho_acc.size());
+  Progress::expect(static_cast<std::uint64_t>(i_end - i_begin) * xyz_np.size());
+  with_screening(screened, [&](auto s)
+                 {
+    if (mm_mu.empty())
+      np_pairs<Source::Monopole, s.value>(rho_acc, xyz_acc, mm_q, mm_mu, xyz_np, nfreq, i_begin, i_end, sums);
+    else
+      np_pairs<Source::Dipole, s.value>(rho_acc, xyz_acc, mm_q, mm_mu, xyz_np, nfreq, i_begin, i_end, sums); });
+  Ranks::sum(sums);
+
+  acceptor_nanoparticle_spectrum.resize(nfreq);
+  for (int k = 0; k < nfreq; ++k)
+    acceptor_nanoparticle_spectrum[k] = {sums[2 * k], sums[2 * k + 1]};
+
+  overlap_acceptor_nanoparticle = acceptor_nanoparticle_spectrum[0];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Computes the coupling between a reduced density and the NP charges
+/// with a compressed operator: the real and imaginary charges of all
+/// frequencies are 2 * nfreq weight vectors of one product.
+///
+void Integrals::acceptor_np(const H_matrix &op, std::span<const double> rho_acc,
+                            std::span<const std::array<double, 2>> mm_q, int nfreq)
+{
+  const int n_acc = op.nrows;
+  const int nrhs = 2 * nfreq;
+
+  if (nfreq < 1 || mm_q.size() != op.ncols * nfreq)
+    throw std::invalid_argument("Nanoparticle charges do not match sites x frequencies.");
+  if (rho_acc.size() != op.nrows)
+    throw std::invalid_argument("Acceptor density does not match the compressed operator.");
+
+  // [site * 2 nfreq + 2 freq + part]
+  std::vector<double> charges(mm_q.size() * 2);
+  for (std::size_t k = 0; k < mm_q.size(); ++k)
   {
-    const auto &mm_q = np.q;   // vector<array<double,2>>
-    const auto &mm_mu = np.mu; // vector<array<double,6>>
+    charges[2 * k] = mm_q[k][0];
+    charges[2 * k + 1] = mm_q[k][1];
+  }
+
+  std::vector<double> potential(static_cast<std::size_t>(n_acc) * nrhs);
+  op.apply(charges, nrhs, potential);
+
+  // Change sign: ADF prints densities with opposite sign
+  std::vector<double> sums(nrhs, 0.0);
+  gemm('N', 'N', nrhs, 1, n_acc, -1.0, potential.data(), nrhs, rho_acc.data(), n_acc, 0.0, sums.data(), nrhs);
 
-    double acceptor_np_int_re_q = 0.0;
-    double acceptor_np_int_im_q = 0.0;
-    double acceptor_np_int_re_mu = 0.0;
-    double acceptor_np_int_im_mu = 0.0;
+  acceptor_nanoparticle_spectrum.resize(nfreq);
+  for (int k = 0; k < nfreq; ++k)
+    acceptor_nanoparticle_spectrum[k] = {sums[2 * k], sums[2 * k + 1]};
 
-    // TODO: implement dipole contribution; for now, fail early:
-    std::cerr << "Nanoparticle dipoles not yet implemented.\n";
-    std::exit(1);
+  overlap_acceptor_nanoparticle = acceptor_nanoparticle_spectrum[0];
+  compression_error = op.sampled_error(charges, nrhs);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Estimates the coupling with the NP charges by importance sampling:
+/// the real and imaginary charges of all frequencies are 2 * nfreq weight sets
+/// sharing the samples.
+///
+void Integrals::acceptor_np_sampled(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                                    std::span<const std::array<double, 2>> mm_q, std::span<const std::array<double, 3>> xyz_np,
+                                    int nfreq, double tolerance, std::uint64_t seed)
+{
+  if (nfreq < 1 || mm_q.size() != xyz_np.size() * nfreq)
+    throw std::invalid_argument("Nanoparticle charges do not match sites x frequencies.");
 
-    // When implemented, compute here and then set overlap_* results.
-    // overlap_acceptor_nanoparticle[...] = ...
+  // [site * 2 nfreq + 2 freq + part]
+  std::vector<double> charges(mm_q.size() * 2);
+  for (std::size_t k = 0; k < mm_q.size(); ++k)
+  {
+    charges[2 * k] = mm_q[k][0];
+    charges[2 * k + 1] = mm_q[k][1];
   }
-  else
+
+  Sampled_coupling sampled(rho_acc, xyz_acc, charges, 2 * nfreq, xyz_np, screened);
+  sampled.estimate(tolerance, seed);
+
+  // Change sign: ADF prints densities with opposite sign
+  acceptor_nanoparticle_spectrum.resize(nfreq);
+  for (int k = 0; k < nfreq; ++k)
+    acceptor_nanoparticle_spectrum[k] = {-sampled.value[2 * k], -sampled.value[2 * k + 1]};
+
+  overlap_acceptor_nanoparticle = acceptor_nanoparticle_spectrum[0];
+
+  monte_carlo_error = sampled.error;
+  monte_carlo_samples = sampled.samples;
+  monte_carlo_near_pairs = sampled.near_pairs;
+  monte_carlo_far_pairs = sampled.far_pairs;
+  monte_carlo_converged = sampled.converged;
+  monte_carlo_exact = sampled.exact;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Computes the coupling between a reduced density and the NP charges
+/// from a potential map: one interpolation per acceptor point.
+///
+void Integrals::acceptor_np(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc, Potential_map &map)
+{
+  const int n_acc = rho_acc.size();
+  const int nfreq = map.nfreq;
+
+  map.prepare(xyz_acc);
+
+  std::vector<double> sums(2 * nfreq, 0.0);
+  double *acceptor_np_int = sums.data();
+
+#pragma omp parallel
   {
-    throw std::runtime_error(
-        "Nanoparticle model not recognized. Check input file: " + target.nanoparticle_input_file);
+    std::vector<double> phi(2 * nfreq);
+
+#pragma omp for reduction(+ : acceptor_np_int[:2 * nfreq]) schedule(static)
+    for (int i = 0; i < n_acc; ++i)
+    {
+      map.potential(xyz_acc[i], phi.data());
+
+      // Change sign: ADF prints densities with opposite sign
+      for (int k = 0; k < 2 * nfreq; ++k)
+        acceptor_np_int[k] -= rho_acc[i] * phi[k];
+    }
   }
-}
\ No newline at end of file
+
+  acceptor_nanoparticle_spectrum.resize(nfreq);
+  for (int k = 0; k < nfreq; ++k)
+    acceptor_nanoparticle_spectrum[k] = {sums[2 * k], sums[2 * k + 1]};
+
+  overlap_acceptor_nanoparticle = acceptor_nanoparticle_spectrum[0];
+}
+//----------------------------------------------------------------------
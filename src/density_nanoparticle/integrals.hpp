@@ -4,6 +4,14 @@
 #include "target.hpp"
 #include "density.hpp"
 #include "nanoparticle.hpp"
+#include "chromophore.hpp"
+#include "potential_map.hpp"
+#include "h_matrix.hpp"
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
 
 ///
 /// @class Integrals
@@ -12,16 +20,144 @@
 class Integrals
 {
 public:
+  // Kernel options: screened (erf(r / QMscrnFact) / r) or bare (1 / r) Coulomb interaction
+  bool screened = true;
+
   // Computed values
   double coulomb_acceptor_donor = 0.0;
   double overlap_acceptor_donor = 0.0;
 
+  // Coupling matrices between acceptor and donor states (multi-channel densities),
+  // column-major: [acceptor_state + nstates_acceptor * donor_state]
+  int nstates_acceptor = 1, nstates_donor = 1;
+  std::vector<double> coulomb_matrix;
+  std::vector<double> overlap_matrix;
+
+  // Aggregate: symmetric Coulomb coupling matrix between chromophores, [a * nchromophores + b]
+  int nchromophores = 0;
+  std::vector<double> aggregate_matrix;
+  int aggregate_multipole_pairs = 0; ///< Pairs evaluated with cell multipoles
+
   std::array<double, 2> overlap_acceptor_nanoparticle = {0.0, 0.0};
 
+  // Cutoff sweep: coupling after each cutoff (first state pair, or first frequency)
+  struct Sweep_step
+  {
+    double cutoff = 0.0;
+    int npoints_acceptor = 0;
+    int npoints_donor = 0;
+    std::array<double, 2> coupling = {0.0, 0.0}; ///< Real, imaginary (acceptor-NP)
+    double change = 0.0;                         ///< Largest change from the previous cutoff, relative to the largest coupling
+  };
+  std::vector<Sweep_step> sweep;
+  bool sweep_converged = false;
+
+  // Sampled relative error of the compressed operator for the weights of the last call
+  double compression_error = 0.0;
+
+  // Checkpointed acceptor-donor run: acceptor points, points restored from the
+  // checkpoint file, and checkpoint files written
+  int checkpoint_rows = 0;
+  int checkpoint_rows_resumed = 0;
+  int checkpoint_saves = 0;
+
+  // Monte Carlo estimate: standard error of every coupling (acceptor-donor:
+  // one; acceptor-NP: real and imaginary of every frequency, interleaved),
+  // samples drawn, point pairs summed exactly (nearby cells) and covered by
+  // the cell multipoles plus the samples, and how the estimate ended
+  std::vector<double> monte_carlo_error;
+  std::size_t monte_carlo_samples = 0;
+  std::size_t monte_carlo_near_pairs = 0;
+  std::size_t monte_carlo_far_pairs = 0;
+  bool monte_carlo_converged = false;
+  bool monte_carlo_exact = false;
+
+  // Dipole prescreen: coupling of the ideal point dipoles, of the extended
+  // dipoles (positive and negative weights as two point charges) and of the
+  // cell multipoles, estimated error of the multipole coupling, distance of
+  // the centers and gap between the point spheres (Bohr), and whether the
+  // full integral was run instead
+  double prescreen_dipole = 0.0;
+  double prescreen_extended_dipole = 0.0;
+  double prescreen_multipole = 0.0;
+  double prescreen_error = 0.0;
+  double prescreen_distance = 0.0;
+  double prescreen_gap = 0.0;
+  bool prescreen_promoted = false;
+
+  // Acceptor-NP coupling for every nanoparticle frequency (real, imaginary)
+  std::vector<double> acceptor_nanoparticle_frequencies;
+  std::vector<std::array<double, 2>> acceptor_nanoparticle_spectrum;
+
   // Functions to compute integrals
   void acceptor_donor(const Target &target, const Density &cube_acceptor, const Density &cube_donor);
 
   void acceptor_np(const Target &target, const Density &cube_acceptor, const Nanoparticle &np);
+
+  // Same integrals over in-memory point sets (reduced densities, NP sites)
+  void acceptor_donor(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                      std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don,
+                      bool calc_overlap, double omega_0);
+
+  // Coupling matrix of every acceptor state with every donor state. rho_acc and
+  // rho_don hold nstates values per point, indexed [point * nstates + state]
+  void acceptor_donor_matrix(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc, int nstates_acc,
+                             std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don, int nstates_don,
+                             bool calc_overlap, double omega_0);
+
+  // Same coupling matrix, with progress saved to target.checkpoint_file so that
+  // an interrupted run can be resumed (also called by acceptor_donor(target, ...))
+  void acceptor_donor_checkpointed(const Target &target, const Density &acceptor, const Density &donor);
+
+  // Coupling matrix of a density with itself; the pair matrix is symmetric, so
+  // only half of it is evaluated
+  void acceptor_donor_symmetric(std::span<const double> rho, std::span<const std::array<double, 3>> xyz, int nstates,
+                                bool calc_overlap, double omega_0);
+
+  // Monte Carlo estimate of the coupling of one acceptor and one donor state,
+  // refined until its standard error is below tolerance times the coupling
+  void acceptor_donor_sampled(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                              std::span<const double> rho_don, std::span<const std::array<double, 3>> xyz_don,
+                              double tolerance, std::uint64_t seed);
+
+  // Coupling estimated from the moments of both densities. Returns true if the
+  // full integral is needed (the point spheres overlap, or the estimated error
+  // exceeds tolerance times the estimate); otherwise the estimate is the coupling
+  bool dipole_prescreen(const Density::Moments &acceptor, const Density::Moments &donor, double tolerance);
+
+  // Same coupling matrix from a compressed operator (rows: acceptor points, columns: donor points)
+  void acceptor_donor(const H_matrix &op, std::span<const double> rho_acc, int nstates_acc,
+                      std::span<const double> rho_don, int nstates_don, bool calc_overlap, double omega_0);
+
+  // Cutoff convergence sweep over densities sorted by magnitude (Density::magnitude).
+  // Each tighter cutoff only adds the interactions of its new points; the sweep
+  // stops once the coupling changes by less than tolerance
+  void cutoff_sweep(const Density &acceptor, const Density &donor, std::span<const double> cutoffs, double tolerance);
+
+  void cutoff_sweep(const Density &acceptor, const Nanoparticle &np, std::span<const double> cutoffs, double tolerance);
+
+  // Coupling of every pair of chromophores. Pairs whose bounding spheres are
+  // more than multipole_distance apart (Bohr) use the cell multipoles; a
+  // non-positive distance evaluates every pair exactly
+  void aggregate(std::span<const Chromophore> chromophores, double multipole_distance);
+
+  // q_np holds nfreq charge sets per site, indexed [site * nfreq + freq]; mu_np,
+  // if not empty, the dipoles of the same sets (real xyz, imaginary xyz)
+  void acceptor_np(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                   std::span<const std::array<double, 2>> q_np, std::span<const std::array<double, 3>> xyz_np,
+                   int nfreq = 1, std::span<const std::array<double, 6>> mu_np = {});
+
+  // Same coupling from a compressed operator (rows: acceptor points, columns: NP sites)
+  void acceptor_np(const H_matrix &op, std::span<const double> rho_acc,
+                   std::span<const std::array<double, 2>> q_np, int nfreq = 1);
+
+  // Monte Carlo estimate of the coupling with the NP charges of every frequency
+  void acceptor_np_sampled(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc,
+                           std::span<const std::array<double, 2>> q_np, std::span<const std::array<double, 3>> xyz_np,
+                           int nfreq, double tolerance, std::uint64_t seed);
+
+  // Same coupling from a precomputed nanoparticle potential map (blocks are built as needed)
+  void acceptor_np(std::span<const double> rho_acc, std::span<const std::array<double, 3>> xyz_acc, Potential_map &map);
 };
 
 #endif // INTEGRALS_HPP
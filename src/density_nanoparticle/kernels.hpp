@@ -0,0 +1,94 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include "parameters.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+///
+/// @brief Pair kernels shared by the coupling loops.
+///
+/// Every kernel is a template on its interaction type, so each combination is
+/// a separate loop without run-time tests inside. The with_* helpers turn run
+/// options into compile-time constants once per call:
+///
+///     with_screening(screened, [&](auto s) { loop<s.value>(...); });
+///
+/// A new interaction type is a new kernel (or enumerator) here.
+///
+
+/// @brief Screened (erf(r / QMscrnFact) / r) or bare (1 / r) Coulomb interaction.
+enum class Screening
+{
+  Screened,
+  Bare
+};
+
+/// @brief Charges, or charges plus point dipoles, at the nanoparticle sites.
+enum class Source
+{
+  Monopole,
+  Dipole
+};
+
+//----------------------------------------------------------------------
+///
+/// @brief Potential of a unit charge at distance dist. Coincident points
+/// (dist <= 1e-14) do not interact; the test is a select, not a branch.
+///
+template <Screening S>
+inline double coulomb_kernel(double dist)
+{
+  const double inv_dist = (dist > 1.0e-14) ? 1.0 / dist : 0.0;
+
+  if constexpr (S == Screening::Screened)
+    return std::erf(dist * (1.0 / Parameters::QMscrnFact)) * inv_dist;
+  else
+    return inv_dist;
+}
+//----------------------------------------------------------------------
+///
+/// @brief G(dist) = -K'(dist) / dist, so that the potential of a dipole mu at
+/// offset r is mu . r G(|r|). Screened: [erf(s) - 2 s exp(-s^2) / sqrt(pi)] / dist^3
+/// with s = dist / QMscrnFact; bare: 1 / dist^3.
+///
+template <Screening S>
+inline double dipole_kernel(double dist)
+{
+  const double inv_dist = (dist > 1.0e-14) ? 1.0 / dist : 0.0;
+  const double inv_dist3 = inv_dist * inv_dist * inv_dist;
+
+  if constexpr (S == Screening::Screened)
+  {
+    const double s = dist * (1.0 / Parameters::QMscrnFact);
+    return (std::erf(s) - (2.0 / std::sqrt(Parameters::pi)) * s * std::exp(-s * s)) * inv_dist3;
+  }
+  else
+    return inv_dist3;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Calls f with std::integral_constant<Screening, ...> for the run option.
+///
+template <typename F>
+inline decltype(auto) with_screening(bool screened, F &&f)
+{
+  if (screened)
+    return f(std::integral_constant<Screening, Screening::Screened>{});
+  return f(std::integral_constant<Screening, Screening::Bare>{});
+}
+//----------------------------------------------------------------------
+///
+/// @brief Calls f with std::bool_constant<flag> (e.g. with/without overlap).
+///
+template <typename F>
+inline decltype(auto) with_flag(bool flag, F &&f)
+{
+  if (flag)
+    return f(std::true_type{});
+  return f(std::false_type{});
+}
+//----------------------------------------------------------------------
+
+#endif // KERNELS_HPP
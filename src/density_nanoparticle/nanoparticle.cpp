@@ -2,94 +2,230 @@
 #include "target.hpp"
 #include "parameters.hpp"
 #include "string_manipulation.hpp"
+#include "mapped_file.hpp"
+#include "perf_counters.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
 #include <fstream>
 #include <sstream>
-#include <iomanip>
+#include <filesystem>
+#include <cmath>
 
 ///
-/// @brief Loads a cube file and initializes the density grid and atomic data.
+/// @brief Loads the nanoparticle charges (and dipoles).
+///
+/// With a single log file one set of charges is read. With a frequency list
+/// (input keyword "nanoparticle frequencies") one set is read per frequency;
+/// all files must share the same geometry, and the sets are stored site by
+/// site so a kernel visits all frequencies of a site together.
 ///
-// void Density::read_density(const std::string& filepath, bool rotate, const std::string& what_dens) {
 void Nanoparticle::read_nanoparticle(const Target &target)
 {
-  // Check file existance.
-  std::string filepath = target.nanoparticle_file;
+  Perf_counters::Phase phase("NP read");
+
+  // Start from an empty nanoparticle, so a reused object is read again from scratch
+  charges = charges_and_dipoles = false;
+  nanoparticle_model.clear();
+  q.clear();
+  mu.clear();
+  xyz.clear();
+  frequencies.clear();
+  geom_center = {};
 
-  std::ifstream infile(filepath);
-  if (!infile)
+  if (!target.nanoparticle_frequencies)
   {
-    throw std::runtime_error("File: " + filepath + "not found.");
+    read_fret_block(target.nanoparticle_file, q, mu, xyz);
+    nfreq = 1;
   }
+  else
+  {
+    const auto list = read_frequency_list(target.nanoparticle_file);
+
+    nfreq = list.size();
 
-  // Check if FRET quantities are present
-  bool is_fret_quantities_present;
-  is_fret_quantities_present = go_to_string(infile, Parameters::fret_start);
+    std::vector<std::array<double, 2>> q_file;
+    std::vector<std::array<double, 6>> mu_file;
+    std::vector<std::array<double, 3>> xyz_file;
 
-  // Check if FRET end marker is present
-  bool is_fret_end_marker_present;
-  is_fret_end_marker_present = go_to_string(infile, Parameters::fret_end);
+    for (int f = 0; f < nfreq; ++f)
+    {
+      const auto &[omega, filepath] = list[f];
+      frequencies.push_back(omega);
 
-  // Rewind and come back to fret_start
-  infile.clear();
-  infile.seekg(0, std::ios::beg);
-  is_fret_quantities_present = go_to_string(infile, Parameters::fret_start);
+      q_file.clear();
+      mu_file.clear();
+      xyz_file.clear();
+      read_fret_block(filepath, q_file, mu_file, xyz_file);
 
-  // Check charges / charges + dipoles
+      if (f == 0)
+      {
+        xyz = xyz_file;
+        q.resize(xyz.size() * nfreq);
+        if (charges_and_dipoles)
+          mu.resize(xyz.size() * nfreq);
+      }
+      else if (xyz_file.size() != xyz.size())
+      {
+        throw std::runtime_error("Nanoparticle file " + filepath + " has a different number of sites than the first file.");
+      }
+
+      for (std::size_t j = 0; j < xyz.size(); ++j)
+      {
+        for (int c = 0; c < 3; ++c)
+        {
+          if (std::abs(xyz_file[j][c] - xyz[j][c]) > Parameters::np_geometry_tolerance)
+            throw std::runtime_error("Nanoparticle file " + filepath + " has a different geometry than the first file.");
+        }
+        q[j * nfreq + f] = q_file[j];
+        if (charges_and_dipoles)
+          mu[j * nfreq + f] = mu_file[j];
+      }
+    }
+  }
+  natoms = xyz.size();
+
+  // Compute geometrical center
+  for (const auto &coord : xyz)
+  {
+    geom_center[0] += coord[0];
+    geom_center[1] += coord[1];
+    geom_center[2] += coord[2];
+  }
+  geom_center[0] /= natoms;
+  geom_center[1] /= natoms;
+  geom_center[2] /= natoms;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads a frequency list: one "frequency (a.u.)  log file" pair per
+/// line, with log paths relative to the list file. '#' or '!' start comments.
+///
+std::vector<std::pair<double, std::string>> Nanoparticle::read_frequency_list(const std::string &filepath)
+{
+  std::ifstream file(filepath);
+  if (!file)
+  {
+    throw std::runtime_error("File: " + filepath + " not found.");
+  }
+
+  const std::filesystem::path list_dir = std::filesystem::path(filepath).parent_path();
+
+  std::vector<std::pair<double, std::string>> list;
   std::string line;
-  std::getline(infile, line);
-  if (line == Parameters::charges_header)
+  while (std::getline(file, line))
+  {
+    line.erase(0, line.find_first_not_of(" \t\r\n"));
+    line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    if (line.empty() || line[0] == '#' || line[0] == '!')
+      continue;
+
+    std::istringstream iss(line);
+    double omega = 0.0;
+    std::string logfile;
+    if (!(iss >> omega >> logfile))
+    {
+      throw std::runtime_error("Expected 'frequency  file' in " + filepath + ", got: " + line);
+    }
+    list.emplace_back(omega, (list_dir / logfile).string());
+  }
+
+  if (list.empty())
+  {
+    throw std::runtime_error("No frequencies found in " + filepath);
+  }
+  return list;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads the charges (and dipoles) in the FRET block of one log file.
+///
+/// The log is memory-mapped and scanned only once: both markers are located
+/// with a substring search and only the lines between them are parsed.
+///
+void Nanoparticle::read_fret_block(const std::string &filepath,
+                                   std::vector<std::array<double, 2>> &q_file,
+                                   std::vector<std::array<double, 6>> &mu_file,
+                                   std::vector<std::array<double, 3>> &xyz_file)
+{
+  Mapped_file file(filepath);
+  const std::string_view text = file.view();
+
+  // Locate FRET quantities block
+  const std::size_t start = find_marker_line(text, Parameters::fret_start);
+  if (start == std::string_view::npos)
+  {
+    throw std::runtime_error("FRET quantities not found in nanoparticle file: " + filepath);
+  }
+
+  std::size_t pos = start;
+  next_line(text, pos); // skip fret_start marker
+
+  const std::size_t end = find_marker_line(text, Parameters::fret_end, pos);
+  if (end == std::string_view::npos)
+  {
+    throw std::runtime_error("FRET end marker not found in nanoparticle file: " + filepath);
+  }
+
+  const std::string_view block = text.substr(pos, end - pos);
+  pos = 0;
+
+  // Check charges / charges + dipoles
+  const std::string_view header = next_line(block, pos);
+  const bool first_file = !charges && !charges_and_dipoles;
+  if (header == Parameters::charges_header && (first_file || charges))
   {
     charges = true;
     nanoparticle_model = "charges";
   }
-  else if (line == Parameters::charges_and_dipoles_header)
+  else if (header == Parameters::charges_and_dipoles_header && (first_file || charges_and_dipoles))
   {
     charges_and_dipoles = true;
     nanoparticle_model = "charges + dipoles";
   }
+  else if (!first_file)
+  {
+    throw std::runtime_error("Nanoparticle model of " + filepath + " differs from the first nanoparticle file.");
+  }
   else
   {
-    throw std::runtime_error("Expected header line with charges or charges and dipoles, got: " + line);
+    throw std::runtime_error("Expected header line with charges or charges and dipoles, got: " + std::string(header));
   }
 
+  // Pre-size containers from the number of lines in the block
+  const std::size_t nlines = std::count(block.begin() + pos, block.end(), '\n');
+  q_file.reserve(nlines);
+  xyz_file.reserve(nlines);
+  if (charges_and_dipoles)
+    mu_file.reserve(nlines);
+
   // Read charges / charges and dipoles.
-  while (std::getline(infile, line))
-  {
-    if (line == Parameters::fret_end)
-      break;
+  const int nvalues = charges ? 5 : 11;
+  std::array<double, 11> values{};
 
-    std::istringstream iss(line);
-    std::array<double, 3> coords{};
+  while (pos < block.size())
+  {
+    const std::string_view line = next_line(block, pos);
+    if (line.find_first_not_of(" \t") == std::string_view::npos)
+      continue;
 
-    if (charges)
+    const char *first = line.data();
+    const char *last = line.data() + line.size();
+    for (int k = 0; k < nvalues; ++k)
     {
-      std::array<double, 2> charge{};
-      iss >> charge[0] >> charge[1] >> coords[0] >> coords[1] >> coords[2];
-      q.push_back(charge);
+      if (!parse_next_double(first, last, values[k]))
+      {
+        throw std::runtime_error("Could not parse nanoparticle line: " + std::string(line));
+      }
     }
-    else if (charges_and_dipoles)
+
+    q_file.push_back({values[0], values[1]});
+    if (charges_and_dipoles)
     {
-      std::array<double, 2> charge{};
-      std::array<double, 6> dipole{};
-      iss >> charge[0] >> charge[1] >> dipole[0] >> dipole[1] >> dipole[2] >> dipole[3] >> dipole[4] >> dipole[5] >> coords[0] >> coords[1] >> coords[2];
-      q.push_back(charge);
-      mu.push_back(dipole);
+      mu_file.push_back({values[2], values[3], values[4], values[5], values[6], values[7]});
     }
-
-    xyz.push_back(coords);
-  }
-  natoms = xyz.size();
-
-  // Compute geometrical center
-  for (const auto &coord : xyz)
-  {
-    geom_center[0] += coord[0];
-    geom_center[1] += coord[1];
-    geom_center[2] += coord[2];
+    xyz_file.push_back({values[nvalues - 3], values[nvalues - 2], values[nvalues - 1]});
   }
-  geom_center[0] /= natoms;
-  geom_center[1] /= natoms;
-  geom_center[2] /= natoms;
 }
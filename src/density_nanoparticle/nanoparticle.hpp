@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <utility>
 
 ///
 /// @class Nanoparticle
@@ -17,19 +18,33 @@ public:
 
   int natoms = 0;
 
+  int nfreq = 1; // Number of frequencies (charge/dipole sets per site)
+
   bool charges = false, charges_and_dipoles = false;
 
   std::string nanoparticle_model;
 
-  std::array<double, 3> geom_center; 
+  std::array<double, 3> geom_center{};
+
+  std::vector<double> frequencies;         // Frequencies (a.u.) of each set, empty for a single log file
 
-  std::vector<std::array<double, 2>> q;    // Charges with real + imaginary part
-  std::vector<std::array<double, 6>> mu;   // Dipoles with 3 components each for real + imaginary part
+  std::vector<std::array<double, 2>> q;    // Charges with real + imaginary part, indexed [site * nfreq + freq]
+  std::vector<std::array<double, 6>> mu;   // Dipoles with 3 components each for real + imaginary part, [site * nfreq + freq]
 
   std::vector<std::array<double, 3>> xyz;  // XYZ coordinates
 
   // void read_density(const std::string& filepath, bool rotate = false, const std::string& what_dens = "");
   void read_nanoparticle(const Target &target);
+
+  /// @brief Reads "frequency  log file" pairs from a frequency list file.
+  static std::vector<std::pair<double, std::string>> read_frequency_list(const std::string &filepath);
+
+private:
+  /// @brief Reads the FRET block of one log file into the given containers.
+  void read_fret_block(const std::string &filepath,
+                       std::vector<std::array<double, 2>> &q_file,
+                       std::vector<std::array<double, 6>> &mu_file,
+                       std::vector<std::array<double, 3>> &xyz_file);
 };
 
 #endif // NANOPARTICCLE_HPP
@@ -0,0 +1,349 @@
+#include "potential_map.hpp"
+#include "parameters.hpp"
+#include "hash.hpp"
+#include "kernels.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <omp.h>
+
+namespace
+{
+  constexpr char magic[4] = {'F', 'L', 'P', 'M'};
+  constexpr std::uint32_t version = 1;
+
+  /// @brief Cubic Lagrange weights of nodes -1, 0, 1, 2 at 0 <= t <= 1.
+  std::array<double, 4> cubic_weights(double t)
+  {
+    return {-t * (t - 1.0) * (t - 2.0) / 6.0,
+            (t + 1.0) * (t - 1.0) * (t - 2.0) / 2.0,
+            -(t + 1.0) * t * (t - 2.0) / 2.0,
+            (t + 1.0) * t * (t - 1.0) / 6.0};
+  }
+
+  template <typename T>
+  void write_value(std::ofstream &file, const T &value)
+  {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  bool read_value(std::ifstream &file, T &value)
+  {
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+  }
+} // namespace
+
+///
+/// @brief Constructor for Potential_map.
+///
+Potential_map::Potential_map(const Nanoparticle &np, double tolerance)
+    : np(np), tolerance(tolerance),
+      block_size(Parameters::potential_map_block_cells * Parameters::potential_map_spacing)
+{
+  if (!np.charges)
+    throw std::runtime_error("Potential maps need a nanoparticle with charges only.");
+  if (tolerance <= 0.0)
+    throw std::runtime_error("Potential map tolerance must be positive.");
+
+  nfreq = np.nfreq;
+
+  fingerprint = fnv1a(&nfreq, sizeof(nfreq));
+  fingerprint = fnv1a(np.q.data(), np.q.size() * sizeof(np.q[0]), fingerprint);
+  fingerprint = fnv1a(np.xyz.data(), np.xyz.size() * sizeof(np.xyz[0]), fingerprint);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Direct sum of the screened potential of all sites at a point.
+///
+void Potential_map::direct(const std::array<double, 3> &r, double *out) const
+{
+  std::fill(out, out + 2 * nfreq, 0.0);
+
+  for (std::size_t j = 0; j < np.xyz.size(); ++j)
+  {
+    const double dx = r[0] - np.xyz[j][0];
+    const double dy = r[1] - np.xyz[j][1];
+    const double dz = r[2] - np.xyz[j][2];
+    const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    const double factor = coulomb_kernel<Screening::Screened>(dist);
+    const std::array<double, 2> *q_site = &np.q[j * nfreq];
+    for (int k = 0; k < nfreq; ++k)
+    {
+      out[2 * k] += factor * q_site[k][0];
+      out[2 * k + 1] += factor * q_site[k][1];
+    }
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Block containing a point.
+///
+Potential_map::Key Potential_map::block_of(const std::array<double, 3> &r) const
+{
+  return {static_cast<int>(std::floor(r[0] / block_size)),
+          static_cast<int>(std::floor(r[1] / block_size)),
+          static_cast<int>(std::floor(r[2] / block_size))};
+}
+//----------------------------------------------------------------------
+///
+/// @brief Tabulates one block, halving the spacing until the interpolation
+/// error at the test points is below the tolerance.
+///
+Potential_map::Block Potential_map::build_block(const Key &key) const
+{
+  Block block;
+  const std::array<double, 3> origin = {key[0] * block_size, key[1] * block_size, key[2] * block_size};
+
+  // Sites inside (or within one base spacing of) the block: the screened
+  // kernel varies on the QMscrnFact scale there, so use the direct sum
+  const double margin = Parameters::potential_map_spacing;
+  for (const auto &site : np.xyz)
+  {
+    bool inside = true;
+    for (int k = 0; k < 3; ++k)
+      inside = inside && site[k] > origin[k] - margin && site[k] < origin[k] + block_size + margin;
+    if (inside)
+    {
+      block.direct = true;
+      return block;
+    }
+  }
+
+  // Test points away from the lattice nodes
+  const std::array<double, 3> fractions = {0.19, 0.56, 0.81};
+  std::vector<std::array<double, 3>> tests;
+  std::vector<double> exact;
+  for (double fx : fractions)
+    for (double fy : fractions)
+      for (double fz : fractions)
+        tests.push_back({origin[0] + fx * block_size, origin[1] + fy * block_size, origin[2] + fz * block_size});
+
+  exact.resize(tests.size() * 2 * nfreq);
+  double scale = 0.0;
+  for (std::size_t t = 0; t < tests.size(); ++t)
+  {
+    direct(tests[t], &exact[t * 2 * nfreq]);
+  }
+  for (double value : exact)
+    scale = std::max(scale, std::abs(value));
+
+  std::vector<double> approx(2 * nfreq);
+  for (int level = 0; level <= Parameters::potential_map_max_level; ++level)
+  {
+    const int ncells = Parameters::potential_map_block_cells << level;
+    const int nnodes = ncells + 3; // one ghost node before, two after
+    const double h = block_size / ncells;
+
+    block.level = level;
+    block.values.assign(static_cast<std::size_t>(nnodes) * nnodes * nnodes * 2 * nfreq, 0.0);
+    for (int a = 0; a < nnodes; ++a)
+      for (int b = 0; b < nnodes; ++b)
+        for (int c = 0; c < nnodes; ++c)
+        {
+          const std::array<double, 3> node = {origin[0] + (a - 1) * h, origin[1] + (b - 1) * h, origin[2] + (c - 1) * h};
+          direct(node, &block.values[((static_cast<std::size_t>(a) * nnodes + b) * nnodes + c) * 2 * nfreq]);
+        }
+
+    double error = 0.0;
+    for (std::size_t t = 0; t < tests.size(); ++t)
+    {
+      interpolate(key, block, tests[t], approx.data());
+      for (int k = 0; k < 2 * nfreq; ++k)
+        error = std::max(error, std::abs(approx[k] - exact[t * 2 * nfreq + k]));
+    }
+    block.error = scale > 0.0 ? error / scale : error;
+
+    if (block.error <= tolerance)
+      return block;
+  }
+
+  // Not converged at the finest level
+  block.direct = true;
+  block.values.clear();
+  block.values.shrink_to_fit();
+  return block;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Tricubic Lagrange interpolation inside a tabulated block.
+///
+void Potential_map::interpolate(const Key &key, const Block &block, const std::array<double, 3> &r, double *out) const
+{
+  const int ncells = Parameters::potential_map_block_cells << block.level;
+  const int nnodes = ncells + 3;
+  const double h = block_size / ncells;
+  const int nvalues = 2 * nfreq;
+
+  std::array<int, 3> cell;
+  std::array<std::array<double, 4>, 3> w;
+  for (int k = 0; k < 3; ++k)
+  {
+    const double u = (r[k] - key[k] * block_size) / h;
+    cell[k] = std::clamp(static_cast<int>(std::floor(u)), 0, ncells - 1);
+    w[k] = cubic_weights(u - cell[k]);
+  }
+
+  std::fill(out, out + nvalues, 0.0);
+  for (int a = 0; a < 4; ++a)
+    for (int b = 0; b < 4; ++b)
+    {
+      const double wab = w[0][a] * w[1][b];
+      // Node index of the stencil point is cell + offset - 1, shifted by the ghost node
+      const std::size_t row = (static_cast<std::size_t>(cell[0] + a) * nnodes + (cell[1] + b)) * nnodes + cell[2];
+      for (int c = 0; c < 4; ++c)
+      {
+        const double weight = wab * w[2][c];
+        const double *node = &block.values[(row + c) * nvalues];
+        for (int k = 0; k < nvalues; ++k)
+          out[k] += weight * node[k];
+      }
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Builds, in parallel, the blocks containing the points that are not built yet.
+///
+void Potential_map::prepare(std::span<const std::array<double, 3>> points)
+{
+  std::set<Key> wanted;
+  for (const auto &r : points)
+  {
+    const Key key = block_of(r);
+    if (!blocks.contains(key))
+      wanted.insert(key);
+  }
+  const std::vector<Key> missing(wanted.begin(), wanted.end());
+
+  std::vector<Block> built(missing.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (int b = 0; b < static_cast<int>(missing.size()); ++b)
+    built[b] = build_block(missing[b]);
+
+  for (std::size_t b = 0; b < missing.size(); ++b)
+  {
+    if (built[b].direct)
+      ++blocks_direct;
+    else
+      max_error = std::max(max_error, built[b].error);
+    blocks.emplace(missing[b], std::move(built[b]));
+  }
+  blocks_built += missing.size();
+}
+//----------------------------------------------------------------------
+///
+/// @brief Potential at a point of a prepared block.
+///
+void Potential_map::potential(const std::array<double, 3> &r, double *out) const
+{
+  const Key key = block_of(r);
+  const auto it = blocks.find(key);
+  if (it == blocks.end())
+    throw std::logic_error("Potential map block not prepared.");
+
+  if (it->second.direct)
+    direct(r, out);
+  else
+    interpolate(key, it->second, r, out);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Loads the blocks of a cache file built for the same nanoparticle and settings.
+///
+bool Potential_map::load(const std::string &filepath)
+{
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file)
+    return false;
+
+  char file_magic[4];
+  std::uint32_t file_version = 0;
+  std::uint64_t file_fingerprint = 0;
+  double spacing = 0.0, file_tolerance = 0.0;
+  std::int32_t cells = 0, max_level = 0, file_nfreq = 0;
+  std::uint64_t nblocks = 0;
+
+  if (!file.read(file_magic, 4) || std::memcmp(file_magic, magic, 4) != 0 ||
+      !read_value(file, file_version) || file_version != version ||
+      !read_value(file, file_fingerprint) || !read_value(file, file_nfreq) ||
+      !read_value(file, spacing) || !read_value(file, cells) ||
+      !read_value(file, max_level) || !read_value(file, file_tolerance) ||
+      !read_value(file, nblocks))
+    return false;
+
+  if (file_fingerprint != fingerprint || file_nfreq != nfreq ||
+      spacing != Parameters::potential_map_spacing || cells != Parameters::potential_map_block_cells ||
+      max_level != Parameters::potential_map_max_level || file_tolerance != tolerance)
+    return false;
+
+  std::map<Key, Block> loaded;
+  for (std::uint64_t b = 0; b < nblocks; ++b)
+  {
+    Key key;
+    Block block;
+    std::uint8_t is_direct = 0;
+    std::uint64_t nvalues = 0;
+    if (!read_value(file, key) || !read_value(file, block.level) || !read_value(file, is_direct) ||
+        !read_value(file, block.error) || !read_value(file, nvalues))
+      throw std::runtime_error("Truncated potential map file: " + filepath);
+
+    block.direct = is_direct != 0;
+    block.values.resize(nvalues);
+    if (!file.read(reinterpret_cast<char *>(block.values.data()), nvalues * sizeof(double)))
+      throw std::runtime_error("Truncated potential map file: " + filepath);
+
+    if (block.direct)
+      ++blocks_direct;
+    else
+      max_error = std::max(max_error, block.error);
+    loaded.emplace(key, std::move(block));
+  }
+
+  blocks_loaded = loaded.size();
+  blocks = std::move(loaded);
+  return true;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Writes all blocks to a cache file, through a temporary file renamed at the end.
+///
+void Potential_map::save(const std::string &filepath) const
+{
+  const std::string temporary = filepath + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw std::runtime_error("Could not write potential map file: " + temporary);
+
+    file.write(magic, 4);
+    write_value(file, version);
+    write_value(file, fingerprint);
+    write_value(file, static_cast<std::int32_t>(nfreq));
+    write_value(file, Parameters::potential_map_spacing);
+    write_value(file, static_cast<std::int32_t>(Parameters::potential_map_block_cells));
+    write_value(file, static_cast<std::int32_t>(Parameters::potential_map_max_level));
+    write_value(file, tolerance);
+    write_value(file, static_cast<std::uint64_t>(blocks.size()));
+
+    for (const auto &[key, block] : blocks)
+    {
+      write_value(file, key);
+      write_value(file, block.level);
+      write_value(file, static_cast<std::uint8_t>(block.direct));
+      write_value(file, block.error);
+      write_value(file, static_cast<std::uint64_t>(block.values.size()));
+      file.write(reinterpret_cast<const char *>(block.values.data()), block.values.size() * sizeof(double));
+    }
+
+    if (!file)
+      throw std::runtime_error("Could not write potential map file: " + temporary);
+  }
+  std::filesystem::rename(temporary, filepath);
+}
@@ -0,0 +1,89 @@
+#ifndef POTENTIAL_MAP_HPP
+#define POTENTIAL_MAP_HPP
+
+#include "nanoparticle.hpp"
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+///
+/// @class Potential_map
+/// @brief Screened electrostatic potential of the nanoparticle charges,
+/// tabulated on a lattice and interpolated (tricubic) at acceptor points.
+///
+/// Space is divided into cubic blocks of potential_map_block_cells cells of
+/// side potential_map_spacing. Blocks are only built where points are
+/// requested, and each block is refined (spacing halved, up to
+/// potential_map_max_level times) until the interpolated potential matches
+/// the direct sum within the tolerance at a set of test points. Blocks that
+/// never do (e.g. containing nanoparticle sites) are evaluated by the direct
+/// sum. Built blocks can be saved to and loaded from a cache file, which is
+/// tied to the nanoparticle charges and positions by a fingerprint.
+///
+class Potential_map
+{
+public:
+  /// Constructor. The nanoparticle must have charges only.
+  Potential_map(const Nanoparticle &np, double tolerance);
+
+  /// @brief Loads the blocks of a cache file. Returns false if the file is
+  /// missing or belongs to another nanoparticle or settings.
+  bool load(const std::string &filepath);
+
+  /// @brief Writes all blocks to a cache file (replaced atomically).
+  void save(const std::string &filepath) const;
+
+  /// @brief Builds the blocks containing the given points that are not built yet.
+  void prepare(std::span<const std::array<double, 3>> points);
+
+  /// @brief Potential at a point of a prepared block. out receives 2 * nfreq
+  /// values (real, imaginary per frequency).
+  void potential(const std::array<double, 3> &r, double *out) const;
+
+  /// @brief Direct sum of the potential at a point (2 * nfreq values).
+  void direct(const std::array<double, 3> &r, double *out) const;
+
+  int nfreq = 1;
+
+  // Statistics
+  std::size_t blocks_loaded = 0;   ///< Blocks read from the cache file
+  std::size_t blocks_built = 0;    ///< Blocks computed in this run
+  std::size_t blocks_direct = 0;   ///< Blocks evaluated by the direct sum
+  double max_error = 0.0;          ///< Largest relative test-point error of the tabulated blocks
+
+  /// @brief Number of blocks held.
+  std::size_t size() const { return blocks.size(); }
+
+private:
+  using Key = std::array<int, 3>;
+
+  struct Block
+  {
+    int level = 0;              ///< Spacing is potential_map_spacing / 2^level
+    bool direct = false;        ///< Points of the block use the direct sum
+    double error = 0.0;         ///< Relative test-point error
+    std::vector<double> values; ///< Lattice values, [node * 2 * nfreq + 2 * freq + part]
+  };
+
+  /// @brief Tabulates one block, refining until the tolerance is met.
+  Block build_block(const Key &key) const;
+
+  /// @brief Interpolated potential inside a tabulated block.
+  void interpolate(const Key &key, const Block &block, const std::array<double, 3> &r, double *out) const;
+
+  /// @brief Block containing a point.
+  Key block_of(const std::array<double, 3> &r) const;
+
+  const Nanoparticle &np;
+  double tolerance;
+  double block_size;        ///< Side of a block (Bohr)
+  std::uint64_t fingerprint; ///< Hash of the nanoparticle charges and positions
+  std::map<Key, Block> blocks;
+};
+
+#endif // POTENTIAL_MAP_HPP
@@ -0,0 +1,411 @@
+#include "sampled_coupling.hpp"
+#include "parameters.hpp"
+#include "kernels.hpp"
+#include "progress.hpp"
+
+#include <omp.h>
+
+#include <map>
+#include <cmath>
+#include <tuple>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+  ///
+  /// @brief SplitMix64 mixing step: well separated seeds for consecutive batches.
+  ///
+  std::uint64_t mix(std::uint64_t x)
+  {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  /// @brief Uniform double in [0, 1) from the top 53 bits (same on every platform).
+  double uniform(std::mt19937_64 &generator)
+  {
+    return static_cast<double>(generator() >> 11) * 0x1.0p-53;
+  }
+
+  /// @brief Index of the entry of a cumulative range [begin, end) that holds u.
+  std::size_t pick(const std::vector<double> &cdf, std::size_t begin, std::size_t end, double u)
+  {
+    const auto it = std::upper_bound(cdf.begin() + begin, cdf.begin() + end, u);
+    return std::min(static_cast<std::size_t>(it - cdf.begin()), end - 1);
+  }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Bins the points on a cubic grid (the cells are ordered, so the
+/// layout does not depend on the run) and computes the cell moments.
+///
+void Sampled_coupling::bin(std::span<const std::array<double, 3>> xyz, std::span<const double> w, int nw, double cell_size,
+                           std::vector<std::array<double, 3>> &sorted_xyz, std::vector<double> &sorted_w,
+                           std::vector<Cell_range> &ranges, std::vector<std::vector<Chromophore::Cell>> &moments)
+{
+  std::map<std::tuple<long, long, long>, std::vector<std::size_t>> bins;
+  for (std::size_t p = 0; p < xyz.size(); ++p)
+  {
+    bins[{static_cast<long>(std::floor(xyz[p][0] / cell_size)),
+          static_cast<long>(std::floor(xyz[p][1] / cell_size)),
+          static_cast<long>(std::floor(xyz[p][2] / cell_size))}]
+        .push_back(p);
+  }
+
+  sorted_xyz.clear();
+  sorted_w.clear();
+  ranges.clear();
+  moments.assign(nw, {});
+
+  for (const auto &[key, members] : bins)
+  {
+    Cell_range range;
+    range.begin = sorted_xyz.size();
+    for (auto p : members)
+    {
+      sorted_xyz.push_back(xyz[p]);
+      sorted_w.insert(sorted_w.end(), w.begin() + p * nw, w.begin() + (p + 1) * nw);
+      for (int k = 0; k < 3; ++k)
+        range.center[k] += xyz[p][k];
+    }
+    range.end = sorted_xyz.size();
+    for (int k = 0; k < 3; ++k)
+      range.center[k] /= static_cast<double>(members.size());
+
+    for (int c = 0; c < nw; ++c)
+    {
+      Chromophore::Cell cell;
+      cell.center = range.center;
+      moments[c].push_back(cell);
+    }
+
+    for (std::size_t p = range.begin; p < range.end; ++p)
+    {
+      const double dx = sorted_xyz[p][0] - range.center[0];
+      const double dy = sorted_xyz[p][1] - range.center[1];
+      const double dz = sorted_xyz[p][2] - range.center[2];
+      range.radius = std::max(range.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+
+      for (int c = 0; c < nw; ++c)
+      {
+        auto &cell = moments[c].back();
+        const double wc = sorted_w[p * nw + c];
+        cell.charge += wc;
+        cell.dipole[0] += wc * dx;
+        cell.dipole[1] += wc * dy;
+        cell.dipole[2] += wc * dz;
+        cell.quadrupole[0] += wc * dx * dx;
+        cell.quadrupole[1] += wc * dy * dy;
+        cell.quadrupole[2] += wc * dz * dz;
+        cell.quadrupole[3] += wc * dx * dy;
+        cell.quadrupole[4] += wc * dx * dz;
+        cell.quadrupole[5] += wc * dy * dz;
+      }
+    }
+    ranges.push_back(range);
+  }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Bins both point sets (coarser cells if the cell pair table would be
+/// too large), sums the near cell pairs exactly and the control over the far
+/// ones, and builds the sampling tables.
+///
+Sampled_coupling::Sampled_coupling(std::span<const double> rho_rows, std::span<const std::array<double, 3>> xyz_rows,
+                                   std::span<const double> w_cols, int ncols, std::span<const std::array<double, 3>> xyz_cols,
+                                   bool screened)
+    : ncols(ncols), screened(screened)
+{
+  if (ncols < 1 || rho_rows.size() != xyz_rows.size() || w_cols.size() != xyz_cols.size() * ncols)
+    throw std::invalid_argument("Sampled coupling weights do not match the points.");
+
+  std::vector<std::vector<Chromophore::Cell>> row_moments, col_moments;
+  double cell_size = Parameters::monte_carlo_cell_size;
+  for (;;)
+  {
+    bin(xyz_rows, rho_rows, 1, cell_size, row_xyz, row_w, row_ranges, row_moments);
+    bin(xyz_cols, w_cols, ncols, cell_size, col_xyz, col_w, col_ranges, col_moments);
+    if (row_ranges.size() * col_ranges.size() <= Parameters::monte_carlo_max_cell_pairs)
+      break;
+    cell_size *= 1.5;
+  }
+  row_cells = row_ranges.size();
+  col_cells = col_ranges.size();
+  //
+  // Sampling weights inside the cells: |a_i| for rows, sum_c |b_jc| / sum_j |b_jc| for columns
+  //
+  col_scale.assign(ncols, 0.0);
+  for (std::size_t j = 0; j < col_xyz.size(); ++j)
+    for (int c = 0; c < ncols; ++c)
+      col_scale[c] += std::abs(col_w[j * ncols + c]);
+  for (auto &scale : col_scale)
+    scale = scale > 0.0 ? 1.0 / scale : 0.0;
+
+  row_cdf.resize(row_xyz.size());
+  for (const auto &range : row_ranges)
+  {
+    double sum = 0.0;
+    for (std::size_t i = range.begin; i < range.end; ++i)
+      row_cdf[i] = sum += std::abs(row_w[i]);
+  }
+  col_cdf.resize(col_xyz.size());
+  for (const auto &range : col_ranges)
+  {
+    double sum = 0.0;
+    for (std::size_t j = range.begin; j < range.end; ++j)
+    {
+      for (int c = 0; c < ncols; ++c)
+        sum += std::abs(col_w[j * ncols + c]) * col_scale[c];
+      col_cdf[j] = sum;
+    }
+  }
+  //
+  // Near cell pairs are summed exactly, far ones get the multipole control
+  // and a sampling weight |A_a| |B_b| (s_a + s_b)^3 / R^4. The size is at
+  // least half a cell, so that far pairs are also beyond the screening range
+  // and cells of one point are not sampled with a vanishing weight
+  //
+  const double separation = Parameters::monte_carlo_separation;
+  std::vector<double> far_weight;
+  for (std::uint32_t a = 0; a < row_cells; ++a)
+  {
+    const auto &ra = row_ranges[a];
+    const double mass_a = row_cdf[ra.end - 1];
+    for (std::uint32_t b = 0; b < col_cells; ++b)
+    {
+      const auto &rb = col_ranges[b];
+      const double dx = rb.center[0] - ra.center[0];
+      const double dy = rb.center[1] - ra.center[1];
+      const double dz = rb.center[2] - ra.center[2];
+      const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+      const std::size_t npairs = (ra.end - ra.begin) * (rb.end - rb.begin);
+      const double size = std::max(ra.radius + rb.radius, 0.5 * cell_size);
+
+      if (dist <= separation * size)
+      {
+        near.push_back({a, b});
+        near_pairs += npairs;
+        continue;
+      }
+
+      const double weight = mass_a * col_cdf[rb.end - 1] * size * size * size / (dist * dist * dist * dist);
+      if (weight <= 0.0)
+        continue; // no weight on one side: the pair adds nothing
+
+      far.push_back({a, b});
+      far_weight.push_back(weight);
+      far_pairs += npairs;
+    }
+  }
+
+  far_cdf.resize(far.size());
+  double sum = 0.0;
+  for (std::size_t p = 0; p < far.size(); ++p)
+    far_cdf[p] = sum += far_weight[p];
+
+  near_sum = exact_sum(near, near_pairs);
+
+  control.assign(ncols, 0.0);
+  double *totals = control.data();
+  const int nfar = far.size();
+
+#pragma omp parallel for reduction(+ : totals[:ncols]) schedule(static)
+  for (int p = 0; p < nfar; ++p)
+    for (int c = 0; c < ncols; ++c)
+      totals[c] += row_moments[0][far[p][0]].coulomb(col_moments[c][far[p][1]]);
+
+  value = near_sum;
+  for (int c = 0; c < ncols; ++c)
+    value[c] += control[c];
+  error.assign(ncols, 0.0);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Adds scale * a_i b_jc [K(r_ij) - T(r_ij)] for every weight set, with T
+/// the second-order Taylor expansion of 1 / r around the cell centers, whose
+/// pair sum is the multipole control of the cell pair.
+///
+template <bool Screened>
+void Sampled_coupling::add_residual(std::size_t i, std::size_t j, const Cell_range &ra, const Cell_range &rb, double scale,
+                                    double *sums) const
+{
+  constexpr Screening S = Screened ? Screening::Screened : Screening::Bare;
+
+  const double rx = rb.center[0] - ra.center[0];
+  const double ry = rb.center[1] - ra.center[1];
+  const double rz = rb.center[2] - ra.center[2];
+  const double dx = (col_xyz[j][0] - rb.center[0]) - (row_xyz[i][0] - ra.center[0]);
+  const double dy = (col_xyz[j][1] - rb.center[1]) - (row_xyz[i][1] - ra.center[1]);
+  const double dz = (col_xyz[j][2] - rb.center[2]) - (row_xyz[i][2] - ra.center[2]);
+
+  const double r2 = rx * rx + ry * ry + rz * rz;
+  const double inv_r = 1.0 / std::sqrt(r2);
+  const double inv_r3 = inv_r * inv_r * inv_r;
+  const double rd = rx * dx + ry * dy + rz * dz;
+  const double d2 = dx * dx + dy * dy + dz * dz;
+  const double taylor = inv_r - rd * inv_r3 + 0.5 * (3.0 * rd * rd - r2 * d2) * inv_r3 * inv_r * inv_r;
+
+  const double px = rx + dx, py = ry + dy, pz = rz + dz;
+  const double k = coulomb_kernel<S>(std::sqrt(px * px + py * py + pz * pz));
+
+  const double weight = scale * row_w[i] * (k - taylor);
+  for (int c = 0; c < ncols; ++c)
+    sums[c] += weight * col_w[j * ncols + c];
+}
+//----------------------------------------------------------------------
+///
+/// @brief Draws one batch: a far cell pair by its weight, then a point of
+/// each cell by its weight. Each sample estimates the whole far residual.
+///
+std::vector<double> Sampled_coupling::sample_batch(std::uint64_t seed, std::uint64_t batch) const
+{
+  std::mt19937_64 generator(mix(seed ^ mix(batch)));
+  std::vector<double> sums(2 * ncols, 0.0);
+  std::vector<double> estimate(ncols);
+
+  const double total = far_cdf.back();
+  for (int s = 0; s < Parameters::monte_carlo_batch; ++s)
+  {
+    const std::size_t p = pick(far_cdf, 0, far_cdf.size(), uniform(generator) * total);
+    const auto &ra = row_ranges[far[p][0]];
+    const auto &rb = col_ranges[far[p][1]];
+
+    const double mass_a = row_cdf[ra.end - 1];
+    const double mass_b = col_cdf[rb.end - 1];
+    const std::size_t i = pick(row_cdf, ra.begin, ra.end, uniform(generator) * mass_a);
+    const std::size_t j = pick(col_cdf, rb.begin, rb.end, uniform(generator) * mass_b);
+
+    // 1 / probability of the pair (i, j)
+    const double pair_weight = far_cdf[p] - (p > 0 ? far_cdf[p - 1] : 0.0);
+    const double point_i = row_cdf[i] - (i > ra.begin ? row_cdf[i - 1] : 0.0);
+    const double point_j = col_cdf[j] - (j > rb.begin ? col_cdf[j - 1] : 0.0);
+    const double scale = total * mass_a * mass_b / (pair_weight * point_i * point_j);
+
+    std::fill(estimate.begin(), estimate.end(), 0.0);
+    if (screened)
+      add_residual<true>(i, j, ra, rb, scale, estimate.data());
+    else
+      add_residual<false>(i, j, ra, rb, scale, estimate.data());
+
+    for (int c = 0; c < ncols; ++c)
+    {
+      sums[c] += estimate[c];
+      sums[ncols + c] += estimate[c] * estimate[c];
+    }
+  }
+  return sums;
+}
+//----------------------------------------------------------------------
+std::vector<double> Sampled_coupling::exact_sum(const std::vector<std::array<std::uint32_t, 2>> &cell_pairs,
+                                                std::size_t npairs) const
+{
+  std::vector<double> sums(ncols, 0.0);
+  double *totals = sums.data();
+  const int ncell_pairs = cell_pairs.size();
+
+  Progress::expect(npairs);
+  with_screening(screened, [&](auto s)
+                 {
+#pragma omp parallel for reduction(+ : totals[:ncols]) schedule(dynamic)
+    for (int p = 0; p < ncell_pairs; ++p)
+    {
+      const auto &ra = row_ranges[cell_pairs[p][0]];
+      const auto &rb = col_ranges[cell_pairs[p][1]];
+      for (std::size_t i = ra.begin; i < ra.end; ++i)
+      {
+        for (std::size_t j = rb.begin; j < rb.end; ++j)
+        {
+          const double dx = row_xyz[i][0] - col_xyz[j][0];
+          const double dy = row_xyz[i][1] - col_xyz[j][1];
+          const double dz = row_xyz[i][2] - col_xyz[j][2];
+          const double k = row_w[i] * coulomb_kernel<s.value>(std::sqrt(dx * dx + dy * dy + dz * dz));
+          for (int c = 0; c < ncols; ++c)
+            totals[c] += k * col_w[j * ncols + c];
+        }
+      }
+      Progress::add((ra.end - ra.begin) * (rb.end - rb.begin));
+    } });
+
+  return sums;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Rounds of batches, each round doubling the samples, until the
+/// tolerance is met or the samples would exceed the budget.
+///
+void Sampled_coupling::estimate(double tolerance, std::uint64_t seed)
+{
+  samples = 0;
+  converged = exact = false;
+  value = near_sum;
+  for (int c = 0; c < ncols; ++c)
+    value[c] += control[c];
+  error.assign(ncols, 0.0);
+
+  if (far.empty())
+  {
+    converged = exact = true;
+    return;
+  }
+
+  const double budget = Parameters::monte_carlo_budget * static_cast<double>(far_pairs);
+  std::vector<double> sums(2 * ncols, 0.0);
+  std::uint64_t batches = 0;
+  std::uint64_t round = Parameters::monte_carlo_first_batches;
+
+  while (static_cast<double>((batches + round) * Parameters::monte_carlo_batch) <= budget)
+  {
+    std::vector<std::vector<double>> results(round);
+    const long long nround = round;
+
+    Progress::expect(round * Parameters::monte_carlo_batch);
+#pragma omp parallel for schedule(dynamic)
+    for (long long b = 0; b < nround; ++b)
+    {
+      results[b] = sample_batch(seed, batches + b);
+      Progress::add(Parameters::monte_carlo_batch);
+    }
+
+    // Reduced in batch order: the same sums for any number of threads
+    for (const auto &result : results)
+      for (int c = 0; c < 2 * ncols; ++c)
+        sums[c] += result[c];
+
+    batches += round;
+    samples = batches * Parameters::monte_carlo_batch;
+    round = batches;
+
+    const double n = static_cast<double>(samples);
+    double largest = 0.0, largest_error = 0.0;
+    for (int c = 0; c < ncols; ++c)
+    {
+      const double mean = sums[c] / n;
+      const double variance = std::max(0.0, (sums[ncols + c] / n - mean * mean) * n / (n - 1.0));
+      value[c] = near_sum[c] + control[c] + mean;
+      error[c] = std::sqrt(variance / n);
+      largest = std::max(largest, std::abs(value[c]));
+      largest_error = std::max(largest_error, error[c]);
+    }
+
+    if (largest_error <= tolerance * largest)
+    {
+      converged = true;
+      return;
+    }
+  }
+  //
+  // Sampling would cost about as much as the exact sum of the far pairs
+  //
+  const auto far_sum = exact_sum(far, far_pairs);
+  for (int c = 0; c < ncols; ++c)
+  {
+    value[c] = near_sum[c] + far_sum[c];
+    error[c] = 0.0;
+  }
+  exact = true;
+}
+//----------------------------------------------------------------------
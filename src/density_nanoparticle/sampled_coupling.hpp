@@ -0,0 +1,105 @@
+#ifndef SAMPLED_COUPLING_HPP
+#define SAMPLED_COUPLING_HPP
+
+#include "chromophore.hpp"
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+///
+/// @class Sampled_coupling
+/// @brief Monte Carlo estimate, with a statistical error bar, of the couplings
+/// sum_ij a_i K(r_ij) b_jc between weighted row points (acceptor density) and
+/// column points carrying one or more weight sets c (donor density, or the
+/// real and imaginary NP charges of every frequency).
+///
+/// Both point sets are binned into cells. Pairs of nearby cells are summed
+/// exactly. For the remaining cell pairs the second-order cell multipoles
+/// (Chromophore::Cell::coulomb) give a control variate that is summed exactly,
+/// and only its residual is sampled: point pairs are drawn with probability
+/// proportional to |a_i| |b_j| and to the size of the multipole error of their
+/// cell pair, |K| (s_a + s_b)^3 / R^3. Samples come in batches, each with its
+/// own generator seeded from (seed, batch), and are reduced in batch order, so
+/// the estimate does not depend on the number of threads.
+///
+class Sampled_coupling
+{
+public:
+  /**
+   * @brief Bins the points and sums the near pairs and the multipole control.
+   * @param rho_rows Row weights (one per row point).
+   * @param xyz_rows Row points.
+   * @param w_cols Column weights, indexed [point * ncols + c].
+   * @param ncols Number of column weight sets.
+   * @param xyz_cols Column points.
+   * @param screened Screened (erf(r / QMscrnFact) / r) or bare Coulomb kernel.
+   */
+  Sampled_coupling(std::span<const double> rho_rows, std::span<const std::array<double, 3>> xyz_rows,
+                   std::span<const double> w_cols, int ncols, std::span<const std::array<double, 3>> xyz_cols,
+                   bool screened);
+
+  /**
+   * @brief Samples the residual until the standard error of every weight set is
+   * below tolerance times the largest coupling. If the samples would cost more
+   * than the exact sum of the far pairs, the residual is summed exactly.
+   * @param tolerance Relative standard error to reach.
+   * @param seed Seed of the batch generators.
+   */
+  void estimate(double tolerance, std::uint64_t seed);
+
+  std::vector<double> value; ///< Coupling of every column weight set
+  std::vector<double> error; ///< Standard error of every value (0 if summed exactly)
+
+  // Statistics
+  std::size_t samples = 0;            ///< Residual samples drawn
+  std::size_t near_pairs = 0;         ///< Point pairs summed exactly (nearby cells)
+  std::size_t far_pairs = 0;          ///< Point pairs covered by the control and the samples
+  std::size_t row_cells = 0, col_cells = 0;
+  bool converged = false;             ///< Tolerance reached by sampling
+  bool exact = false;                 ///< Residual summed exactly instead
+
+private:
+  /// @brief Points of one cell: range in the sorted order, center and radius.
+  struct Cell_range
+  {
+    std::size_t begin = 0, end = 0;
+    std::array<double, 3> center{};
+    double radius = 0.0;
+  };
+
+  /// @brief Sorts the points by cell and fills ranges and multipoles (one per weight set).
+  static void bin(std::span<const std::array<double, 3>> xyz, std::span<const double> w, int nw, double cell_size,
+                  std::vector<std::array<double, 3>> &sorted_xyz, std::vector<double> &sorted_w,
+                  std::vector<Cell_range> &ranges, std::vector<std::vector<Chromophore::Cell>> &moments);
+
+  /// @brief Adds the residual K - Taylor of one point pair to sums (per weight set).
+  template <bool Screened>
+  void add_residual(std::size_t i, std::size_t j, const Cell_range &ra, const Cell_range &rb, double scale,
+                    double *sums) const;
+
+  /// @brief Sums of estimates and squared estimates of one batch, [c] and [ncols + c].
+  std::vector<double> sample_batch(std::uint64_t seed, std::uint64_t batch) const;
+
+  /// @brief Exact sum a_i K(r_ij) b_jc over the point pairs of the given cell pairs.
+  std::vector<double> exact_sum(const std::vector<std::array<std::uint32_t, 2>> &cell_pairs, std::size_t npairs) const;
+
+  int ncols = 1;
+  bool screened = true;
+
+  std::vector<std::array<double, 3>> row_xyz, col_xyz;
+  std::vector<double> row_w, col_w;
+  std::vector<Cell_range> row_ranges, col_ranges;
+  std::vector<double> row_cdf, col_cdf;           ///< Cumulative |weight| inside each cell
+  std::vector<double> col_scale;                  ///< 1 / sum_j |b_jc| per weight set
+
+  std::vector<std::array<std::uint32_t, 2>> near; ///< Near cell pairs (row cell, column cell)
+  std::vector<std::array<std::uint32_t, 2>> far;  ///< Far cell pairs
+  std::vector<double> far_cdf;                    ///< Cumulative sampling weight of the far pairs
+  std::vector<double> near_sum;                   ///< Exact sum over the near pairs, per weight set
+  std::vector<double> control;                    ///< Multipole sum over the far pairs, per weight set
+};
+
+#endif // SAMPLED_COUPLING_HPP
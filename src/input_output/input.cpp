@@ -1,6 +1,10 @@
 #include "input.hpp"
 #include "string_manipulation.hpp"
 #include "target.hpp"
+#include "parameters.hpp"
+#include "numa.hpp"
+#include "ranks.hpp"
+#include "hash.hpp"
 
 #include <iostream>
 #include <string>
@@ -12,6 +16,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <cstdlib>
+#include <iomanip>
+#include <iterator>
 
 #include <omp.h>
 
@@ -41,11 +47,45 @@ void Input::get_arguments(int argc, char *argv[], Output &out, Target &target)
         target.n_threads_OMP = 1; // always 1 without OpenMP
 #endif
 
-        // Scan for -omp N (allowed anywhere)
+        // Scan for -omp N, -bind policy, -counters, -server and -cache N (allowed anywhere)
         for (int i = 1; i < argc; ++i)
         {
             std::string a = argv[i];
-            if (a == "-omp")
+            if (a == "-server")
+            {
+                target.server_mode = true;
+            }
+            else if (a == "-counters")
+            {
+                target.perf_counters = true;
+            }
+            else if (a == "-cache")
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::runtime_error("Missing value for -cache: you must specify an integer after -cache");
+                }
+                str_manipulation.string_to_int(argv[i + 1], target.cache_size);
+                if (target.cache_size < 1)
+                {
+                    throw std::runtime_error("Value for -cache must be >= 1");
+                }
+                ++i; // skip value
+            }
+            else if (a == "-bind")
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::runtime_error("Missing value for -bind: you must specify close, spread or none after -bind");
+                }
+                target.thread_binding = argv[i + 1];
+                if (target.thread_binding != "close" && target.thread_binding != "spread" && target.thread_binding != "none")
+                {
+                    throw std::runtime_error("Value for -bind must be close, spread or none");
+                }
+                ++i; // skip value
+            }
+            else if (a == "-omp")
             {
                 if (i + 1 >= argc)
                 {
@@ -80,6 +120,12 @@ void Input::get_arguments(int argc, char *argv[], Output &out, Target &target)
         }
         omp_set_num_threads(std::max(1, target.n_threads_OMP));
 #endif
+
+        // Bind the threads once, before any parallel region places data
+        if (!target.thread_binding.empty() && target.thread_binding != "none")
+        {
+            bind_threads(target.thread_binding);
+        }
     }
     catch (const std::exception &e)
     {
@@ -92,15 +138,24 @@ void Input::get_arguments(int argc, char *argv[], Output &out, Target &target)
 //----------------------------------------------------------------------
 ///
 /// @brief Parses user-supplied command-line arguments and sets the input filename.
-/// Handles three cases:
+/// Handles four cases:
 /// 1. One argument (input filename)
 /// 2. No arguments (ask user to type filename)
 /// 3. Too many arguments (throws error -- TODO)
+/// 4. -server (no input filename; input files are read from stdin)
 ///
 void Input::parse_arguments(int argc, char *argv[], Output &out)
 {
     input_filename.clear();
 
+    // Server mode reads its input files from stdin
+    bool server_mode = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "-server")
+            server_mode = true;
+    }
+
     // No args: interactive prompt
     if (argc == 1)
     {
@@ -114,14 +169,18 @@ void Input::parse_arguments(int argc, char *argv[], Output &out)
     for (int i = 1; i < argc; ++i)
     {
         std::string a = argv[i];
-        if (a == "-omp")
+        if (a == "-omp" || a == "-cache" || a == "-bind")
         {
             // skip value here; get_arguments will process it
             if (i + 1 >= argc)
-                throw std::runtime_error("Missing value for -omp");
+                throw std::runtime_error("Missing value for " + a);
             ++i;
             continue;
         }
+        if (a == "-server" || a == "-counters")
+        {
+            continue;
+        }
         if (!a.empty() && a[0] == '-')
         {
             throw std::runtime_error("Unknown option: " + a);
@@ -136,9 +195,16 @@ void Input::parse_arguments(int argc, char *argv[], Output &out)
         }
     }
 
+    if (server_mode)
+    {
+        if (!input_filename.empty())
+            throw std::runtime_error("No input file expected with -server: input files are read from stdin.");
+        return;
+    }
+
     if (input_filename.empty())
     {
-        throw std::runtime_error("No input file provided. Usage: program input.inp [-omp N]");
+        throw std::runtime_error("No input file provided. Usage: program input.inp [-omp N] [-bind close|spread|none] [-counters]  or  program -server [-cache N] [-omp N] [-bind close|spread|none] [-counters]");
     }
 
     out.out_file_fill(input_filename); // create output filename(s)
@@ -187,24 +253,216 @@ void Input::read(Target &target)
         target.integrate_density = true;
     };
     // ========
+    handlers["atomic charges"] = [&](const std::string &value)
+    {
+        std::string answer = value;
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        if (answer == "voronoi")
+            target.atomic_partition = AtomicPartition::Voronoi;
+        else if (answer == "becke")
+            target.atomic_partition = AtomicPartition::Becke;
+        else if (answer == "no")
+            target.atomic_partition = AtomicPartition::None;
+        else
+            throw std::runtime_error("Atomic charges must be 'voronoi', 'becke' or 'no', got: '" + value + "'");
+    };
+    // ========
     handlers["acceptor density"] = [&](const std::string &value)
     {
-        check_and_store_file(value, target.acceptor_density_input_file, target.acceptor_density_file);
+        check_and_store_files(value, target.acceptor_density_input_file, target.acceptor_density_file, target.acceptor_density_files);
         target.is_acceptor_density_present = true;
     };
     // ========
     handlers["donor density"] = [&](const std::string &value)
     {
-        check_and_store_file(value, target.donor_density_input_file, target.donor_density_file);
+        check_and_store_files(value, target.donor_density_input_file, target.donor_density_file, target.donor_density_files);
         target.is_donor_density_present = true;
     };
     // ========
     handlers["nanoparticle"] = [&](const std::string &value)
     {
+        if (target.is_nanoparticle_present)
+            throw std::runtime_error("Only one of 'nanoparticle' and 'nanoparticle frequencies' can be given.");
         check_and_store_file(value, target.nanoparticle_input_file, target.nanoparticle_file);
         target.is_nanoparticle_present = true;
     };
     // ========
+    handlers["nanoparticle frequencies"] = [&](const std::string &value)
+    {
+        if (target.is_nanoparticle_present)
+            throw std::runtime_error("Only one of 'nanoparticle' and 'nanoparticle frequencies' can be given.");
+        check_and_store_file(value, target.nanoparticle_input_file, target.nanoparticle_file);
+        target.is_nanoparticle_present = true;
+        target.nanoparticle_frequencies = true;
+    };
+    // ========
+    handlers["aggregate density"] = [&](const std::string &value)
+    {
+        std::string first_file;
+        check_and_store_files(value, target.aggregate_density_input_file, first_file, target.aggregate_density_files);
+        target.is_aggregate_present = true;
+    };
+    // ========
+    handlers["aggregate poses"] = [&](const std::string &value)
+    {
+        check_and_store_file(value, target.aggregate_poses_input_file, target.aggregate_poses_file);
+    };
+    // ========
+    handlers["potential map"] = [&](const std::string &value)
+    {
+        // The cache file is created on the first run, so it need not exist
+        target.potential_map_input_file = value;
+        target.potential_map_file = resolve_relative_to_input(value);
+        target.is_potential_map_present = true;
+    };
+    // ========
+    handlers["potential map tolerance"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.potential_map_tolerance);
+        if (target.potential_map_tolerance <= 0.0)
+            throw std::runtime_error("Potential map tolerance must be positive.");
+    };
+    // ========
+    handlers["checkpoint"] = [&](const std::string &value)
+    {
+        // Written during the run, so it need not exist
+        target.checkpoint_input_file = value;
+        target.checkpoint_file = resolve_relative_to_input(value);
+    };
+    // ========
+    handlers["checkpoint interval"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.checkpoint_interval);
+        if (target.checkpoint_interval < 0.0)
+            throw std::runtime_error("Checkpoint interval cannot be negative.");
+        target.is_checkpoint_interval_present = true;
+    };
+    // ========
+    handlers["progress"] = [&](const std::string &value)
+    {
+        std::string answer = value;
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        if (answer == "yes")
+            target.progress_interval = Parameters::progress_interval;
+        else if (answer == "no")
+            target.progress_interval = 0.0;
+        else
+            throw std::runtime_error("Progress must be 'yes' or 'no', got: '" + value + "'");
+    };
+    // ========
+    handlers["progress interval"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.progress_interval);
+        if (target.progress_interval <= 0.0)
+            throw std::runtime_error("Progress interval must be positive.");
+    };
+    // ========
+    handlers["verbosity"] = [&](const std::string &value)
+    {
+        std::string answer = value;
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        if (answer == "minimal")
+            target.verbosity = Verbosity::Minimal;
+        else if (answer == "normal")
+            target.verbosity = Verbosity::Normal;
+        else
+            throw std::runtime_error("Verbosity must be 'minimal' or 'normal', got: '" + value + "'");
+    };
+    // ========
+    handlers["results file"] = [&](const std::string &value)
+    {
+        std::string answer = value;
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        if (answer == "json")
+            target.results_format = ResultsFormat::Json;
+        else if (answer == "binary")
+            target.results_format = ResultsFormat::Binary;
+        else if (answer == "no")
+            target.results_format = ResultsFormat::None;
+        else
+            throw std::runtime_error("Results file must be 'json', 'binary' or 'no', got: '" + value + "'");
+    };
+    // ========
+    handlers["cutoff sweep"] = [&](const std::string &value)
+    {
+        // Comma-separated cutoffs, from loose to tight
+        target.sweep_cutoffs.clear();
+        std::stringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ','))
+        {
+            double cutoff = 0.0;
+            str_manipulation.string_to_float(item, cutoff);
+            if (cutoff <= 0.0)
+                throw std::runtime_error("Sweep cutoffs must be positive.");
+            if (!target.sweep_cutoffs.empty() && cutoff >= target.sweep_cutoffs.back())
+                throw std::runtime_error("Sweep cutoffs must decrease: '" + value + "'");
+            target.sweep_cutoffs.push_back(cutoff);
+        }
+        if (target.sweep_cutoffs.empty())
+            throw std::runtime_error("No cutoff given in: '" + value + "'");
+        target.is_cutoff_sweep_present = true;
+    };
+    // ========
+    handlers["sweep tolerance"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.sweep_tolerance);
+        if (target.sweep_tolerance <= 0.0)
+            throw std::runtime_error("Sweep tolerance must be positive.");
+    };
+    // ========
+    handlers["compression tolerance"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.compression_tolerance);
+        if (target.compression_tolerance <= 0.0)
+            throw std::runtime_error("Compression tolerance must be positive.");
+        target.is_compression_present = true;
+    };
+    // ========
+    handlers["monte carlo tolerance"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.monte_carlo_tolerance);
+        if (target.monte_carlo_tolerance <= 0.0)
+            throw std::runtime_error("Monte Carlo tolerance must be positive.");
+        target.is_monte_carlo_present = true;
+    };
+    // ========
+    handlers["dipole prescreen"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.dipole_prescreen_tolerance);
+        if (target.dipole_prescreen_tolerance <= 0.0)
+            throw std::runtime_error("Dipole prescreen tolerance must be positive.");
+        target.is_dipole_prescreen_present = true;
+    };
+    // ========
+    handlers["monte carlo seed"] = [&](const std::string &value)
+    {
+        int seed = 0;
+        str_manipulation.string_to_int(value, seed);
+        if (seed < 0)
+            throw std::runtime_error("Monte Carlo seed must be >= 0.");
+        target.monte_carlo_seed = seed;
+    };
+    // ========
+    handlers["trajectory"] = [&](const std::string &value)
+    {
+        check_and_store_file(value, target.trajectory_input_file, target.trajectory_file);
+        target.is_trajectory_present = true;
+    };
+    // ========
+    handlers["trajectory timestep"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.trajectory_timestep);
+        if (target.trajectory_timestep <= 0.0)
+            throw std::runtime_error("Trajectory timestep must be positive.");
+    };
+    // ========
+    handlers["multipole distance"] = [&](const std::string &value)
+    {
+        str_manipulation.string_to_float(value, target.multipole_distance);
+        target.is_multipole_distance_present = true;
+    };
+    // ========
     handlers["cutoff"] = [&](const std::string &value)
     {
         str_manipulation.string_to_float(value, target.cutoff);
@@ -213,6 +471,18 @@ void Input::read(Target &target)
         target.is_cutoff_present = true;
     };
     // ========
+    handlers["screening"] = [&](const std::string &value)
+    {
+        std::string answer = value;
+        std::transform(answer.begin(), answer.end(), answer.begin(), ::tolower);
+        if (answer == "yes")
+            target.screening = true;
+        else if (answer == "no")
+            target.screening = false;
+        else
+            throw std::runtime_error("Screening must be 'yes' or 'no', got: '" + value + "'");
+    };
+    // ========
     handlers["spectral overlap"] = [&](const std::string &value)
     {
         str_manipulation.string_to_float(value, target.spectral_overlap);
@@ -299,8 +569,23 @@ void Input::get_target(Target &target)
         fs::create_directory("debug");
     }
     //
+    // A cutoff sweep reduces the densities with its tightest cutoff
+    //
+    if (target.is_cutoff_sweep_present)
+    {
+        if (target.is_cutoff_present)
+            throw std::runtime_error("Give either a cutoff or a cutoff sweep, not both.");
+        target.cutoff = target.sweep_cutoffs.back();
+        target.is_cutoff_present = true;
+        if (target.sweep_tolerance == 0.0)
+            target.sweep_tolerance = Parameters::sweep_tolerance;
+    }
+    //
     // Assign the different targets.
     //
+    if (target.atomic_partition != AtomicPartition::None && !target.integrate_density)
+        throw std::runtime_error("Atomic charges are only computed when integrating a cube file.");
+
     if (!target.is_cutoff_present &&
         !target.omega_0 &&
         !target.integrate_density)
@@ -314,6 +599,26 @@ void Input::get_target(Target &target)
 
         throw std::runtime_error("You are requesting a cube integration with another type of calculation.");
     }
+    else if (target.is_aggregate_present &&
+             (target.integrate_density || target.is_acceptor_density_present || target.is_donor_density_present || target.is_nanoparticle_present))
+    {
+
+        throw std::runtime_error("You are requesting an aggregate calculation with another type of calculation.");
+    }
+    else if (target.is_aggregate_present)
+    {
+
+        if (target.is_omega_0_present)
+            throw std::runtime_error("Overlap integral can't be computed for aggregates.");
+        if (!target.aggregate_poses_file.empty() && target.aggregate_density_files.size() != 1)
+            throw std::runtime_error("Aggregate poses need exactly one aggregate density.");
+        if (target.aggregate_poses_file.empty() && target.aggregate_density_files.size() < 2)
+            throw std::runtime_error("Aggregate needs at least two densities, or one density and a poses file.");
+        if (!target.is_multipole_distance_present)
+            target.multipole_distance = Parameters::aggregate_multipole_distance;
+
+        target.mode = TargetMode::Aggregate;
+    }
     else if (target.integrate_density)
     {
 
@@ -354,6 +659,79 @@ void Input::get_target(Target &target)
     {
         target.mode = TargetMode::None;
     }
+
+    if (target.is_potential_map_present)
+    {
+        if (target.mode != TargetMode::Acceptor_NP)
+            throw std::runtime_error("Potential maps are only supported for acceptor-NP couplings.");
+        if (target.potential_map_tolerance == 0.0)
+            target.potential_map_tolerance = Parameters::potential_map_tolerance;
+    }
+
+    if (target.is_cutoff_sweep_present)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor && target.mode != TargetMode::Acceptor_NP)
+            throw std::runtime_error("Cutoff sweeps are only supported for acceptor-donor and acceptor-NP couplings.");
+        if (target.calc_overlap_int)
+            throw std::runtime_error("Overlap integral keeps every grid point and can't be combined with a cutoff sweep.");
+        if (target.is_potential_map_present || target.is_trajectory_present || target.is_compression_present)
+            throw std::runtime_error("Cutoff sweeps can't be combined with a potential map, a trajectory or compression.");
+    }
+
+    if (target.is_compression_present)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor && target.mode != TargetMode::Acceptor_NP)
+            throw std::runtime_error("Compression is only supported for acceptor-donor and acceptor-NP couplings.");
+        if (target.is_potential_map_present || target.is_trajectory_present)
+            throw std::runtime_error("Compression can't be combined with a potential map or a trajectory.");
+    }
+
+    if (target.is_monte_carlo_present)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor && target.mode != TargetMode::Acceptor_NP)
+            throw std::runtime_error("Monte Carlo couplings are only supported for acceptor-donor and acceptor-NP couplings.");
+        if (target.calc_overlap_int)
+            throw std::runtime_error("Overlap integral can't be estimated by Monte Carlo.");
+        if (target.is_cutoff_sweep_present || target.is_potential_map_present || target.is_trajectory_present ||
+            target.is_compression_present || !target.checkpoint_file.empty())
+            throw std::runtime_error("Monte Carlo couplings can't be combined with a cutoff sweep, a potential map, a trajectory, compression or checkpoints.");
+    }
+
+    if (target.is_dipole_prescreen_present)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor)
+            throw std::runtime_error("The dipole prescreen is only supported for acceptor-donor couplings.");
+        if (target.calc_overlap_int)
+            throw std::runtime_error("Overlap integral can't be estimated by the dipole prescreen.");
+        if (target.is_cutoff_sweep_present || target.is_trajectory_present || target.is_compression_present ||
+            target.is_monte_carlo_present || !target.checkpoint_file.empty())
+            throw std::runtime_error("The dipole prescreen can't be combined with a cutoff sweep, a trajectory, compression, Monte Carlo or checkpoints.");
+    }
+
+    if (!target.checkpoint_file.empty())
+    {
+        if (target.mode != TargetMode::Acceptor_Donor)
+            throw std::runtime_error("Checkpoints are only supported for acceptor-donor couplings.");
+        if (target.is_cutoff_sweep_present || target.is_trajectory_present || target.is_compression_present)
+            throw std::runtime_error("Checkpoints can't be combined with a cutoff sweep, a trajectory or compression.");
+        if (!target.is_checkpoint_interval_present)
+            target.checkpoint_interval = Parameters::checkpoint_interval;
+    }
+    else if (target.is_checkpoint_interval_present)
+    {
+        throw std::runtime_error("Checkpoint interval given without a checkpoint file.");
+    }
+
+    if (!target.screening && (target.is_potential_map_present || target.is_compression_present))
+        throw std::runtime_error("Potential maps and compression are built for the screened kernel; remove 'screening: no'.");
+
+    if (target.is_trajectory_present)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor && target.mode != TargetMode::Acceptor_NP)
+            throw std::runtime_error("Trajectories are only supported for acceptor-donor and acceptor-NP couplings.");
+        if (target.calc_overlap_int)
+            throw std::runtime_error("Overlap integral can't be computed along a trajectory.");
+    }
 }
 //----------------------------------------------------------------------
 ///
@@ -405,23 +783,117 @@ void Input::check_and_store_file(
 }
 //----------------------------------------------------------------------
 ///
+/// @brief Resolves and checks a comma-separated list of files (e.g. one density per state).
+/// @param raw_input The list as written in the input file
+/// @param input_field Reference to the variable that stores the raw input
+/// @param resolved_field Reference to the variable that stores the first resolved path
+/// @param resolved_list Reference to the variable that stores all resolved paths
+///
+void Input::check_and_store_files(
+    const std::string &raw_input,
+    std::string &input_field,
+    std::string &resolved_field,
+    std::vector<std::string> &resolved_list) const
+{
+    input_field = raw_input;
+    resolved_list.clear();
+
+    std::stringstream list(raw_input);
+    std::string item;
+    while (std::getline(list, item, ','))
+    {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty())
+            throw std::runtime_error("Empty file name in list: '" + raw_input + "'");
+
+        std::string full_path = resolve_relative_to_input(item);
+        file_exists(full_path);
+        resolved_list.push_back(full_path);
+    }
+
+    if (resolved_list.empty())
+        throw std::runtime_error("No file given in: '" + raw_input + "'");
+
+    resolved_field = resolved_list.front();
+}
+//----------------------------------------------------------------------
+///
 /// @brief Prints input file information to the output stream.
 ///
 void Input::print_input_info(const Output &out, const Target &target)
 {
     const std::string indent = std::string(23, ' ');
 
+    auto print_sweep = [&]
+    {
+        if (!target.is_cutoff_sweep_present)
+            return;
+        out.stream() << indent << "Cutoff Sweep         : ";
+        for (std::size_t k = 0; k < target.sweep_cutoffs.size(); ++k)
+            out.stream() << (k > 0 ? ", " : "") << target.sweep_cutoffs[k];
+        out.stream() << "  (tolerance " << target.sweep_tolerance << ")\n\n";
+    };
+
+    auto print_screening = [&]
+    {
+        if (!target.screening)
+            out.stream() << indent << "Screening            : No (bare 1/r kernel)\n\n";
+    };
+
     out.stream() << indent << "Input  File: " << target.input_filename << "\n";
     out.stream() << indent << "Output File: " << out.output_filename << "\n\n";
-    out.stream() << indent << "OMP Threads: " << target.n_threads_OMP << "\n\n ";
+    out.stream() << indent << "OMP Threads: " << target.n_threads_OMP << "\n\n";
+    if (Ranks::size() > 1)
+        out.stream() << indent << "MPI Ranks: " << Ranks::size() << "\n\n";
+    if (target.progress_interval > 0.0)
+        out.stream() << indent << "Progress File: " << std::filesystem::path(out.progress_filename()).filename().string()
+                     << "   (every " << target.progress_interval << " s)\n\n";
+    if (!target.thread_binding.empty())
+    {
+        out.stream() << indent << "Thread Binding: " << target.thread_binding << "   (" << numa_nodes() << " NUMA nodes)\n";
+        for (const auto &binding : thread_bindings())
+        {
+            out.stream() << indent << "   Thread " << std::setw(3) << binding.thread
+                         << "  CPU " << std::setw(4) << binding.cpu
+                         << "  Node " << std::setw(2) << binding.node
+                         << "  Allowed " << binding.allowed << "\n";
+        }
+        out.stream() << "\n";
+    }
+    if (target.results_format != ResultsFormat::None)
+        out.stream() << indent << "Results File: " << std::filesystem::path(out.results_filename(target)).filename().string() << "\n\n";
+    out.stream() << " ";
     out.stream() << out.sticks << "\n";
     out.stream() << "\n";
 
+    // Run description and input fingerprint of the machine-readable results
+    {
+        std::ifstream file(target.input_filename, std::ios::binary);
+        const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        auto &results = out.results();
+        results.add("program", "FretLab");
+        results.add("input", target.input_filename);
+        results.add_fingerprint("input_fingerprint", fnv1a(text.data(), text.size()));
+        results.add("mode", target.mode == TargetMode::IntegrateCube       ? "integrate_cube"
+                            : target.mode == TargetMode::Acceptor_Donor    ? "acceptor_donor"
+                            : target.mode == TargetMode::Acceptor_NP       ? "acceptor_np"
+                            : target.mode == TargetMode::Acceptor_NP_Donor ? "acceptor_np_donor"
+                            : target.mode == TargetMode::Aggregate         ? "aggregate"
+                                                                           : "none");
+        results.add("threads", target.n_threads_OMP);
+        results.add("ranks", Ranks::size());
+    }
+
     switch (target.mode)
     {
     case TargetMode::IntegrateCube:
         out.stream() << indent << "Calculation --> Integrate Cube Density\n\n";
         out.stream() << indent << "Density File: " << target.density_file_integration_input << "\n\n";
+        if (target.atomic_partition != AtomicPartition::None)
+            out.stream() << indent << "Atomic Charges: "
+                         << (target.atomic_partition == AtomicPartition::Voronoi ? "Voronoi" : "Becke") << "\n\n";
         out.stream() << " " << out.sticks << "\n \n";
         break;
 
@@ -429,6 +901,18 @@ void Input::print_input_info(const Output &out, const Target &target)
         out.stream() << indent << "Calculation --> Acceptor - Donor\n\n";
         out.stream() << indent << "Acceptor Density File: " << target.acceptor_density_input_file << "\n";
         out.stream() << indent << "Donor    Density File: " << target.donor_density_input_file << "\n\n";
+        if (target.is_trajectory_present)
+            out.stream() << indent << "Trajectory File      : " << target.trajectory_input_file << "\n\n";
+        if (target.is_compression_present)
+            out.stream() << indent << "Compression Tolerance: " << target.compression_tolerance << "\n\n";
+        if (target.is_monte_carlo_present)
+            out.stream() << indent << "Monte Carlo Tolerance: " << target.monte_carlo_tolerance << "  (seed " << target.monte_carlo_seed << ")\n\n";
+        if (target.is_dipole_prescreen_present)
+            out.stream() << indent << "Dipole Prescreen     : " << target.dipole_prescreen_tolerance << "\n\n";
+        if (!target.checkpoint_file.empty())
+            out.stream() << indent << "Checkpoint File      : " << target.checkpoint_input_file << "  (every " << target.checkpoint_interval << " s)\n\n";
+        print_sweep();
+        print_screening();
         if (!target.calc_overlap_int)
         {
             out.stream() << indent << "Overlap Integral     : No\n";
@@ -449,7 +933,20 @@ void Input::print_input_info(const Output &out, const Target &target)
     case TargetMode::Acceptor_NP:
         out.stream() << indent << "Calculation --> Acceptor - NP\n\n";
         out.stream() << indent << "Acceptor Density File: " << target.acceptor_density_input_file << "\n";
-        out.stream() << indent << "Nanoparticle File    : " << target.nanoparticle_input_file << "\n\n";
+        if (target.nanoparticle_frequencies)
+            out.stream() << indent << "Nanoparticle List    : " << target.nanoparticle_input_file << "\n\n";
+        else
+            out.stream() << indent << "Nanoparticle File    : " << target.nanoparticle_input_file << "\n\n";
+        if (target.is_trajectory_present)
+            out.stream() << indent << "Trajectory File      : " << target.trajectory_input_file << "\n\n";
+        if (target.is_potential_map_present)
+            out.stream() << indent << "Potential Map        : " << target.potential_map_input_file << "  (tolerance " << target.potential_map_tolerance << ")\n\n";
+        if (target.is_compression_present)
+            out.stream() << indent << "Compression Tolerance: " << target.compression_tolerance << "\n\n";
+        if (target.is_monte_carlo_present)
+            out.stream() << indent << "Monte Carlo Tolerance: " << target.monte_carlo_tolerance << "  (seed " << target.monte_carlo_seed << ")\n\n";
+        print_sweep();
+        print_screening();
 
         out.stream() << indent << "Overlap Integral     : No\n";
         out.stream() << indent << "Cutoff               : " << target.cutoff << "   a.u.\n\n";
@@ -481,6 +978,23 @@ void Input::print_input_info(const Output &out, const Target &target)
 
         break;
 
+    case TargetMode::Aggregate:
+        out.stream() << indent << "Calculation --> Aggregate\n\n";
+        out.stream() << indent << "Aggregate Densities  : " << target.aggregate_density_input_file << "\n";
+        if (!target.aggregate_poses_file.empty())
+            out.stream() << indent << "Aggregate Poses      : " << target.aggregate_poses_input_file << "\n";
+        out.stream() << "\n";
+        out.stream() << indent << "Overlap Integral     : No\n";
+        out.stream() << indent << "Cutoff               : " << target.cutoff << "   a.u.\n";
+        if (target.multipole_distance > 0.0)
+            out.stream() << indent << "Multipole Distance   : " << target.multipole_distance << "   a.u.\n\n";
+        else
+            out.stream() << indent << "Multipole Distance   : No\n\n";
+        print_screening();
+        out.stream() << " " << out.sticks << "\n \n";
+
+        break;
+
     case TargetMode::None:
     default:
         throw std::runtime_error("No valid calculation target specified in input.");
@@ -6,6 +6,7 @@
 #include "target.hpp"
 
 #include <string>
+#include <vector>
 
 
 ///
@@ -78,6 +79,14 @@ private:
     void check_and_store_file(const std::string& raw_input,
                               std::string& input_field,
                               std::string& resolved_field) const;
+
+    /// @brief Same as check_and_store_file for a comma-separated list of files.
+    ///
+    /// The first resolved path is stored in resolved_field, all of them in resolved_list.
+    void check_and_store_files(const std::string& raw_input,
+                               std::string& input_field,
+                               std::string& resolved_field,
+                               std::vector<std::string>& resolved_list) const;
                               
 };
 
@@ -2,6 +2,8 @@
 #include "parameters.hpp"
 #include "integrals.hpp"
 #include "nanoparticle.hpp"
+#include "timer.hpp"
+#include "hash.hpp"
 
 #include <iostream>
 #include <filesystem>
@@ -13,6 +15,9 @@
 #include <ostream>
 #include <numeric>
 #include <cmath>
+#include <vector>
+#include <span>
+#include <cctype>
 
 /// @brief Constructor for Output.
 Output::Output() {}
@@ -59,6 +64,44 @@ std::ofstream &Output::stream() const
 }
 //----------------------------------------------------------------------
 ///
+/// @brief Gets the machine-readable results collected so far.
+///
+Results_record &Output::results() const
+{
+    return const_cast<Results_record &>(record);
+}
+//----------------------------------------------------------------------
+std::string Output::results_filename(const Target &target) const
+{
+    return output_filename.substr(0, output_filename.size() - 4) +
+           (target.results_format == ResultsFormat::Binary ? ".bin" : ".json");
+}
+//----------------------------------------------------------------------
+///
+/// @brief Adds the total time (and the time of every phase, with -counters)
+/// to the results and writes them as JSON or as a binary record.
+///
+void Output::write_results(const Target &target, const Timer &timer) const
+{
+    if (target.results_format == ResultsFormat::None)
+        return;
+
+    auto &results = this->results();
+    results.add("time_total", timer.elapsed("total"));
+    if (const Perf_counters *counters = timer.events())
+    {
+        for (const auto &phase : counters->phases())
+        {
+            std::string key = "time_" + phase.name;
+            for (auto &c : key)
+                c = std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::tolower(static_cast<unsigned char>(c))) : '_';
+            results.add(key, phase.seconds);
+        }
+    }
+    results.write(results_filename(target), target.results_format == ResultsFormat::Binary);
+}
+//----------------------------------------------------------------------
+///
 /// @brief Closes the output file stream.
 ///
 void Output::close()
@@ -110,6 +153,10 @@ void Output::print_density(const std::string &filepath, const Density &cube, std
     }
     log_stream << " " << sticks << "\n \n";
     log_stream << std::string(3, ' ') << "Density File: " << filename << "\n \n";
+    if (cube.nchannels > 1)
+    {
+        log_stream << std::string(3, ' ') << "Density States: " << cube.nchannels << " (first file shown)\n \n";
+    }
     log_stream << std::string(3, ' ') << "Density Grid (CUBE format): \n \n";
 
     print_formatted_line1(log_stream, cube.natoms, cube.xmin, cube.ymin, cube.zmin);
@@ -131,16 +178,48 @@ void Output::print_density(const std::string &filepath, const Density &cube, std
     //    Write(out_%iunit,*)     "    ---> Reduced density points:", cube%n_points_reduced
     // Endif
 
-    log_stream << std::string(3, ' ') << "Associated molecular coordinates (Å): \n \n";
-    for (int i = 0; i < cube.natoms; ++i)
+    if (verbosity == Verbosity::Minimal)
+    {
+        log_stream << std::string(3, ' ') << "Associated molecular coordinates: " << cube.natoms << " atoms (not listed, minimal verbosity)\n";
+    }
+    else
+    {
+        log_stream << std::string(3, ' ') << "Associated molecular coordinates (Å): \n \n";
+        Text_buffer buffer(&log_stream, Parameters::write_buffer_size);
+        for (int i = 0; i < cube.natoms; ++i)
+        {
+            print_formatted_line2(buffer, cube.atomic_label[i],
+                                  cube.x[i] * Parameters::ToAng,
+                                  cube.y[i] * Parameters::ToAng,
+                                  cube.z[i] * Parameters::ToAng);
+        }
+    }
+
+    // Results: acceptor_*, donor_* or density_* entries
+    const std::string key = !header.has_value()                         ? "density"
+                            : header.value() == Parameters::acceptor_header ? "acceptor"
+                                                                            : "donor";
+    std::uint64_t fingerprint = fnv1a(cube.rho_reduced.data(), cube.rho_reduced.size() * sizeof(double));
+    fingerprint = fnv1a(cube.xyz.data(), cube.xyz.size() * sizeof(cube.xyz[0]), fingerprint);
+    record.add(key + "_file", filename);
+    record.add_fingerprint(key + "_fingerprint", fingerprint);
+    record.add(key + "_states", cube.nchannels);
+    record.add(key + "_atoms", cube.natoms);
+    record.add(key + "_grid_points", static_cast<std::int64_t>(cube.nx) * cube.ny * cube.nz);
+    if (header.has_value())
+        record.add(key + "_points", cube.n_points_reduced);
+    if (cube.integral != 0.0)
+        record.add(key + "_integral", cube.integral);
+    if (!cube.population.empty())
     {
-        print_formatted_line2(log_stream, std::string(cube.atomic_label[i]),
-                              cube.x[i] * Parameters::ToAng,
-                              cube.y[i] * Parameters::ToAng,
-                              cube.z[i] * Parameters::ToAng);
+        std::vector<double> charges(cube.population.size());
+        for (std::size_t i = 0; i < charges.size(); ++i)
+            charges[i] = cube.atomic_charge[i] - cube.population[i];
+        record.add(key + "_populations", cube.population);
+        record.add(key + "_charges", charges);
     }
 
-    if (cube.integral > 0.0)
+    if (cube.integral != 0.0)
     {
         log_stream << " \n";
         log_stream << "    ============================================================\n";
@@ -148,6 +227,315 @@ void Output::print_density(const std::string &filepath, const Density &cube, std
         log_stream << "    ============================================================\n";
     }
 
+    if (!cube.population.empty())
+    {
+        const bool voronoi = cube.partition == AtomicPartition::Voronoi;
+        log_stream << " \n";
+        log_stream << std::string(3, ' ') << "Atomic populations (" << (voronoi ? "Voronoi" : "Becke") << " cells), charge = nuclear charge - population: \n \n";
+        log_stream << std::string(5, ' ') << std::setw(6) << "#" << std::setw(6) << "Atom"
+                   << std::setw(24) << "Population" << std::setw(24) << "Charge" << "\n";
+        log_stream << std::fixed << std::setprecision(14);
+        for (int i = 0; i < cube.natoms; ++i)
+        {
+            log_stream << std::string(5, ' ') << std::setw(6) << i + 1 << std::setw(6) << cube.atomic_label[i]
+                       << std::setw(24) << cube.population[i]
+                       << std::setw(24) << cube.atomic_charge[i] - cube.population[i] << "\n";
+        }
+    }
+
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints a column-major coupling matrix under the given title.
+///
+void Output::print_coupling_matrix(const std::string &title, int nrows, int ncols, const std::vector<double> &matrix)
+{
+    log_stream << std::string(5, ' ') << title << "\n\n";
+    log_stream << std::string(5, ' ') << std::setw(8) << "#";
+    for (int d = 0; d < ncols; ++d)
+    {
+        log_stream << std::setw(25) << d + 1;
+    }
+    log_stream << "\n";
+    for (int a = 0; a < nrows; ++a)
+    {
+        log_stream << std::string(5, ' ') << std::setw(8) << a + 1;
+        for (int d = 0; d < ncols; ++d)
+        {
+            log_stream << std::fixed << std::setw(25) << std::setprecision(16) << matrix[a + nrows * d];
+        }
+        log_stream << "\n";
+    }
+    log_stream << "\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Writes a square matrix as plain text: a comment header, then one row
+/// per line with full double precision, for post-processing scripts.
+///
+void Output::write_matrix_file(const std::string &path, int n, const std::vector<double> &matrix) const
+{
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("Failed to open matrix file: " + path);
+
+    file << "# FretLab Coulomb coupling matrix (a.u.)\n";
+    file << "# " << n << " x " << n << "\n";
+    file << std::scientific << std::setprecision(17);
+    for (int a = 0; a < n; ++a)
+    {
+        for (int b = 0; b < n; ++b)
+        {
+            file << (b == 0 ? "" : " ") << matrix[a * n + b];
+        }
+        file << "\n";
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the nanoparticle potential map statistics.
+///
+void Output::print_potential_map(const std::string &filepath, const Potential_map &map)
+{
+    log_stream << std::string(27, ' ') << "Potential Map Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::string(3, ' ') << "Map File: " << std::filesystem::path(filepath).filename().string() << "\n \n";
+    log_stream << std::string(3, ' ') << "Blocks loaded from file    : " << map.blocks_loaded << "\n";
+    log_stream << std::string(3, ' ') << "Blocks built in this run   : " << map.blocks_built << "\n";
+    log_stream << std::string(3, ' ') << "Blocks using direct sum    : " << map.blocks_direct << "\n";
+    log_stream << std::string(3, ' ') << "Largest relative test error: " << std::scientific << std::setprecision(3) << map.max_error << "\n";
+    log_stream << std::defaultfloat;
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the coupling after each cutoff of a sweep; the final coupling
+/// follows as the usual results.
+///
+void Output::print_cutoff_sweep(const Target &target, const Integrals &integrals)
+{
+    const bool np = target.mode == TargetMode::Acceptor_NP;
+
+    log_stream << std::string(5, ' ') << "Cutoff Convergence (a.u.)\n\n";
+    log_stream << std::string(5, ' ') << std::setw(10) << "Cutoff" << std::setw(11) << "Acceptor" << std::setw(11) << (np ? "NP sites" : "Donor");
+    if (np)
+        log_stream << std::setw(25) << "Re" << std::setw(25) << "Im";
+    else
+        log_stream << std::setw(25) << "Coulomb";
+    log_stream << std::setw(13) << "Rel. change" << "\n";
+    log_stream << std::string(5, ' ') << std::string(np ? 95 : 70, '-') << "\n";
+
+    for (std::size_t k = 0; k < integrals.sweep.size(); ++k)
+    {
+        const auto &step = integrals.sweep[k];
+        log_stream << std::string(5, ' ') << std::scientific << std::setprecision(2) << std::setw(10) << step.cutoff
+                   << std::setw(11) << step.npoints_acceptor << std::setw(11) << step.npoints_donor
+                   << std::fixed << std::setprecision(16) << std::setw(25) << step.coupling[0];
+        if (np)
+            log_stream << std::setw(25) << step.coupling[1];
+        if (k == 0)
+            log_stream << std::setw(13) << "-";
+        else
+            log_stream << std::scientific << std::setprecision(3) << std::setw(13) << step.change;
+        log_stream << "\n";
+    }
+
+    log_stream << "\n" << std::string(5, ' ');
+    if (integrals.sweep_converged)
+        log_stream << "Converged at cutoff " << std::scientific << std::setprecision(2) << integrals.sweep.back().cutoff;
+    else
+        log_stream << "Not converged within the given cutoffs";
+    log_stream << " (tolerance " << std::scientific << std::setprecision(2) << target.sweep_tolerance << ")\n\n";
+    log_stream << std::defaultfloat;
+
+    std::vector<double> cutoffs, couplings;
+    for (const auto &step : integrals.sweep)
+    {
+        cutoffs.push_back(step.cutoff);
+        couplings.push_back(step.coupling[0]);
+    }
+    record.add("sweep_cutoffs", cutoffs);
+    record.add("sweep_couplings", couplings);
+    record.add("sweep_converged", integrals.sweep_converged ? 1 : 0);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the size and accuracy of a compressed interaction operator.
+///
+void Output::print_compression(const H_matrix &op, double sampled_error, bool reused)
+{
+    const double MB = 1024.0 * 1024.0;
+
+    log_stream << std::string(24, ' ') << "Compressed Operator Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::string(3, ' ') << "Operator size              : " << op.nrows << " x " << op.ncols << "\n";
+    log_stream << std::string(3, ' ') << "Operator reused from cache : " << (reused ? "Yes" : "No") << "\n";
+    log_stream << std::string(3, ' ') << "Tolerance                  : " << std::scientific << std::setprecision(2) << op.tolerance << "\n";
+    log_stream << std::string(3, ' ') << "Low-rank blocks            : " << op.low_rank_blocks << "  (max rank " << op.max_rank << ")\n";
+    log_stream << std::string(3, ' ') << "Dense blocks               : " << op.dense_blocks << "\n";
+    log_stream << std::fixed << std::setprecision(2);
+    log_stream << std::string(3, ' ') << "Memory (compressed)        : " << op.memory_bytes() / MB << " MB\n";
+    log_stream << std::string(3, ' ') << "Memory (dense operator)    : " << op.dense_bytes() / MB << " MB\n";
+    log_stream << std::string(3, ' ') << "Sampled relative error     : " << std::scientific << std::setprecision(2) << sampled_error << "\n";
+    record.add("compression_low_rank_blocks", static_cast<std::int64_t>(op.low_rank_blocks));
+    record.add("compression_dense_blocks", static_cast<std::int64_t>(op.dense_blocks));
+    record.add("compression_bytes", static_cast<double>(op.memory_bytes()));
+    record.add("compression_error", sampled_error);
+    log_stream << std::defaultfloat;
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints how a Monte Carlo coupling was obtained and its standard
+/// error (acceptor-NP: real and imaginary parts of the first frequency).
+///
+void Output::print_monte_carlo(const Target &target, const Integrals &integrals)
+{
+    log_stream << std::string(28, ' ') << "Monte Carlo Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::string(3, ' ') << "Point pairs summed exactly : " << integrals.monte_carlo_near_pairs << "\n";
+    log_stream << std::string(3, ' ') << "Point pairs from multipoles: " << integrals.monte_carlo_far_pairs << "\n";
+    log_stream << std::string(3, ' ') << "Residual samples           : " << integrals.monte_carlo_samples << "\n";
+    log_stream << std::scientific << std::setprecision(2);
+    if (target.mode == TargetMode::Acceptor_Donor)
+    {
+        const double coupling = std::abs(integrals.coulomb_acceptor_donor);
+        const double error = integrals.monte_carlo_error[0];
+        log_stream << std::string(3, ' ') << "Standard error             : " << error << "  a.u.";
+        if (coupling > 0.0)
+            log_stream << "  (relative " << error / coupling << ")";
+        log_stream << "\n";
+    }
+    else
+    {
+        log_stream << std::string(3, ' ') << "Standard error (Re, Im)    : " << integrals.monte_carlo_error[0] << ", "
+                   << integrals.monte_carlo_error[1] << "  a.u.\n";
+    }
+    log_stream << std::string(3, ' ') << "Tolerance                  : " << target.monte_carlo_tolerance << "\n";
+    record.add("monte_carlo_samples", static_cast<std::int64_t>(integrals.monte_carlo_samples));
+    record.add("monte_carlo_error", integrals.monte_carlo_error);
+    log_stream << std::defaultfloat;
+    if (integrals.monte_carlo_converged)
+        log_stream << std::string(3, ' ') << "Tolerance reached by sampling\n";
+    else
+        log_stream << std::string(3, ' ') << "Sampling would not pay off: residual summed exactly\n";
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the couplings of the dipole and multipole models, the
+/// estimated error of the multipole one and whether it was kept.
+///
+void Output::print_prescreen(const Target &target, const Integrals &integrals)
+{
+    log_stream << std::string(28, ' ') << "Dipole Prescreen Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::fixed << std::setprecision(4);
+    log_stream << std::string(3, ' ') << "Center distance            : " << integrals.prescreen_distance << "  Bohr\n";
+    log_stream << std::string(3, ' ') << "Gap between the spheres    : " << integrals.prescreen_gap << "  Bohr\n";
+    if (integrals.prescreen_gap > 0.0)
+    {
+        log_stream << std::scientific << std::setprecision(6);
+        log_stream << std::string(3, ' ') << "Ideal dipole coupling      : " << integrals.prescreen_dipole << "  a.u.\n";
+        log_stream << std::string(3, ' ') << "Extended dipole coupling   : " << integrals.prescreen_extended_dipole << "  a.u.\n";
+        log_stream << std::string(3, ' ') << "Multipole coupling         : " << integrals.prescreen_multipole << "  a.u.\n";
+        log_stream << std::setprecision(2);
+        log_stream << std::string(3, ' ') << "Estimated error            : " << integrals.prescreen_error << "  a.u.\n";
+        log_stream << std::string(3, ' ') << "Tolerance                  : " << target.dipole_prescreen_tolerance << "\n";
+    }
+    record.add("prescreen_multipole", integrals.prescreen_multipole);
+    record.add("prescreen_error", integrals.prescreen_error);
+    record.add("prescreen_promoted", integrals.prescreen_promoted ? 1 : 0);
+    log_stream << std::defaultfloat;
+    if (integrals.prescreen_gap <= 0.0)
+        log_stream << std::string(3, ' ') << "Densities overlap: promoted to the full integral\n";
+    else if (integrals.prescreen_promoted)
+        log_stream << std::string(3, ' ') << "Error above tolerance: promoted to the full integral\n";
+    else
+        log_stream << std::string(3, ' ') << "Multipole coupling kept\n";
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+std::string Output::progress_filename() const
+{
+    return output_filename.substr(0, output_filename.size() - 4) + ".progress";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints how much of a checkpointed run was resumed and how many checkpoints were written.
+///
+void Output::print_checkpoint(const std::string &filepath, const Integrals &integrals)
+{
+    log_stream << std::string(28, ' ') << "Checkpoint Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::string(3, ' ') << "Checkpoint File: " << std::filesystem::path(filepath).filename().string() << "\n \n";
+    log_stream << std::string(3, ' ') << "Acceptor points            : " << integrals.checkpoint_rows << "\n";
+    log_stream << std::string(3, ' ') << "Points resumed from file   : " << integrals.checkpoint_rows_resumed << "\n";
+    log_stream << std::string(3, ' ') << "Checkpoints written        : " << integrals.checkpoint_saves << "\n";
+    log_stream << std::string(3, ' ') << "File removed after completion\n";
+    log_stream << " \n " << sticks << "\n\n";
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the summary of a trajectory run; the per-frame values are in the series file.
+///
+void Output::print_trajectory(const Target &target, const Trajectory &trajectory, const std::string &series_file)
+{
+    log_stream << std::string(36, ' ') << "RESULTS\n\n";
+    log_stream << " " << sticks << " \n\n";
+
+    log_stream << std::string(5, ' ') << "Trajectory frames       : " << trajectory.nframes << "\n";
+    record.add("frames", static_cast<std::int64_t>(trajectory.nframes));
+    record.add("mean", std::span<const double>(trajectory.mean));
+    record.add("min", std::span<const double>(trajectory.min));
+    record.add("max", std::span<const double>(trajectory.max));
+    log_stream << std::string(5, ' ') << "Time series written to  : " << std::filesystem::path(series_file).filename().string() << "\n\n";
+
+    if (trajectory.nframes > 0)
+    {
+        log_stream << std::fixed << std::setprecision(16);
+        if (target.mode == TargetMode::Acceptor_Donor)
+        {
+            log_stream << std::string(5, ' ') << "Mean Total Potential    : " << std::setw(25) << trajectory.mean[0] << "  a.u.\n";
+            log_stream << std::string(5, ' ') << "Min  Total Potential    : " << std::setw(25) << trajectory.min[0] << "  a.u.\n";
+            log_stream << std::string(5, ' ') << "Max  Total Potential    : " << std::setw(25) << trajectory.max[0] << "  a.u.\n\n";
+            log_stream << std::string(5, ' ') << "Mean Keet :" << std::setw(25) << trajectory.mean_keet << "  a.u.\n\n";
+        }
+        else
+        {
+            log_stream << std::string(5, ' ') << "Mean Acceptor-NP Interaction : " << std::setw(25) << trajectory.mean[0] << " + " << trajectory.mean[1] << " i  a.u.\n";
+            log_stream << std::string(5, ' ') << "Min  Acceptor-NP Interaction : " << std::setw(25) << trajectory.min[0] << " + " << trajectory.min[1] << " i  a.u.\n";
+            log_stream << std::string(5, ' ') << "Max  Acceptor-NP Interaction : " << std::setw(25) << trajectory.max[0] << " + " << trajectory.max[1] << " i  a.u.\n\n";
+        }
+    }
+
+    log_stream << " " << sticks << "\n\n";
+    log_stream.flush();
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints the chromophores of an aggregate.
+///
+void Output::print_aggregate(const std::vector<Chromophore> &chromophores)
+{
+    log_stream << std::string(29, ' ') << "Aggregate Information\n \n";
+    log_stream << " " << sticks << "\n \n";
+    log_stream << std::string(3, ' ') << "Chromophores: " << chromophores.size() << "\n \n";
+    log_stream << std::string(3, ' ') << std::setw(6) << "#" << std::setw(12) << "Points"
+               << std::setw(14) << "X (Å)" << std::setw(14) << "Y (Å)" << std::setw(14) << "Z (Å)"
+               << std::setw(14) << "Radius (Å)" << "   File\n";
+    for (std::size_t c = 0; c < chromophores.size(); ++c)
+    {
+        const auto &chromophore = chromophores[c];
+        log_stream << std::string(3, ' ') << std::setw(6) << c + 1 << std::setw(12) << chromophore.xyz.size()
+                   << std::fixed << std::setprecision(6)
+                   << std::setw(14) << chromophore.center[0] * Parameters::ToAng
+                   << std::setw(14) << chromophore.center[1] * Parameters::ToAng
+                   << std::setw(14) << chromophore.center[2] * Parameters::ToAng
+                   << std::setw(14) << chromophore.radius * Parameters::ToAng
+                   << "   " << std::filesystem::path(chromophore.label).filename().string() << "\n";
+    }
     log_stream << " \n " << sticks << "\n\n";
 }
 //----------------------------------------------------------------------
@@ -156,21 +544,42 @@ void Output::print_density(const std::string &filepath, const Density &cube, std
 ///
 void Output::print_nanoparticle(const Nanoparticle &np)
 {
-    log_stream << std::string(23, ' ') << "Nanoparticle Model   : " << np.nanoparticle_model << "\n\n";
+    log_stream << std::string(23, ' ') << "Nanoparticle Model   : " << np.nanoparticle_model << "\n";
+    if (np.nfreq > 1)
+    {
+        log_stream << std::string(23, ' ') << "Frequencies          : " << np.nfreq << "\n";
+    }
+    log_stream << "\n";
     log_stream << sticks << "\n\n";
     log_stream << std::string(28, ' ') << "Nanoparticle Geometry (Å)                    \n \n";
     log_stream << " " << sticks << "\n \n";
-    log_stream << std::string(13, ' ') << "Atom" << std::string(15, ' ') << "X" << std::string(19, ' ') << "Y" << std::string(19, ' ') << "Z" << "\n";
-    log_stream << " " << sticks << "\n \n";
 
     // Print nanoparticle properties
-    for (int i = 0; i < np.natoms; ++i)
+    if (verbosity == Verbosity::Minimal)
     {
-        print_formatted_line3(log_stream, std::string("Xx"),
-                              np.xyz[i][0] * Parameters::ToAng,
-                              np.xyz[i][1] * Parameters::ToAng,
-                              np.xyz[i][2] * Parameters::ToAng);
+        log_stream << std::string(13, ' ') << "Sites: " << np.natoms << " (not listed, minimal verbosity)\n";
     }
+    else
+    {
+        log_stream << std::string(13, ' ') << "Atom" << std::string(15, ' ') << "X" << std::string(19, ' ') << "Y" << std::string(19, ' ') << "Z" << "\n";
+        log_stream << " " << sticks << "\n \n";
+        Text_buffer buffer(&log_stream, Parameters::write_buffer_size);
+        for (int i = 0; i < np.natoms; ++i)
+        {
+            print_formatted_line3(buffer, "Xx",
+                                  np.xyz[i][0] * Parameters::ToAng,
+                                  np.xyz[i][1] * Parameters::ToAng,
+                                  np.xyz[i][2] * Parameters::ToAng);
+        }
+    }
+
+    std::uint64_t fingerprint = fnv1a(np.q.data(), np.q.size() * sizeof(np.q[0]));
+    fingerprint = fnv1a(np.mu.data(), np.mu.size() * sizeof(np.mu[0]), fingerprint);
+    fingerprint = fnv1a(np.xyz.data(), np.xyz.size() * sizeof(np.xyz[0]), fingerprint);
+    record.add("nanoparticle_model", np.nanoparticle_model);
+    record.add_fingerprint("nanoparticle_fingerprint", fingerprint);
+    record.add("nanoparticle_sites", np.natoms);
+    record.add("nanoparticle_frequencies", np.nfreq);
 
     log_stream << " \n " << sticks << "\n\n";
 }
@@ -186,23 +595,23 @@ void Output::print_formatted_line1(std::ostream &out, int i, double a, double b,
 }
 // ----------------------------------------------------------------------
 ///
-/// @brief Prints a formatted line with atom information to the output stream.
+/// @brief Appends a formatted line with atom information to the buffer.
 //
-void Output::print_formatted_line2(std::ostream &out, const std::string atom, double x, double y, double z)
+void Output::print_formatted_line2(Text_buffer &out, const std::string &atom, double x, double y, double z)
 {
-    char line[100];
-    std::snprintf(line, sizeof(line), "       %-2s  %12.6f  %12.6f  %12.6f\n", atom.c_str(), x, y, z);
-    out << line;
+    // "       %-2s  %12.6f  %12.6f  %12.6f\n"
+    out.append("       ").left(atom, 2);
+    out.append("  ").fixed(x, 12, 6).append("  ").fixed(y, 12, 6).append("  ").fixed(z, 12, 6).append('\n');
 }
 // ----------------------------------------------------------------------
 ///
-/// @brief Prints a formatted line with nanoparticle information to the output stream.
+/// @brief Appends a formatted line with nanoparticle information to the buffer.
 //
-void Output::print_formatted_line3(std::ostream &out, const std::string atom, double x, double y, double z)
+void Output::print_formatted_line3(Text_buffer &out, const std::string &atom, double x, double y, double z)
 {
-    char line[100];
-    std::snprintf(line, sizeof(line), "              %-2s  %19.6f %19.6f %19.6f\n", atom.c_str(), x, y, z);
-    out << line;
+    // "              %-2s  %19.6f %19.6f %19.6f\n"
+    out.append("              ").left(atom, 2);
+    out.append("  ").fixed(x, 19, 6).append(' ').fixed(y, 19, 6).append(' ').fixed(z, 19, 6).append('\n');
 }
 //----------------------------------------------------------------------
 ///
@@ -217,11 +626,40 @@ void Output::print_results_integrals(const Target &target, const Integrals &inte
     log_stream << std::string(36, ' ') << "RESULTS\n\n";
     log_stream << " " << sticks << " \n\n";
 
+    if (target.is_cutoff_sweep_present)
+        print_cutoff_sweep(target, integrals);
+
     switch (target.mode)
     {
 
     case TargetMode::Acceptor_Donor:
 
+        if (integrals.nstates_acceptor > 1 || integrals.nstates_donor > 1)
+        {
+            print_coupling_matrix("Acceptor-Donor Coulomb (a.u.), rows: acceptor states, columns: donor states", integrals.nstates_acceptor, integrals.nstates_donor, integrals.coulomb_matrix);
+            if (target.calc_overlap_int)
+            {
+                print_coupling_matrix("Acceptor-Donor Overlap (a.u.), rows: acceptor states, columns: donor states", integrals.nstates_acceptor, integrals.nstates_donor, integrals.overlap_matrix);
+            }
+            std::vector<double> total(integrals.coulomb_matrix.size());
+            for (std::size_t k = 0; k < total.size(); ++k)
+            {
+                total[k] = integrals.coulomb_matrix[k] + integrals.overlap_matrix[k];
+            }
+            print_coupling_matrix("Total Potential (a.u.), rows: acceptor states, columns: donor states", integrals.nstates_acceptor, integrals.nstates_donor, total);
+
+            record.add("acceptor_states", integrals.nstates_acceptor);
+            record.add("donor_states", integrals.nstates_donor);
+            record.add("coulomb_matrix", integrals.coulomb_matrix);
+            if (target.calc_overlap_int)
+                record.add("overlap_matrix", integrals.overlap_matrix);
+            record.add("total_potential_matrix", total);
+
+            log_stream << " " << sticks << "\n\n";
+            log_stream.flush();
+            break;
+        }
+
         log_stream << std::string(5, ' ') << "Acceptor-Donor Coulomb  : " << std::fixed << std::setw(25) << std::setprecision(16) << integrals.coulomb_acceptor_donor << "  a.u.\n";
         if (target.calc_overlap_int)
         {
@@ -236,17 +674,76 @@ void Output::print_results_integrals(const Target &target, const Integrals &inte
             << std::string(5, ' ') << "Total Potential         : " << std::fixed << std::setw(25) << std::setprecision(16) << v_tot[0] << "  a.u.\n\n";
         log_stream << std::string(5, ' ') << "Total Potential Modulus : " << std::fixed << std::setw(25) << std::setprecision(16) << v_mod << "  a.u.\n\n";
 
-        log_stream << std::string(5, ' ') << "Keet :" << std::fixed << std::setw(25) << std::setprecision(16)
-                   << 2.0 * Parameters::pi * (v_mod * v_mod) * target.spectral_overlap << "  a.u.\n\n";
+        {
+            const double keet = 2.0 * Parameters::pi * (v_mod * v_mod) * target.spectral_overlap;
+            log_stream << std::string(5, ' ') << "Keet :" << std::fixed << std::setw(25) << std::setprecision(16)
+                       << keet << "  a.u.\n\n";
+
+            record.add("coulomb", integrals.coulomb_acceptor_donor);
+            if (target.calc_overlap_int)
+                record.add("overlap", integrals.overlap_acceptor_donor);
+            record.add("total_potential", v_tot[0]);
+            record.add("total_potential_modulus", v_mod);
+            record.add("keet", keet);
+        }
 
         log_stream << " " << sticks << "\n\n";
         log_stream.flush();
 
         break;
 
+    case TargetMode::Aggregate:
+    {
+        print_coupling_matrix("Coulomb Coupling Matrix (a.u.), rows and columns: chromophores",
+                              integrals.nchromophores, integrals.nchromophores, integrals.aggregate_matrix);
+
+        const int npairs = integrals.nchromophores * (integrals.nchromophores - 1) / 2;
+        log_stream << std::string(5, ' ') << "Pairs from cell multipoles : " << integrals.aggregate_multipole_pairs << " of " << npairs << "\n\n";
+
+        const std::string matrix_file = output_filename.substr(0, output_filename.size() - 4) + ".matrix";
+        write_matrix_file(matrix_file, integrals.nchromophores, integrals.aggregate_matrix);
+        log_stream << std::string(5, ' ') << "Coupling matrix written to : " << std::filesystem::path(matrix_file).filename().string() << "\n\n";
+
+        record.add("chromophores", integrals.nchromophores);
+        record.add("multipole_pairs", integrals.aggregate_multipole_pairs);
+        record.add("coupling_matrix", integrals.aggregate_matrix);
+
+        log_stream << " " << sticks << "\n\n";
+        log_stream.flush();
+        break;
+    }
+
     case TargetMode::Acceptor_NP:
 
-        log_stream << std::string(5, ' ') << "Acceptor-NP Interaction : " << std::fixed << std::setw(25) << std::setprecision(16) << integrals.overlap_acceptor_nanoparticle[0] << " + " << integrals.overlap_acceptor_nanoparticle[1] << " i  a.u.\n\n";
+        if (integrals.acceptor_nanoparticle_frequencies.empty())
+        {
+            log_stream << std::string(5, ' ') << "Acceptor-NP Interaction : " << std::fixed << std::setw(25) << std::setprecision(16) << integrals.overlap_acceptor_nanoparticle[0] << " + " << integrals.overlap_acceptor_nanoparticle[1] << " i  a.u.\n\n";
+            record.add("acceptor_np", std::span<const double>(integrals.overlap_acceptor_nanoparticle));
+        }
+        else
+        {
+            // Coupling vs frequency table
+            log_stream << std::string(5, ' ') << "Acceptor-NP Interaction vs Frequency (a.u.)\n\n";
+            log_stream << std::string(5, ' ') << std::setw(20) << "Omega" << std::setw(25) << "Re" << std::setw(25) << "Im" << "\n";
+            log_stream << std::string(5, ' ') << std::string(70, '-') << "\n";
+            for (std::size_t k = 0; k < integrals.acceptor_nanoparticle_frequencies.size(); ++k)
+            {
+                log_stream << std::string(5, ' ') << std::fixed << std::setprecision(10) << std::setw(20) << integrals.acceptor_nanoparticle_frequencies[k]
+                           << std::setprecision(16) << std::setw(25) << integrals.acceptor_nanoparticle_spectrum[k][0]
+                           << std::setw(25) << integrals.acceptor_nanoparticle_spectrum[k][1] << "\n";
+            }
+            log_stream << "\n";
+
+            std::vector<double> re, im;
+            for (const auto &value : integrals.acceptor_nanoparticle_spectrum)
+            {
+                re.push_back(value[0]);
+                im.push_back(value[1]);
+            }
+            record.add("frequencies", integrals.acceptor_nanoparticle_frequencies);
+            record.add("acceptor_np_re", re);
+            record.add("acceptor_np_im", im);
+        }
         log_stream << " " << sticks << "\n\n";
         log_stream.flush();
         break;
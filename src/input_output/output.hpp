@@ -4,9 +4,16 @@
 #include "density.hpp"
 #include "integrals.hpp"
 #include "nanoparticle.hpp"
+#include "chromophore.hpp"
+#include "trajectory.hpp"
+#include "potential_map.hpp"
+#include "h_matrix.hpp"
+#include "results_record.hpp"
+#include "text_buffer.hpp"
 
 #include <optional>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <stdexcept>
 #include <cstdio>
@@ -19,6 +26,7 @@
 /// This class is responsible for managing output operations.
 
 class Input; // Forward declaration of Input to avoid circular dependency
+class Timer;
 
 class Output
 {
@@ -49,9 +57,45 @@ public:
     /// @brief Prints nanoparticle information to the output file.
     void print_nanoparticle(const Nanoparticle &np);
 
+    /// @brief Prints the chromophores of an aggregate.
+    void print_aggregate(const std::vector<Chromophore> &chromophores);
+
+    /// @brief Prints the nanoparticle potential map statistics.
+    void print_potential_map(const std::string &filepath, const Potential_map &map);
+
+    /// @brief Prints the coupling vs cutoff table of a cutoff sweep.
+    void print_cutoff_sweep(const Target &target, const Integrals &integrals);
+
+    /// @brief Prints the size and accuracy of a compressed interaction operator.
+    void print_compression(const H_matrix &op, double sampled_error, bool reused);
+
+    /// @brief Prints the samples and standard error of a Monte Carlo coupling.
+    void print_monte_carlo(const Target &target, const Integrals &integrals);
+
+    /// @brief Prints the dipole estimates of a prescreened coupling and whether they were kept.
+    void print_prescreen(const Target &target, const Integrals &integrals);
+
+    /// @brief Prints the restart and checkpoint statistics of a checkpointed run.
+    void print_checkpoint(const std::string &filepath, const Integrals &integrals);
+
+    /// @brief Prints the summary of a trajectory run.
+    void print_trajectory(const Target &target, const Trajectory &trajectory, const std::string &series_file);
+
     /// @brief Prints integrals' results
     void print_results_integrals(const Target &target, const Integrals &integrals);
 
+    /// @brief Writes the machine-readable results (with the timings) if the input asked for them.
+    void write_results(const Target &target, const Timer &timer) const;
+
+    /// @brief Results file: output file with .json or .bin.
+    std::string results_filename(const Target &target) const;
+
+    /// @brief Gets the machine-readable results collected by the print_* methods.
+    Results_record &results() const;
+
+    /// @brief Minimal: atoms and nanoparticle sites are counted, not listed.
+    Verbosity verbosity = Verbosity::Normal;
+
     /// @brief Horizontal line (80 dashes) separation output sections
     const std::string sticks = std::string(80, '-');
 
@@ -62,20 +106,31 @@ public:
     /// Full path or name of the output file.
     std::string output_filename;
 
+    /// @brief Sidecar file of the progress heartbeat (output file with .progress).
+    std::string progress_filename() const;
+
 private:
     /// @brief Prints a formatted line with cube information to the output stream.
     void print_formatted_line1(std::ostream &out, int i, double a, double b, double c);
 
-    /// @brief Prints a formatted line with atom information to the output stream.
-    void print_formatted_line2(std::ostream &out, const std::string atom, double x, double y, double z);
+    /// @brief Appends a formatted line with atom information to the buffer.
+    void print_formatted_line2(Text_buffer &out, const std::string &atom, double x, double y, double z);
+
+    /// @brief Prints a column-major coupling matrix under the given title.
+    void print_coupling_matrix(const std::string &title, int nrows, int ncols, const std::vector<double> &matrix);
 
-    /// @brief Prints a formatted line with nanoparticle information to the output stream.
-    void print_formatted_line3(std::ostream &out, const std::string atom, double x, double y, double z);
+    /// @brief Writes a square matrix to a plain text file.
+    void write_matrix_file(const std::string &path, int n, const std::vector<double> &matrix) const;
+
+    /// @brief Appends a formatted line with nanoparticle information to the buffer.
+    void print_formatted_line3(Text_buffer &out, const std::string &atom, double x, double y, double z);
 
     // Define formats for output
     std::string format1 = "   {:5d} {:15.7E} {:15.7E} {:15.7E}\n";
 
     std::ofstream log_stream; ///< The output file stream
+
+    Results_record record; ///< Machine-readable results of the run
 };
 
 #endif
@@ -0,0 +1,145 @@
+#include "results_record.hpp"
+#include "text_buffer.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+  void json_string(Text_buffer &out, std::string_view s)
+  {
+    static constexpr char hex[] = "0123456789abcdef";
+    out.append('"');
+    for (const char c : s)
+    {
+      if (c == '"' || c == '\\')
+        out.append('\\').append(c);
+      else if (static_cast<unsigned char>(c) < 0x20)
+        out.append("\\u00").append(hex[(c >> 4) & 0xf]).append(hex[c & 0xf]);
+      else
+        out.append(c);
+    }
+    out.append('"');
+  }
+
+  void json_number(Text_buffer &out, double value)
+  {
+    if (std::isfinite(value))
+      out.shortest(value);
+    else
+      out.append("null");
+  }
+
+  template <typename T>
+  void put(std::string &bytes, T value)
+  {
+    char raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    bytes.append(raw, sizeof(T));
+  }
+} // namespace
+
+//----------------------------------------------------------------------
+void Results_record::set(std::string_view key, Value value)
+{
+  for (auto &entry : entries)
+  {
+    if (entry.first == key)
+    {
+      entry.second = std::move(value);
+      return;
+    }
+  }
+  entries.emplace_back(std::string(key), std::move(value));
+}
+//----------------------------------------------------------------------
+///
+/// @brief One "key": value line per entry.
+///
+std::string Results_record::json() const
+{
+  Text_buffer out;
+  out.append("{\n");
+  for (std::size_t k = 0; k < entries.size(); ++k)
+  {
+    const auto &[key, value] = entries[k];
+    out.append("  ");
+    json_string(out, key);
+    out.append(": ");
+
+    if (const auto *i = std::get_if<std::int64_t>(&value))
+      out.integer(*i);
+    else if (const auto *h = std::get_if<std::uint64_t>(&value))
+    {
+      char digits[17];
+      for (int d = 15; d >= 0; --d)
+        digits[15 - d] = "0123456789abcdef"[(*h >> (4 * d)) & 0xf];
+      digits[16] = '\0';
+      json_string(out, digits);
+    }
+    else if (const auto *x = std::get_if<double>(&value))
+      json_number(out, *x);
+    else if (const auto *s = std::get_if<std::string>(&value))
+      json_string(out, *s);
+    else
+    {
+      const auto &values = std::get<std::vector<double>>(value);
+      out.append('[');
+      for (std::size_t j = 0; j < values.size(); ++j)
+      {
+        if (j > 0)
+          out.append(", ");
+        json_number(out, values[j]);
+      }
+      out.append(']');
+    }
+    out.append(k + 1 < entries.size() ? ",\n" : "\n");
+  }
+  out.append("}\n");
+  return out.str();
+}
+//----------------------------------------------------------------------
+std::string Results_record::binary() const
+{
+  std::string bytes("FLRB");
+  put<std::uint32_t>(bytes, 1);
+  put<std::uint32_t>(bytes, static_cast<std::uint32_t>(entries.size()));
+
+  for (const auto &[key, value] : entries)
+  {
+    put<std::uint8_t>(bytes, static_cast<std::uint8_t>(value.index()));
+    put<std::uint16_t>(bytes, static_cast<std::uint16_t>(key.size()));
+    bytes.append(key);
+
+    if (const auto *i = std::get_if<std::int64_t>(&value))
+      put(bytes, *i);
+    else if (const auto *h = std::get_if<std::uint64_t>(&value))
+      put(bytes, *h);
+    else if (const auto *x = std::get_if<double>(&value))
+      put(bytes, *x);
+    else if (const auto *s = std::get_if<std::string>(&value))
+    {
+      put<std::uint32_t>(bytes, static_cast<std::uint32_t>(s->size()));
+      bytes.append(*s);
+    }
+    else
+    {
+      const auto &values = std::get<std::vector<double>>(value);
+      put<std::uint64_t>(bytes, values.size());
+      bytes.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(double));
+    }
+  }
+  return bytes;
+}
+//----------------------------------------------------------------------
+void Results_record::write(const std::string &path, bool binary_format) const
+{
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  const std::string bytes = binary_format ? binary() : json();
+  file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  if (!file)
+    throw std::runtime_error("Failed to write results file: " + path);
+}
+//----------------------------------------------------------------------
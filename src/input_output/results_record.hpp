@@ -0,0 +1,57 @@
+#ifndef RESULTS_RECORD_HPP
+#define RESULTS_RECORD_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+///
+/// @class Results_record
+/// @brief Machine-readable results of a run (couplings, counts, timings and
+/// input fingerprints), written next to the .log as JSON or as a binary record.
+///
+/// Entries keep the order they were added in; adding a key again replaces its
+/// value. JSON: one flat object, doubles in their shortest round-trip form
+/// (non-finite ones as null) and fingerprints as 16 hex digits. Binary, in
+/// host byte order:
+///
+///   "FLRB", uint32 version (1), uint32 number of entries, then per entry
+///   uint8 type, uint16 key length, key, value:
+///     0 int64 | 1 uint64 | 2 double | 3 uint32 length + text |
+///     4 uint64 count + count doubles
+///
+class Results_record
+{
+public:
+  using Value = std::variant<std::int64_t, std::uint64_t, double, std::string, std::vector<double>>;
+
+  void add(std::string_view key, std::int64_t value) { set(key, value); }
+  void add(std::string_view key, int value) { set(key, std::int64_t(value)); }
+  void add(std::string_view key, double value) { set(key, value); }
+  void add(std::string_view key, std::string_view value) { set(key, std::string(value)); }
+  void add(std::string_view key, std::span<const double> values) { set(key, std::vector<double>(values.begin(), values.end())); }
+
+  /// @brief Fingerprint (hash) entry.
+  void add_fingerprint(std::string_view key, std::uint64_t value) { set(key, value); }
+
+  bool empty() const { return entries.empty(); }
+
+  /// @brief Formats the record as a JSON object.
+  std::string json() const;
+
+  /// @brief Serializes the record in the binary layout above.
+  std::string binary() const;
+
+  /// @brief Writes json() or binary() to a file; throws if it can't be written.
+  void write(const std::string &path, bool binary_format) const;
+
+private:
+  std::vector<std::pair<std::string, Value>> entries;
+
+  void set(std::string_view key, Value value);
+};
+
+#endif // RESULTS_RECORD_HPP
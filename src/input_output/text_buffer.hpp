@@ -0,0 +1,116 @@
+#ifndef TEXT_BUFFER_HPP
+#define TEXT_BUFFER_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+///
+/// @class Text_buffer
+/// @brief Text formatted with std::to_chars into one large buffer, written to
+/// a stream in blocks.
+///
+/// Long tables (atoms, nanoparticle sites) are appended here instead of going
+/// through the formatting of the stream line by line. fixed() gives the same
+/// characters as printf("%W.Pf"); shortest() the shortest text that reads back
+/// to the same double. Without a sink the text is kept until str() is taken.
+///
+class Text_buffer
+{
+public:
+  explicit Text_buffer(std::ostream *sink = nullptr, std::size_t capacity = std::size_t(1) << 20)
+      : sink(sink), capacity(capacity)
+  {
+    text.reserve(sink ? capacity + 256 : 256);
+  }
+
+  ~Text_buffer() { flush(); }
+
+  Text_buffer(const Text_buffer &) = delete;
+  Text_buffer &operator=(const Text_buffer &) = delete;
+
+  Text_buffer &append(std::string_view s)
+  {
+    text.append(s);
+    return spill();
+  }
+
+  Text_buffer &append(char c)
+  {
+    text.push_back(c);
+    return spill();
+  }
+
+  /// @brief s left-aligned in width characters (printf "%-Ws").
+  Text_buffer &left(std::string_view s, int width)
+  {
+    text.append(s);
+    if (static_cast<int>(s.size()) < width)
+      text.append(static_cast<std::size_t>(width) - s.size(), ' ');
+    return spill();
+  }
+
+  /// @brief Integer right-aligned in width characters (printf "%Wd").
+  Text_buffer &integer(long long value, int width = 0)
+  {
+    char digits[24];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    return right(std::string_view(digits, static_cast<std::size_t>(end - digits)), width);
+  }
+
+  /// @brief Fixed notation right-aligned in width characters (printf "%W.Pf").
+  Text_buffer &fixed(double value, int width, int precision)
+  {
+    char digits[352];
+    const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    if (ec != std::errc())
+      return right("inf", width);
+    return right(std::string_view(digits, static_cast<std::size_t>(end - digits)), width);
+  }
+
+  /// @brief Shortest round-trip representation.
+  Text_buffer &shortest(double value)
+  {
+    char digits[32];
+    const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    text.append(digits, end);
+    return spill();
+  }
+
+  /// @brief Writes the buffered text to the sink.
+  void flush()
+  {
+    if (sink && !text.empty())
+    {
+      sink->write(text.data(), static_cast<std::streamsize>(text.size()));
+      text.clear();
+    }
+  }
+
+  const std::string &str() const { return text; }
+
+private:
+  std::ostream *sink;
+  std::size_t capacity;
+  std::string text;
+
+  Text_buffer &right(std::string_view s, int width)
+  {
+    if (static_cast<int>(s.size()) < width)
+      text.append(static_cast<std::size_t>(width) - s.size(), ' ');
+    text.append(s);
+    return spill();
+  }
+
+  Text_buffer &spill()
+  {
+    if (sink && text.size() >= capacity)
+      flush();
+    return *this;
+  }
+};
+
+#endif // TEXT_BUFFER_HPP
@@ -0,0 +1,174 @@
+#include "trajectory_reader.hpp"
+#include "string_manipulation.hpp"
+#include "parameters.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+
+///
+/// @brief Constructor: opens the trajectory and reads the DCD header if any.
+///
+Trajectory_reader::Trajectory_reader(const std::string &filepath) : filepath(filepath)
+{
+    std::string extension = std::filesystem::path(filepath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    dcd = (extension == ".dcd");
+
+    file.open(filepath, dcd ? std::ios::in | std::ios::binary : std::ios::in);
+    if (!file)
+        throw std::runtime_error("Could not open trajectory file: " + filepath);
+
+    if (!dcd)
+        return;
+
+    //
+    // DCD header: "CORD" + 20 control integers, title block, atom count
+    //
+    if (!read_record(record) || record.size() != 84 || std::memcmp(record.data(), "CORD", 4) != 0)
+        throw std::runtime_error("Not a little-endian CHARMM/NAMD DCD file: " + filepath);
+
+    std::int32_t icntrl[20];
+    std::memcpy(icntrl, record.data() + 4, sizeof(icntrl));
+
+    if (icntrl[8] != 0)
+        throw std::runtime_error("DCD files with fixed atoms are not supported: " + filepath);
+    const bool charmm = icntrl[19] != 0;
+    dcd_unit_cell = charmm && icntrl[10] != 0;
+    dcd_4d = charmm && icntrl[11] != 0;
+
+    if (!read_record(record)) // titles
+        throw std::runtime_error("Truncated DCD header: " + filepath);
+
+    if (!read_record(record) || record.size() != 4)
+        throw std::runtime_error("Truncated DCD header: " + filepath);
+    std::int32_t natoms;
+    std::memcpy(&natoms, record.data(), 4);
+    dcd_natoms = natoms;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads the next frame. Returns false at the end of the trajectory.
+///
+bool Trajectory_reader::next(Trajectory_frame &frame)
+{
+    const bool found = dcd ? next_dcd(frame) : next_xyz(frame);
+    if (found)
+        frame.index = frames_read++;
+    return found;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads one XYZ frame: atom count, comment, then one atom per line.
+///
+bool Trajectory_reader::next_xyz(Trajectory_frame &frame)
+{
+    std::string line;
+
+    // Atom count (blank lines between frames are skipped)
+    do
+    {
+        if (!std::getline(file, line))
+            return false;
+        line.erase(0, line.find_first_not_of(" \t\r"));
+    } while (line.empty());
+
+    std::size_t natoms = 0;
+    try
+    {
+        natoms = std::stoul(line);
+    }
+    catch (const std::exception &)
+    {
+        throw std::runtime_error("Invalid atom count '" + line + "' in frame " + std::to_string(frames_read) + " of " + filepath);
+    }
+
+    std::getline(file, line); // comment
+
+    frame.labels.resize(natoms);
+    frame.xyz.resize(natoms);
+    for (std::size_t i = 0; i < natoms; ++i)
+    {
+        if (!std::getline(file, line))
+            throw std::runtime_error("Truncated frame " + std::to_string(frames_read) + " in " + filepath);
+
+        const char *first = line.data();
+        const char *last = line.data() + line.size();
+
+        while (first < last && std::isspace(static_cast<unsigned char>(*first)))
+            ++first;
+        const char *label_end = first;
+        while (label_end < last && !std::isspace(static_cast<unsigned char>(*label_end)))
+            ++label_end;
+        frame.labels[i].assign(first, label_end);
+        first = label_end;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            double value;
+            if (!parse_next_double(first, last, value))
+                throw std::runtime_error("Invalid coordinates in frame " + std::to_string(frames_read) + " of " + filepath + ": " + line);
+            frame.xyz[i][k] = value * Parameters::ToBohr;
+        }
+    }
+
+    return true;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads one DCD frame: optional unit cell, then x, y and z records.
+///
+bool Trajectory_reader::next_dcd(Trajectory_frame &frame)
+{
+    if (dcd_unit_cell)
+    {
+        if (!read_record(record))
+            return false;
+    }
+
+    frame.labels.clear();
+    frame.xyz.resize(dcd_natoms);
+
+    for (int k = 0; k < 3; ++k)
+    {
+        if (!read_record(record))
+        {
+            if (k == 0 && !dcd_unit_cell)
+                return false;
+            throw std::runtime_error("Truncated frame " + std::to_string(frames_read) + " in " + filepath);
+        }
+        if (record.size() != static_cast<std::size_t>(dcd_natoms) * sizeof(float))
+            throw std::runtime_error("Unexpected record size in frame " + std::to_string(frames_read) + " of " + filepath);
+
+        const float *values = reinterpret_cast<const float *>(record.data());
+        for (int i = 0; i < dcd_natoms; ++i)
+            frame.xyz[i][k] = static_cast<double>(values[i]) * Parameters::ToBohr;
+    }
+
+    if (dcd_4d && !read_record(record))
+        throw std::runtime_error("Truncated frame " + std::to_string(frames_read) + " in " + filepath);
+
+    return true;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads one Fortran unformatted record (32-bit length markers).
+///
+bool Trajectory_reader::read_record(std::vector<char> &buffer)
+{
+    std::int32_t length = 0, closing = 0;
+    if (!file.read(reinterpret_cast<char *>(&length), 4))
+        return false;
+    if (length < 0)
+        throw std::runtime_error("Corrupted record in " + filepath);
+
+    buffer.resize(length);
+    if (!file.read(buffer.data(), length) || !file.read(reinterpret_cast<char *>(&closing), 4) || closing != length)
+        throw std::runtime_error("Corrupted record in " + filepath);
+
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef TRAJECTORY_READER_HPP
+#define TRAJECTORY_READER_HPP
+
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <cstddef>
+
+///
+/// @struct Trajectory_frame
+/// @brief Atomic positions of one trajectory frame (Bohr).
+///
+struct Trajectory_frame
+{
+    std::size_t index = 0;                   ///< Frame number, from 0
+    std::vector<std::string> labels;         ///< Element labels (XYZ only, empty for DCD)
+    std::vector<std::array<double, 3>> xyz;  ///< Positions, converted to Bohr
+};
+
+///
+/// @class Trajectory_reader
+/// @brief Sequential reader of multi-frame XYZ or DCD trajectories.
+///
+/// Only one frame is held at a time. The format is chosen from the
+/// extension: ".dcd" is read as a CHARMM/NAMD binary DCD (little-endian,
+/// no fixed atoms), anything else as concatenated XYZ frames (atom count
+/// line, comment line, "label x y z" lines). Coordinates of both formats
+/// are in Angstrom.
+///
+class Trajectory_reader
+{
+public:
+    /// Constructor: opens the trajectory and reads the DCD header if any.
+    explicit Trajectory_reader(const std::string &filepath);
+
+    /// @brief Reads the next frame. Returns false at the end of the trajectory.
+    bool next(Trajectory_frame &frame);
+
+private:
+    bool next_xyz(Trajectory_frame &frame);
+    bool next_dcd(Trajectory_frame &frame);
+
+    /// @brief Reads one Fortran unformatted record. Returns false at end of file.
+    bool read_record(std::vector<char> &buffer);
+
+    std::string filepath;
+    std::ifstream file;
+    bool dcd = false;
+    std::size_t frames_read = 0;
+
+    // DCD header
+    int dcd_natoms = 0;
+    bool dcd_unit_cell = false;
+    bool dcd_4d = false;
+    std::vector<char> record;
+};
+
+#endif // TRAJECTORY_READER_HPP
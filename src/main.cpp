@@ -6,6 +6,7 @@
 #include "output.hpp"
 #include "timer.hpp"
 #include "algorithm.hpp"
+#include "server.hpp"
 
 //---------------------------------------------------------------------------
 //                     ______          __  __          __          
@@ -35,8 +36,18 @@ int main(int argc, char* argv[]) {
 
         // Parse input arguments
         inp.get_arguments(argc, argv, out, target);
+
+        // Server mode: run input files read from stdin until "quit"
+        if (target.server_mode) {
+            Server server(target);
+            server.run(std::cin, std::cout);
+            return 0;
+        }
+
         timer.initialize();
         timer.start("total");
+        if (target.perf_counters)
+            timer.count_events();
 
         // Open output file. Check input file existence and extension
         out.open();
@@ -51,27 +62,12 @@ int main(int argc, char* argv[]) {
         // Initialize algorithm instance with output and target references.
         Algorithm algorithm(out, target);
 
-        switch (target.mode) {
-            case TargetMode::IntegrateCube:
-            algorithm.integrate_density(target);
-            break;
-
-            case TargetMode::Acceptor_Donor:
-            algorithm.acceptor_donor(target);
-            break;
-
-            case TargetMode::Acceptor_NP:
-            algorithm.acceptor_np(target);
-            break;
-
-            case TargetMode::None:
-            default:
-                throw std::runtime_error("No valid calculation target specified in input.");
-        }
+        algorithm.run(target);
 
         // Finalize timing and output
         timer.finish("total");
         timer.conclude(out);
+        out.write_results(target, timer);
 
         out.close();
 
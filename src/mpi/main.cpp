@@ -0,0 +1,98 @@
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+#include <mpi.h>
+
+#include "target.hpp"
+#include "input.hpp"
+#include "output.hpp"
+#include "timer.hpp"
+#include "algorithm.hpp"
+#include "mpi_ranks.hpp"
+
+//---------------------------------------------------------------------------
+//
+//   FretLab_mpi: FretLab with the pair sums of the acceptor-donor and
+//   acceptor-NP couplings shared by MPI ranks (OpenMP threads inside each).
+//   Every rank reads the input files; rank 0 writes the output.
+//
+//---------------------------------------------------------------------------
+
+namespace
+{
+    ///
+    /// @brief Rejects calculations whose work is not split among ranks, or that
+    /// write files besides the log (every rank would write them).
+    ///
+    void check_distributed(const Target &target)
+    {
+        if (target.mode != TargetMode::Acceptor_Donor && target.mode != TargetMode::Acceptor_NP &&
+            target.mode != TargetMode::Acceptor_NP_Donor)
+            throw std::runtime_error("FretLab_mpi computes acceptor-donor and acceptor-NP couplings; use FretLab for other calculations.");
+        if (target.is_cutoff_sweep_present || target.is_potential_map_present || target.is_compression_present ||
+            target.is_monte_carlo_present || target.is_trajectory_present || !target.checkpoint_file.empty())
+            throw std::runtime_error("Cutoff sweeps, potential maps, compression, Monte Carlo, trajectories and checkpoints are not distributed; use FretLab.");
+    }
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+
+    {
+        Mpi_ranks ranks;
+        Output out;
+
+        try {
+            Timer timer;
+            Input inp;
+            Target target;
+
+            inp.get_arguments(argc, argv, out, target);
+            if (target.server_mode)
+                throw std::runtime_error("Server mode is not available in FretLab_mpi.");
+
+            timer.initialize();
+            timer.start("total");
+            if (target.perf_counters)
+                timer.count_events();
+
+            // Only rank 0 writes the log
+            if (Ranks::rank() != 0)
+                out.output_filename = "/dev/null";
+            out.open();
+            inp.check_input_file(out);
+
+            out.print_banner();
+
+            inp.read(target);
+            check_distributed(target);
+            if (Ranks::rank() != 0)
+                target.progress_interval = 0.0;
+            inp.print_input_info(out, target);
+
+            Algorithm algorithm(out, target);
+
+            algorithm.run(target);
+
+            timer.finish("total");
+            timer.conclude(out);
+            if (Ranks::rank() == 0)
+                out.write_results(target, timer);
+
+            out.close();
+
+        } catch (const std::exception& e) {
+            out.stream() << " Error: " << e.what() << std::endl;
+            if (Ranks::rank() == 0)
+                std::cerr << " Error: " << e.what() << std::endl;
+            // Other ranks may be waiting in a reduction
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    MPI_Finalize();
+    return 0;
+}
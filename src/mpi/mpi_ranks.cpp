@@ -0,0 +1,33 @@
+#include "mpi_ranks.hpp"
+
+#include <vector>
+
+//----------------------------------------------------------------------
+Mpi_ranks::Mpi_ranks(MPI_Comm comm) : comm(comm)
+{
+    MPI_Comm_rank(comm, &me);
+    MPI_Comm_size(comm, &nprocs);
+}
+//----------------------------------------------------------------------
+///
+/// @brief MPI_Reduce may add the contributions in any order (and differently
+/// for different process counts or message sizes), so the values are gathered
+/// and added in rank order instead. The vectors are a few numbers per state or
+/// frequency, so the gather costs nothing next to the pair sums.
+///
+void Mpi_ranks::sum_over_ranks(std::span<double> values) const
+{
+    const int n = static_cast<int>(values.size());
+
+    std::vector<double> gathered(me == 0 ? static_cast<std::size_t>(n) * nprocs : 0);
+    MPI_Gather(values.data(), n, MPI_DOUBLE, gathered.data(), n, MPI_DOUBLE, 0, comm);
+
+    if (me == 0)
+    {
+        for (int r = 1; r < nprocs; ++r)
+            for (int k = 0; k < n; ++k)
+                values[k] += gathered[static_cast<std::size_t>(r) * n + k];
+    }
+    MPI_Bcast(values.data(), n, MPI_DOUBLE, 0, comm);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,30 @@
+#ifndef MPI_RANKS_HPP
+#define MPI_RANKS_HPP
+
+#include "ranks.hpp"
+
+#include <mpi.h>
+
+///
+/// @class Mpi_ranks
+/// @brief The processes of an MPI communicator as Ranks.
+///
+class Mpi_ranks : public Ranks
+{
+public:
+    explicit Mpi_ranks(MPI_Comm comm = MPI_COMM_WORLD);
+
+private:
+    MPI_Comm comm;
+    int me = 0;
+    int nprocs = 1;
+
+    int this_rank() const override { return me; }
+    int nranks() const override { return nprocs; }
+
+    /// @brief Gathers the values of every rank on rank 0, adds them in rank
+    /// order and broadcasts the sum.
+    void sum_over_ranks(std::span<double> values) const override;
+};
+
+#endif // MPI_RANKS_HPP
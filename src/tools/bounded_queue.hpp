@@ -0,0 +1,73 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <condition_variable>
+
+///
+/// @class Bounded_queue
+/// @brief Fixed-capacity FIFO connecting the threads of a pipeline.
+///
+/// push() blocks while the queue is full and pop() while it is empty, so a
+/// fast producer cannot run ahead of its consumer by more than the capacity.
+/// close() wakes every waiting thread: later pushes are dropped and pop()
+/// returns std::nullopt once the remaining items are drained.
+///
+template <typename T>
+class Bounded_queue
+{
+public:
+  /// Constructor
+  explicit Bounded_queue(std::size_t capacity) : capacity(capacity) {}
+
+  /// @brief Adds an item, waiting for room. Returns false if the queue was closed.
+  bool push(T item)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [&]
+                  { return closed || items.size() < capacity; });
+    if (closed)
+      return false;
+
+    items.push_back(std::move(item));
+    not_empty.notify_one();
+    return true;
+  }
+
+  /// @brief Takes the oldest item, waiting for one. Returns std::nullopt when closed and empty.
+  std::optional<T> pop()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [&]
+                   { return closed || !items.empty(); });
+    if (items.empty())
+      return std::nullopt;
+
+    T item = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return item;
+  }
+
+  /// @brief Marks the end of the stream (or an abort) and wakes all waiting threads.
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+    not_full.notify_all();
+  }
+
+private:
+  std::size_t capacity;
+  std::deque<T> items;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+};
+
+#endif // BOUNDED_QUEUE_HPP
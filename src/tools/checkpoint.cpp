@@ -0,0 +1,140 @@
+#include "checkpoint.hpp"
+
+#include <csignal>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+
+namespace
+{
+    constexpr char magic[4] = {'F', 'L', 'C', 'K'};
+    constexpr std::uint32_t version = 1;
+
+    volatile std::sig_atomic_t stop_requested = 0;
+
+    void request_stop(int)
+    {
+        stop_requested = 1;
+    }
+
+    template <typename T>
+    void write_value(std::ofstream &file, const T &value)
+    {
+        file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool read_value(std::ifstream &file, T &value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Constructor for Checkpoint.
+///
+Checkpoint::Checkpoint(const std::string &filepath, std::uint64_t fingerprint, std::size_t nrows, std::size_t nvalues,
+                       double interval)
+    : values(nvalues, 0.0), filepath(filepath), fingerprint(fingerprint), nrows(nrows), interval(interval),
+      last_save(std::chrono::steady_clock::now())
+{
+    stop_requested = 0;
+    previous_term = std::signal(SIGTERM, request_stop);
+    previous_int = std::signal(SIGINT, request_stop);
+}
+//----------------------------------------------------------------------
+Checkpoint::~Checkpoint()
+{
+    std::signal(SIGTERM, previous_term == SIG_ERR ? SIG_DFL : previous_term);
+    std::signal(SIGINT, previous_int == SIG_ERR ? SIG_DFL : previous_int);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Loads the progress saved for the same fingerprint, rows and sums.
+///
+bool Checkpoint::load()
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file)
+        return false;
+
+    char file_magic[4];
+    std::uint32_t file_version = 0;
+    std::uint64_t file_fingerprint = 0, file_nrows = 0, file_rows_done = 0, file_nvalues = 0;
+
+    if (!file.read(file_magic, 4) || std::memcmp(file_magic, magic, 4) != 0 ||
+        !read_value(file, file_version) || file_version != version ||
+        !read_value(file, file_fingerprint) || !read_value(file, file_nrows) ||
+        !read_value(file, file_rows_done) || !read_value(file, file_nvalues))
+        return false;
+
+    if (file_fingerprint != fingerprint || file_nrows != nrows || file_nvalues != values.size() ||
+        file_rows_done > nrows)
+        return false;
+
+    std::vector<double> file_values(file_nvalues);
+    if (!file.read(reinterpret_cast<char *>(file_values.data()), file_nvalues * sizeof(double)))
+        throw std::runtime_error("Truncated checkpoint file: " + filepath);
+
+    rows_done = rows_resumed = file_rows_done;
+    values = std::move(file_values);
+    return true;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Records progress; saves when the interval has passed or a stop was requested.
+///
+void Checkpoint::update(std::size_t rows, std::span<const double> sums)
+{
+    if (sums.size() != values.size())
+        throw std::invalid_argument("Checkpoint sums do not match the number of values.");
+
+    rows_done = rows;
+    std::copy(sums.begin(), sums.end(), values.begin());
+
+    const auto now = std::chrono::steady_clock::now();
+    if (stop_requested || std::chrono::duration<double>(now - last_save).count() >= interval)
+        save();
+
+    if (stop_requested)
+        throw std::runtime_error("Stopped by a signal; " + std::to_string(rows_done) + " of " + std::to_string(nrows) +
+                                 " rows saved to checkpoint file " + filepath + ".");
+}
+//----------------------------------------------------------------------
+///
+/// @brief Writes the progress through a temporary file renamed at the end, so
+/// a run killed while writing keeps the previous checkpoint.
+///
+void Checkpoint::save()
+{
+    const std::string temporary = filepath + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Could not write checkpoint file: " + temporary);
+
+        file.write(magic, 4);
+        write_value(file, version);
+        write_value(file, fingerprint);
+        write_value(file, static_cast<std::uint64_t>(nrows));
+        write_value(file, static_cast<std::uint64_t>(rows_done));
+        write_value(file, static_cast<std::uint64_t>(values.size()));
+        file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(double));
+
+        if (!file.flush())
+            throw std::runtime_error("Could not write checkpoint file: " + temporary);
+    }
+    std::filesystem::rename(temporary, filepath);
+
+    last_save = std::chrono::steady_clock::now();
+    ++saves;
+}
+//----------------------------------------------------------------------
+void Checkpoint::remove() const
+{
+    std::error_code error;
+    std::filesystem::remove(filepath, error);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,67 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <span>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+///
+/// @class Checkpoint
+/// @brief Progress of a sum over rows (e.g. acceptor points) saved to a small
+/// binary file, so that a preempted run can resume where it stopped.
+///
+/// The file holds the number of completed rows, the partial sums over them
+/// and a fingerprint of the input; a file with another fingerprint or row
+/// count is ignored. Progress is saved at most once per interval, and also
+/// when the process receives SIGTERM or SIGINT (batch preemption, Ctrl-C),
+/// after which update() throws.
+///
+class Checkpoint
+{
+public:
+    /// @brief Checkpoint of nrows rows and nvalues partial sums, saved to
+    /// @p filepath every @p interval seconds. Installs the signal handlers.
+    Checkpoint(const std::string &filepath, std::uint64_t fingerprint, std::size_t nrows, std::size_t nvalues,
+               double interval);
+
+    /// @brief Restores the previous signal handlers.
+    ~Checkpoint();
+
+    Checkpoint(const Checkpoint &) = delete;
+    Checkpoint &operator=(const Checkpoint &) = delete;
+
+    /// @brief Loads the progress of a file written for the same input. Returns
+    /// false if the file is missing or belongs to another input.
+    bool load();
+
+    /// @brief Records that the first @p rows rows are done with partial sums
+    /// @p sums; saves if the interval has passed. Throws after saving if a
+    /// termination signal was received.
+    void update(std::size_t rows, std::span<const double> sums);
+
+    /// @brief Writes the progress (the file is replaced atomically).
+    void save();
+
+    /// @brief Deletes the file once the sum is complete.
+    void remove() const;
+
+    std::size_t rows_done = 0;    ///< Completed rows
+    std::vector<double> values;   ///< Partial sums over the completed rows
+    std::size_t rows_resumed = 0; ///< Rows restored by load()
+    int saves = 0;                ///< Files written in this run
+
+private:
+    std::string filepath;
+    std::uint64_t fingerprint = 0;
+    std::size_t nrows = 0;
+    double interval = 0.0;
+    std::chrono::steady_clock::time_point last_save;
+
+    void (*previous_term)(int) = nullptr;
+    void (*previous_int)(int) = nullptr;
+};
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,35 @@
+#ifndef COMPENSATED_SUM_HPP
+#define COMPENSATED_SUM_HPP
+
+#include <cmath>
+
+///
+/// @brief Neumaier (improved Kahan) summation: the rounding error of every
+/// addition is kept in a separate term, so long sums of values of either sign
+/// stay accurate to a few ulps of the result.
+///
+/// The update has no branch, so independent sums (e.g. the lanes of a strided
+/// loop) can be vectorized by the compiler.
+///
+struct Compensated_sum
+{
+  double sum = 0.0;
+  double error = 0.0;
+
+  void add(double value)
+  {
+    const double t = sum + value;
+    error += std::abs(sum) >= std::abs(value) ? (sum - t) + value : (value - t) + sum;
+    sum = t;
+  }
+
+  void add(const Compensated_sum &other)
+  {
+    add(other.sum);
+    error += other.error;
+  }
+
+  double value() const { return sum + error; }
+};
+
+#endif // COMPENSATED_SUM_HPP
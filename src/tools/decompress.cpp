@@ -0,0 +1,545 @@
+#include "decompress.hpp"
+#include "parameters.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef FRETLAB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef FRETLAB_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef FRETLAB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+    struct File_closer
+    {
+        void operator()(std::FILE *file) const { std::fclose(file); }
+    };
+    using File = std::unique_ptr<std::FILE, File_closer>;
+
+    File open_file(const std::string &path)
+    {
+        File file(std::fopen(path.c_str(), "rb"));
+        if (!file)
+        {
+            throw std::runtime_error("File: " + path + " not found.");
+        }
+        return file;
+    }
+    //----------------------------------------------------------------------
+    ///
+    /// @brief Plain files: bytes as they are.
+    ///
+    class Plain_decoder : public Decoder
+    {
+    public:
+        explicit Plain_decoder(File f) : file(std::move(f)) {}
+
+        std::size_t read(char *out, std::size_t size) override
+        {
+            return std::fread(out, 1, size, file.get());
+        }
+
+    private:
+        File file;
+    };
+    //----------------------------------------------------------------------
+    ///
+    /// @brief Compressed input read from the file in blocks.
+    ///
+    class Compressed_input
+    {
+    protected:
+        Compressed_input(File f, const std::string &p)
+            : file(std::move(f)), path(p), in(Parameters::read_buffer_size) {}
+
+        /// @brief Reads the next block; sets at_eof when the file is exhausted.
+        std::size_t fill()
+        {
+            const std::size_t n = std::fread(in.data(), 1, in.size(), file.get());
+            if (n == 0)
+            {
+                if (std::ferror(file.get()))
+                {
+                    throw std::runtime_error("Could not read file: " + path);
+                }
+                at_eof = true;
+            }
+            return n;
+        }
+
+        [[noreturn]] void fail(const std::string &what) const
+        {
+            throw std::runtime_error("Compressed file " + path + ": " + what);
+        }
+
+        File file;
+        std::string path;
+        std::vector<unsigned char> in;
+        bool at_eof = false;
+    };
+    //----------------------------------------------------------------------
+#ifdef FRETLAB_HAVE_ZLIB
+    ///
+    /// @brief gzip, including concatenated members (pigz, bgzip).
+    ///
+    class Gzip_decoder : public Decoder, Compressed_input
+    {
+    public:
+        Gzip_decoder(File f, const std::string &p) : Compressed_input(std::move(f), p)
+        {
+            // 15 + 32: largest window, gzip or zlib header detected automatically
+            if (inflateInit2(&stream, 15 + 32) != Z_OK)
+            {
+                fail("could not initialize zlib");
+            }
+        }
+
+        ~Gzip_decoder() override { inflateEnd(&stream); }
+
+        std::size_t read(char *out, std::size_t size) override
+        {
+            stream.next_out = reinterpret_cast<Bytef *>(out);
+            stream.avail_out = static_cast<uInt>(std::min<std::size_t>(size, 1u << 30));
+            const uInt requested = stream.avail_out;
+
+            while (stream.avail_out > 0)
+            {
+                if (stream.avail_in == 0 && !at_eof)
+                {
+                    stream.avail_in = static_cast<uInt>(fill());
+                    stream.next_in = in.data();
+                }
+                if (stream.avail_in == 0 && at_eof && !in_member)
+                {
+                    break;
+                }
+
+                const uInt before = stream.avail_out;
+                const int status = inflate(&stream, Z_NO_FLUSH);
+                if (status == Z_STREAM_END)
+                {
+                    // A further member may follow
+                    inflateReset(&stream);
+                    in_member = false;
+                    continue;
+                }
+                if (status == Z_BUF_ERROR && at_eof && stream.avail_in == 0 && stream.avail_out == before)
+                {
+                    fail("unexpected end of data");
+                }
+                if (status != Z_OK && status != Z_BUF_ERROR)
+                {
+                    fail(stream.msg != nullptr ? stream.msg : "corrupt gzip data");
+                }
+                in_member = true;
+            }
+            return requested - stream.avail_out;
+        }
+
+    private:
+        z_stream stream{};
+        bool in_member = false;
+    };
+#endif
+    //----------------------------------------------------------------------
+#ifdef FRETLAB_HAVE_LZMA
+    ///
+    /// @brief xz, including concatenated streams.
+    ///
+    class Xz_decoder : public Decoder, Compressed_input
+    {
+    public:
+        Xz_decoder(File f, const std::string &p) : Compressed_input(std::move(f), p)
+        {
+            if (lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+            {
+                fail("could not initialize liblzma");
+            }
+        }
+
+        ~Xz_decoder() override { lzma_end(&stream); }
+
+        std::size_t read(char *out, std::size_t size) override
+        {
+            stream.next_out = reinterpret_cast<uint8_t *>(out);
+            stream.avail_out = size;
+
+            while (stream.avail_out > 0 && !finished)
+            {
+                if (stream.avail_in == 0 && !at_eof)
+                {
+                    stream.avail_in = fill();
+                    stream.next_in = in.data();
+                }
+
+                const lzma_ret status = lzma_code(&stream, at_eof ? LZMA_FINISH : LZMA_RUN);
+                if (status == LZMA_STREAM_END)
+                {
+                    finished = true;
+                }
+                else if (status == LZMA_BUF_ERROR)
+                {
+                    fail("unexpected end of data");
+                }
+                else if (status != LZMA_OK)
+                {
+                    fail("corrupt xz data (liblzma error " + std::to_string(status) + ")");
+                }
+            }
+            return size - stream.avail_out;
+        }
+
+    private:
+        lzma_stream stream = LZMA_STREAM_INIT;
+        bool finished = false;
+    };
+#endif
+    //----------------------------------------------------------------------
+#ifdef FRETLAB_HAVE_ZSTD
+    ///
+    /// @brief zstd. Files made of several frames (pzstd, concatenated files)
+    /// are decompressed a batch of frames at a time, the frames of a batch in
+    /// parallel; single-frame files are streamed.
+    ///
+    class Zstd_decoder : public Decoder
+    {
+    public:
+        Zstd_decoder(File f, const std::string &p) : path(p)
+        {
+            // The compressed file is kept in memory to locate the frames
+            std::FILE *file = f.get();
+            std::vector<char> chunk(Parameters::read_buffer_size);
+            std::size_t n = 0;
+            while ((n = std::fread(chunk.data(), 1, chunk.size(), file)) > 0)
+            {
+                compressed.insert(compressed.end(), chunk.begin(), chunk.begin() + n);
+            }
+            if (std::ferror(file))
+            {
+                throw std::runtime_error("Could not read file: " + path);
+            }
+
+            for (std::size_t pos = 0; pos < compressed.size();)
+            {
+                const std::size_t frame = ZSTD_findFrameCompressedSize(compressed.data() + pos, compressed.size() - pos);
+                if (ZSTD_isError(frame))
+                {
+                    fail(ZSTD_getErrorName(frame));
+                }
+                frames.push_back({pos, frame});
+                pos += frame;
+            }
+
+            context = ZSTD_createDCtx();
+            if (context == nullptr)
+            {
+                fail("could not initialize libzstd");
+            }
+            streamed = frames.size() < 2 || omp_get_max_threads() < 2;
+            input = {compressed.data(), compressed.size(), 0};
+        }
+
+        ~Zstd_decoder() override { ZSTD_freeDCtx(context); }
+
+        std::size_t read(char *out, std::size_t size) override
+        {
+            return streamed ? read_stream(out, size) : read_batches(out, size);
+        }
+
+    private:
+        struct Frame
+        {
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        [[noreturn]] void fail(const std::string &what) const
+        {
+            throw std::runtime_error("Compressed file " + path + ": " + what);
+        }
+
+        std::size_t read_stream(char *out, std::size_t size)
+        {
+            ZSTD_outBuffer output = {out, size, 0};
+            while (output.pos < output.size)
+            {
+                const std::size_t in_before = input.pos;
+                const std::size_t out_before = output.pos;
+                const std::size_t status = ZSTD_decompressStream(context, &output, &input);
+                if (ZSTD_isError(status))
+                {
+                    fail(ZSTD_getErrorName(status));
+                }
+                if (input.pos == in_before && output.pos == out_before)
+                {
+                    break;
+                }
+                // 0: the frame is complete and flushed
+                frame_open = status != 0;
+            }
+            if (output.pos == 0 && frame_open)
+            {
+                fail("unexpected end of data");
+            }
+            return output.pos;
+        }
+
+        std::size_t read_batches(char *out, std::size_t size)
+        {
+            std::size_t written = 0;
+            while (written < size)
+            {
+                if (current == batch.size())
+                {
+                    if (next_frame == frames.size() || !decode_batch())
+                    {
+                        break;
+                    }
+                }
+                const std::string &data = batch[current];
+                const std::size_t n = std::min(size - written, data.size() - offset);
+                std::memcpy(out + written, data.data() + offset, n);
+                written += n;
+                offset += n;
+                if (offset == data.size())
+                {
+                    ++current;
+                    offset = 0;
+                }
+            }
+            return written;
+        }
+
+        /// @brief Decompresses the next frames, two per thread, in parallel.
+        bool decode_batch()
+        {
+            const std::size_t count = std::min<std::size_t>(2 * omp_get_max_threads(), frames.size() - next_frame);
+            batch.assign(count, std::string());
+            std::vector<std::string> errors(count);
+
+#pragma omp parallel for schedule(dynamic)
+            for (long long k = 0; k < static_cast<long long>(count); ++k)
+            {
+                errors[k] = decode_frame(frames[next_frame + k], batch[k]);
+            }
+
+            for (const auto &error : errors)
+            {
+                if (!error.empty())
+                {
+                    fail(error);
+                }
+            }
+            next_frame += count;
+            current = 0;
+            offset = 0;
+            return true;
+        }
+
+        /// @brief Decompresses one frame; returns an error message, empty on success.
+        std::string decode_frame(const Frame &frame, std::string &data) const
+        {
+            const char *src = compressed.data() + frame.offset;
+            ZSTD_DCtx *ctx = ZSTD_createDCtx();
+            if (ctx == nullptr)
+            {
+                return "could not initialize libzstd";
+            }
+
+            std::string error;
+            const unsigned long long content = ZSTD_getFrameContentSize(src, frame.size);
+            if (content == ZSTD_CONTENTSIZE_ERROR)
+            {
+                error = "corrupt zstd frame";
+            }
+            else if (content != ZSTD_CONTENTSIZE_UNKNOWN)
+            {
+                data.resize(content);
+                const std::size_t n = ZSTD_decompressDCtx(ctx, data.data(), data.size(), src, frame.size);
+                if (ZSTD_isError(n))
+                {
+                    error = ZSTD_getErrorName(n);
+                }
+            }
+            else
+            {
+                // Size not stored in the frame header: stream it
+                ZSTD_inBuffer in = {src, frame.size, 0};
+                std::vector<char> chunk(ZSTD_DStreamOutSize());
+                std::size_t status = 1;
+                while (status != 0 && error.empty())
+                {
+                    ZSTD_outBuffer chunk_out = {chunk.data(), chunk.size(), 0};
+                    status = ZSTD_decompressStream(ctx, &chunk_out, &in);
+                    if (ZSTD_isError(status))
+                    {
+                        error = ZSTD_getErrorName(status);
+                    }
+                    else if (chunk_out.pos == 0 && in.pos == in.size && status != 0)
+                    {
+                        error = "unexpected end of data";
+                    }
+                    else
+                    {
+                        data.append(chunk.data(), chunk_out.pos);
+                    }
+                }
+            }
+
+            ZSTD_freeDCtx(ctx);
+            return error;
+        }
+
+        std::string path;
+        std::vector<char> compressed;
+        std::vector<Frame> frames;
+        bool streamed = true;
+
+        // Streaming
+        ZSTD_DCtx *context = nullptr;
+        ZSTD_inBuffer input{};
+        bool frame_open = false;
+
+        // Batches of frames
+        std::vector<std::string> batch;
+        std::size_t next_frame = 0;
+        std::size_t current = 0;
+        std::size_t offset = 0;
+    };
+#endif
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Compression format from the magic bytes at the start of the data.
+///
+Compression detect_compression(std::string_view head)
+{
+    auto starts_with = [&](std::initializer_list<unsigned char> magic)
+    {
+        return head.size() >= magic.size() &&
+               std::equal(magic.begin(), magic.end(), head.begin(),
+                          [](unsigned char m, char c) { return m == static_cast<unsigned char>(c); });
+    };
+
+    if (starts_with({0x1f, 0x8b}))
+        return Compression::Gzip;
+    if (starts_with({0x28, 0xb5, 0x2f, 0xfd}))
+        return Compression::Zstd;
+    if (starts_with({0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00}))
+        return Compression::Xz;
+    return Compression::None;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Compression format of a file, from its first six bytes.
+///
+Compression detect_compression(const std::string &path)
+{
+    File file = open_file(path);
+    char head[6];
+    const std::size_t n = std::fread(head, 1, sizeof(head), file.get());
+    return detect_compression(std::string_view(head, n));
+}
+//----------------------------------------------------------------------
+std::string compression_name(Compression compression)
+{
+    switch (compression)
+    {
+    case Compression::Gzip:
+        return "gzip";
+    case Compression::Zstd:
+        return "zstd";
+    case Compression::Xz:
+        return "xz";
+    default:
+        return "none";
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Opens the file and picks the decoder of its format.
+///
+std::unique_ptr<Decoder> open_decoder(const std::string &path)
+{
+    const Compression compression = detect_compression(path);
+    File file = open_file(path);
+
+    switch (compression)
+    {
+    case Compression::None:
+        return std::make_unique<Plain_decoder>(std::move(file));
+#ifdef FRETLAB_HAVE_ZLIB
+    case Compression::Gzip:
+        return std::make_unique<Gzip_decoder>(std::move(file), path);
+#endif
+#ifdef FRETLAB_HAVE_LZMA
+    case Compression::Xz:
+        return std::make_unique<Xz_decoder>(std::move(file), path);
+#endif
+#ifdef FRETLAB_HAVE_ZSTD
+    case Compression::Zstd:
+        return std::make_unique<Zstd_decoder>(std::move(file), path);
+#endif
+    default:
+        throw std::runtime_error("File " + path + " is " + compression_name(compression) +
+                                 "-compressed, but FretLab was built without " +
+                                 compression_name(compression) + " support.");
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Reads a whole file through its decoder.
+///
+std::string read_decompressed(const std::string &path)
+{
+    std::unique_ptr<Decoder> decoder = open_decoder(path);
+    std::string text;
+    std::size_t n = 0;
+    do
+    {
+        const std::size_t size = text.size();
+        text.resize(size + Parameters::read_buffer_size);
+        n = decoder->read(text.data() + size, Parameters::read_buffer_size);
+        text.resize(size + n);
+    } while (n > 0);
+    return text;
+}
+//----------------------------------------------------------------------
+Input_file::Input_file(const std::string &path) : std::istream(nullptr), buffer(path)
+{
+    rdbuf(&buffer);
+    // Decoding errors are rethrown instead of looking like the end of the file
+    exceptions(std::ios::badbit);
+}
+//----------------------------------------------------------------------
+Input_file::Buffer::Buffer(const std::string &path)
+    : decoder(open_decoder(path)), block(Parameters::read_buffer_size) {}
+//----------------------------------------------------------------------
+///
+/// @brief Refills the get area with the next decompressed block.
+///
+Input_file::Buffer::int_type Input_file::Buffer::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+    const std::size_t n = decoder->read(block.data(), block.size());
+    if (n == 0)
+    {
+        return traits_type::eof();
+    }
+    setg(block.data(), block.data(), block.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+//----------------------------------------------------------------------
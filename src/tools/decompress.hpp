@@ -0,0 +1,87 @@
+#ifndef DECOMPRESS_HPP
+#define DECOMPRESS_HPP
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+/// @brief Transparent decompression of input files.
+///
+/// Compressed files are recognized by their first bytes, not by their name:
+/// gzip (1f 8b), zstd (28 b5 2f fd) and xz (fd 37 7a 58 5a 00). Formats whose
+/// library was not found at build time are still recognized, and rejected
+/// with an error naming the format.
+
+enum class Compression
+{
+    None,
+    Gzip,
+    Zstd,
+    Xz
+};
+
+/// @brief Compression of data starting with @p head (at least 6 bytes for xz).
+Compression detect_compression(std::string_view head);
+
+/// @brief Compression of the file at @p path. Throws if it cannot be opened.
+Compression detect_compression(const std::string &path);
+
+/// @brief Name of a format: "none", "gzip", "zstd" or "xz".
+std::string compression_name(Compression compression);
+
+///
+/// @class Decoder
+/// @brief Source of the (decompressed) bytes of one file.
+///
+class Decoder
+{
+public:
+    virtual ~Decoder() = default;
+
+    /// @brief Writes up to @p size bytes to @p out; returns 0 at the end of the data.
+    virtual std::size_t read(char *out, std::size_t size) = 0;
+};
+
+/// @brief Decoder for the file at @p path, plain files included. Throws if
+/// it cannot be opened or its format is not supported by this build.
+std::unique_ptr<Decoder> open_decoder(const std::string &path);
+
+/// @brief Whole decompressed contents of the file at @p path.
+std::string read_decompressed(const std::string &path);
+
+///
+/// @class Input_file
+/// @brief Input stream over a plain or compressed file.
+///
+/// Drop-in replacement of std::ifstream for parsers: the data is decompressed
+/// block by block (Parameters::read_buffer_size) while it is parsed, so
+/// compressed inputs never need a decompressed copy on disk or in memory.
+///
+class Input_file : public std::istream
+{
+public:
+    /// @brief Opens the file at @p path. Throws like open_decoder.
+    explicit Input_file(const std::string &path);
+
+private:
+    class Buffer : public std::streambuf
+    {
+    public:
+        explicit Buffer(const std::string &path);
+
+    protected:
+        int_type underflow() override;
+
+    private:
+        std::unique_ptr<Decoder> decoder;
+        std::vector<char> block;
+    };
+
+    Buffer buffer;
+};
+
+#endif // DECOMPRESS_HPP
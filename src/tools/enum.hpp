@@ -7,7 +7,28 @@ enum class TargetMode {
     IntegrateCube,    ///< Electron density integration
     Acceptor_Donor,   ///< Acceptor-Donor coulomb (optional: overlap integral)
     Acceptor_NP,      ///< Acceptor + Nanoparticle coulomb
-    Acceptor_NP_Donor ///< Acceptor-Donor + Nanoparticle coulomb (optional: overlap integral)
+    Acceptor_NP_Donor, ///< Acceptor-Donor + Nanoparticle coulomb (optional: overlap integral)
+    Aggregate         ///< Coulomb coupling matrix among N chromophores
+};
+
+/// @brief Partition of an integrated density among the atoms of the cube
+enum class AtomicPartition {
+    None,             ///< Total integral only
+    Voronoi,          ///< Every voxel belongs to its nearest atom
+    Becke             ///< Becke fuzzy cells
+};
+
+/// @brief Amount of detail in the .log file
+enum class Verbosity {
+    Minimal,          ///< Counts instead of per-atom and per-site listings
+    Normal            ///< Every atom and nanoparticle site listed
+};
+
+/// @brief Machine-readable results written next to the .log file
+enum class ResultsFormat {
+    None,             ///< Only the .log file
+    Json,             ///< <input>.json
+    Binary            ///< <input>.bin (layout in results_record.hpp)
 };
 
 #endif // ENUMS_HPP
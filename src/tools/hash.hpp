@@ -0,0 +1,23 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+///
+/// @brief FNV-1a hash of a byte range, continuing from hash.
+///
+/// Used to fingerprint file contents and cached data; not cryptographic.
+///
+inline std::uint64_t fnv1a(const void *data, std::size_t size, std::uint64_t hash = 14695981039346656037ull)
+{
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+#endif // HASH_HPP
@@ -0,0 +1,119 @@
+#include "linear_algebra.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#ifdef FRETLAB_HAVE_BLAS
+extern "C" void dgemm_(const char *transa, const char *transb, const int *m, const int *n, const int *k,
+                       const double *alpha, const double *A, const int *lda, const double *B, const int *ldb,
+                       const double *beta, double *C, const int *ldc);
+#endif
+
+//----------------------------------------------------------------------
+///
+/// @brief Column-major matrix product (BLAS dgemm semantics).
+///
+void gemm(char transa, char transb, int m, int n, int k,
+          double alpha, const double *A, int lda, const double *B, int ldb,
+          double beta, double *C, int ldc)
+{
+#ifdef FRETLAB_HAVE_BLAS
+    dgemm_(&transa, &transb, &m, &n, &k, &alpha, A, &lda, B, &ldb, &beta, C, &ldc);
+#else
+    const bool ta = std::toupper(transa) == 'T';
+    const bool tb = std::toupper(transb) == 'T';
+
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < m; ++i)
+        {
+            double sum = 0.0;
+            for (int l = 0; l < k; ++l)
+            {
+                const double a = ta ? A[l + i * lda] : A[i + l * lda];
+                const double b = tb ? B[j + l * ldb] : B[l + j * ldb];
+                sum += a * b;
+            }
+            C[i + j * ldc] = alpha * sum + (beta == 0.0 ? 0.0 : beta * C[i + j * ldc]);
+        }
+    }
+#endif
+}
+//----------------------------------------------------------------------
+///
+/// @brief Eigen decomposition of a small symmetric matrix (cyclic Jacobi).
+///
+/// Meant for the few-by-few matrices of geometry fits, where a LAPACK call
+/// would cost more than the work itself.
+///
+void symmetric_eigen(int n, std::vector<double> &A, std::vector<double> &eigenvalues, std::vector<double> &eigenvectors)
+{
+    std::vector<double> V(n * n, 0.0);
+    for (int i = 0; i < n; ++i)
+        V[i + i * n] = 1.0;
+
+    for (int sweep = 0; sweep < 100; ++sweep)
+    {
+        double off = 0.0;
+        for (int q = 1; q < n; ++q)
+            for (int p = 0; p < q; ++p)
+                off += A[p + q * n] * A[p + q * n];
+        if (off < 1.0e-30)
+            break;
+
+        for (int q = 1; q < n; ++q)
+        {
+            for (int p = 0; p < q; ++p)
+            {
+                const double apq = A[p + q * n];
+                if (apq == 0.0)
+                    continue;
+
+                // Rotation angle that zeroes A(p, q)
+                const double theta = (A[q + q * n] - A[p + p * n]) / (2.0 * apq);
+                const double t = std::copysign(1.0, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(t * t + 1.0);
+                const double s = t * c;
+
+                for (int k = 0; k < n; ++k)
+                {
+                    const double akp = A[k + p * n];
+                    const double akq = A[k + q * n];
+                    A[k + p * n] = c * akp - s * akq;
+                    A[k + q * n] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; ++k)
+                {
+                    const double apk = A[p + k * n];
+                    const double aqk = A[q + k * n];
+                    A[p + k * n] = c * apk - s * aqk;
+                    A[q + k * n] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; ++k)
+                {
+                    const double vkp = V[k + p * n];
+                    const double vkq = V[k + q * n];
+                    V[k + p * n] = c * vkp - s * vkq;
+                    V[k + q * n] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    // Sort by ascending eigenvalue
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b)
+              { return A[a + a * n] < A[b + b * n]; });
+
+    eigenvalues.resize(n);
+    eigenvectors.resize(n * n);
+    for (int k = 0; k < n; ++k)
+    {
+        eigenvalues[k] = A[order[k] + order[k] * n];
+        for (int i = 0; i < n; ++i)
+            eigenvectors[i + k * n] = V[i + order[k] * n];
+    }
+}
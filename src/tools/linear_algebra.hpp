@@ -0,0 +1,27 @@
+#ifndef LINEAR_ALGEBRA_HPP
+#define LINEAR_ALGEBRA_HPP
+
+#include <vector>
+
+///
+/// @brief Column-major matrix product C = alpha * op(A) * op(B) + beta * C.
+///
+/// Same arguments as the BLAS routine dgemm (op = 'N' or 'T'). Calls the
+/// BLAS library found by ConfigMath when available (FRETLAB_HAVE_BLAS), and a
+/// plain loop implementation otherwise.
+///
+void gemm(char transa, char transb, int m, int n, int k,
+          double alpha, const double *A, int lda, const double *B, int ldb,
+          double beta, double *C, int ldc);
+
+///
+/// @brief Eigen decomposition of a small symmetric matrix (cyclic Jacobi).
+///
+/// @param n Matrix order.
+/// @param A Column-major n x n matrix, overwritten.
+/// @param eigenvalues Output, n values in ascending order.
+/// @param eigenvectors Output, column-major n x n, column k belongs to eigenvalues[k].
+///
+void symmetric_eigen(int n, std::vector<double> &A, std::vector<double> &eigenvalues, std::vector<double> &eigenvectors);
+
+#endif // LINEAR_ALGEBRA_HPP
@@ -0,0 +1,69 @@
+#include "mapped_file.hpp"
+#include "decompress.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------
+///
+/// @brief Opens and maps the file read-only. The descriptor is closed right
+/// after mapping; the mapping stays valid until destruction.
+///
+Mapped_file::Mapped_file(const std::string &path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("File: " + path + " not found.");
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not stat file: " + path);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+
+    if (size > 0)
+    {
+        void *ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Could not map file: " + path);
+        }
+        // The file is scanned front to back once
+        ::madvise(ptr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(ptr);
+        mapping = ptr;
+        mapping_size = size;
+    }
+
+    ::close(fd);
+
+    if (detect_compression(view()) != Compression::None)
+    {
+        ::munmap(mapping, mapping_size);
+        mapping = nullptr;
+        decompressed = read_decompressed(path);
+        data = decompressed.data();
+        size = decompressed.size();
+    }
+}
+//----------------------------------------------------------------------
+///
+/// @brief Releases the mapping.
+///
+Mapped_file::~Mapped_file()
+{
+    if (mapping != nullptr)
+    {
+        ::munmap(mapping, mapping_size);
+    }
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+///
+/// @class Mapped_file
+/// @brief Read-only memory mapping of a whole file.
+///
+/// The file contents are exposed as a std::string_view, so large text files
+/// can be searched and parsed in place without copying them through a stream.
+/// Compressed files (see decompress.hpp) are decompressed into memory instead.
+///
+class Mapped_file
+{
+public:
+    /// @brief Maps the file at @p path. Throws if it cannot be opened or mapped.
+    explicit Mapped_file(const std::string &path);
+
+    ~Mapped_file();
+
+    Mapped_file(const Mapped_file &) = delete;
+    Mapped_file &operator=(const Mapped_file &) = delete;
+
+    /// @brief Returns the mapped (or decompressed) contents of the file.
+    std::string_view view() const { return {data, size}; }
+
+private:
+    const char *data = nullptr; ///< Start of the contents (nullptr for empty files)
+    std::size_t size = 0;       ///< Size of the contents in bytes
+    void *mapping = nullptr;    ///< Mapping to release (nullptr for compressed files)
+    std::size_t mapping_size = 0;
+    std::string decompressed;   ///< Contents of a compressed file
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,174 @@
+#include "numa.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+#ifdef __linux__
+  ///
+  /// @brief CPUs in a CPU set, in increasing order.
+  ///
+  std::vector<int> cpu_list(const cpu_set_t &set)
+  {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+    return cpus;
+  }
+#endif
+  //----------------------------------------------------------------------
+  ///
+  /// @brief NUMA node of a CPU, from /sys/devices/system/cpu/cpuN/nodeM (-1 if unknown).
+  ///
+  int cpu_node(int cpu)
+  {
+    std::error_code error;
+    const fs::path dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    for (const auto &entry : fs::directory_iterator(dir, error))
+    {
+      const std::string name = entry.path().filename().string();
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+          std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        return std::stoi(name.substr(4));
+    }
+    return -1;
+  }
+  //----------------------------------------------------------------------
+  ///
+  /// @brief Compact list of CPUs, e.g. "0-3,8".
+  ///
+  std::string compact(const std::vector<int> &cpus)
+  {
+    std::string text;
+    for (std::size_t k = 0; k < cpus.size();)
+    {
+      std::size_t end = k;
+      while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1)
+        ++end;
+
+      if (!text.empty())
+        text += ",";
+      text += std::to_string(cpus[k]);
+      if (end > k)
+      {
+        text += '-';
+        text += std::to_string(cpus[end]);
+      }
+      k = end + 1;
+    }
+    return text;
+  }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Binds the OpenMP threads to CPUs with the given policy.
+///
+void bind_threads(const std::string &policy)
+{
+  if (policy != "close" && policy != "spread")
+    throw std::runtime_error("Unknown thread binding '" + policy + "' (use close, spread or none).");
+
+#ifdef __linux__
+  cpu_set_t allowed_set;
+  CPU_ZERO(&allowed_set);
+  if (sched_getaffinity(0, sizeof(allowed_set), &allowed_set) != 0)
+    throw std::runtime_error("Could not read the CPU affinity of the process.");
+
+  const std::vector<int> allowed = cpu_list(allowed_set);
+  bool failed = false;
+
+#pragma omp parallel reduction(|| : failed)
+  {
+    const int nthreads = omp_get_num_threads();
+    const int thread = omp_get_thread_num();
+    const int ncpus = allowed.size();
+
+    const int cpu = (policy == "close") ? allowed[thread % ncpus]
+                                        : allowed[(static_cast<long>(thread) * ncpus / nthreads) % ncpus];
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (thread == 0)
+    {
+      // Master: the whole node of its CPU
+      const int node = cpu_node(cpu);
+      for (const int other : allowed)
+        if (other == cpu || (node >= 0 && cpu_node(other) == node))
+          CPU_SET(other, &set);
+    }
+    else
+    {
+      CPU_SET(cpu, &set);
+    }
+
+    failed = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0;
+  }
+
+  if (failed)
+    throw std::runtime_error("Could not bind the OpenMP threads with policy '" + policy + "'.");
+#else
+  throw std::runtime_error("Thread binding is only supported on Linux.");
+#endif
+}
+//----------------------------------------------------------------------
+///
+/// @brief CPU, NUMA node and allowed CPUs of every OpenMP thread.
+///
+std::vector<Thread_binding> thread_bindings()
+{
+  std::vector<Thread_binding> bindings(omp_get_max_threads());
+  int team = 1;
+
+#pragma omp parallel
+  {
+#pragma omp master
+    team = omp_get_num_threads();
+
+    Thread_binding &binding = bindings[omp_get_thread_num()];
+    binding.thread = omp_get_thread_num();
+
+#ifdef __linux__
+    binding.cpu = sched_getcpu();
+    binding.node = cpu_node(binding.cpu);
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+      binding.allowed = compact(cpu_list(set));
+#endif
+  }
+
+  bindings.resize(team);
+  return bindings;
+}
+//----------------------------------------------------------------------
+///
+/// @brief Number of NUMA nodes listed in /sys/devices/system/node.
+///
+int numa_nodes()
+{
+  int nodes = 0;
+  std::error_code error;
+  for (const auto &entry : fs::directory_iterator("/sys/devices/system/node", error))
+  {
+    const std::string name = entry.path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 && name[4] >= '0' && name[4] <= '9')
+      ++nodes;
+  }
+  return std::max(nodes, 1);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,104 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <omp.h>
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+/// @brief NUMA-aware placement of the point arrays and thread binding.
+///
+/// Linux places a page on the NUMA node of the thread that first writes it.
+/// Point arrays are therefore allocated without value-initialization and
+/// first written by the threads that later read them (same static schedule
+/// as the coupling loops), instead of all landing on the reading thread's node.
+
+///
+/// @brief Allocator that default-initializes new elements: resizing a vector of
+/// doubles does not write (and place) its pages.
+///
+template <typename T, typename A = std::allocator<T>>
+class Default_init_allocator : public A
+{
+  using traits = std::allocator_traits<A>;
+
+public:
+  template <typename U>
+  struct rebind
+  {
+    using other = Default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+  };
+
+  using A::A;
+
+  template <typename U>
+  void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+  {
+    ::new (static_cast<void *>(ptr)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&...args)
+  {
+    traits::construct(static_cast<A &>(*this), ptr, std::forward<Args>(args)...);
+  }
+};
+
+/// @brief Vector whose pages are placed by the first thread writing them.
+template <typename T>
+using First_touch_vector = std::vector<T, Default_init_allocator<T>>;
+
+//----------------------------------------------------------------------
+///
+/// @brief Resizes v to npoints * stride elements and zeroes them in parallel,
+/// point p by the thread that gets p in a static schedule over npoints.
+///
+template <typename T>
+void first_touch(First_touch_vector<T> &v, std::size_t npoints, std::size_t stride = 1)
+{
+  v.clear();
+  v.shrink_to_fit(); // fresh pages, not the ones of a previous density
+  v.resize(npoints * stride);
+
+  const long long n = npoints;
+  T *data = v.data();
+
+#pragma omp parallel for schedule(static)
+  for (long long p = 0; p < n; ++p)
+    for (std::size_t s = 0; s < stride; ++s)
+      data[p * stride + s] = T{};
+}
+//----------------------------------------------------------------------
+
+/// @brief CPU and NUMA node of one OpenMP thread.
+struct Thread_binding
+{
+  int thread = 0;
+  int cpu = -1;          ///< CPU the thread runs on (-1 if unknown)
+  int node = -1;         ///< NUMA node of that CPU (-1 if unknown)
+  std::string allowed;   ///< CPUs the thread may run on, e.g. "0-3,8"
+};
+
+/**
+ * @brief Binds the OpenMP threads to CPUs.
+ * @param policy "close" (consecutive CPUs) or "spread" (evenly over the allowed CPUs).
+ *
+ * Worker threads get one CPU each; the master thread gets all CPUs of the
+ * NUMA node of its CPU, so helper threads it starts (readers) are not
+ * confined to its core. Threads keep their binding for later parallel regions
+ * of the same size.
+ */
+void bind_threads(const std::string &policy);
+
+/// @brief Binding of every thread of a parallel region.
+std::vector<Thread_binding> thread_bindings();
+
+/// @brief Number of NUMA nodes of the machine (1 if unknown).
+int numa_nodes();
+
+#endif // NUMA_HPP
@@ -2,6 +2,7 @@
 #define PARAMETERS_HPP
 
 #include <string>
+#include <cstddef>
 
 // debugpgi
 /// @brief Defines physical constants and header strings used across the application.
@@ -20,6 +21,69 @@ namespace Parameters {
     // Constraint for reduce density file
     constexpr int ncellmax = 10000000;
 
+    // Number of points per side of the tiles used by the coupling matrix kernel
+    constexpr int coupling_tile_size = 256;
+
+    // Aggregates: side of the cells of the chromophore index (Bohr), and default
+    // minimum gap between bounding spheres for the multipole shortcut (Bohr)
+    constexpr double aggregate_cell_size = 2.0;
+    constexpr double aggregate_multipole_distance = 20.0;
+
+    // Trajectories: frames in flight between pipeline stages, and frames
+    // between flushes of the time series
+    constexpr std::size_t trajectory_queue_size = 8;
+    constexpr std::size_t trajectory_flush_frames = 100;
+
+    // Nanoparticle potential maps: base lattice spacing (Bohr), cells per block
+    // side, maximum number of spacing halvings, and default relative tolerance
+    constexpr double potential_map_spacing = 1.0;
+    constexpr int potential_map_block_cells = 8;
+    constexpr int potential_map_max_level = 2;
+    constexpr double potential_map_tolerance = 1.0e-6;
+
+    // Default relative change of the coupling between cutoffs that ends a cutoff sweep
+    constexpr double sweep_tolerance = 1.0e-4;
+
+    // Compressed (H-matrix) operators: points per leaf cluster, admissibility
+    // parameter (min diameter <= eta * distance) and rows sampled to estimate the error
+    constexpr int h_matrix_leaf_size = 64;
+    constexpr double h_matrix_eta = 1.0;
+    constexpr int h_matrix_sample_rows = 64;
+
+    // Maximum coordinate difference between nanoparticle files of a frequency list (Bohr)
+    constexpr double np_geometry_tolerance = 1.0e-6;
+
+    // Checkpointed couplings: chunks of acceptor points between progress
+    // updates, and default interval between checkpoint files (s)
+    constexpr int checkpoint_chunks = 256;
+    constexpr double checkpoint_interval = 600.0;
+
+    // Monte Carlo couplings: cell side (Bohr), cell pairs closer than this many
+    // times the sum of their radii are summed exactly, samples per batch,
+    // batches of the first round, samples allowed per far point pair before
+    // the residual is summed exactly, largest cell pair table, default seed
+    constexpr double monte_carlo_cell_size = 2.0;
+    constexpr double monte_carlo_separation = 3.0;
+    constexpr int monte_carlo_batch = 4096;
+    constexpr int monte_carlo_first_batches = 16;
+    constexpr double monte_carlo_budget = 1.0 / 64.0;
+    constexpr std::size_t monte_carlo_max_cell_pairs = std::size_t(1) << 22;
+    constexpr unsigned long long monte_carlo_seed = 12345;
+
+    // Atomic charges: side of the cells of the atom index (Bohr) and the
+    // Stratmann-Scuseria-Frisch cutoff of the Becke cell function
+    constexpr double partition_cell_size = 4.0;
+    constexpr double becke_cutoff = 0.64;
+
+    // Default interval between lines of the progress heartbeat file (s)
+    constexpr double progress_interval = 60.0;
+
+    // Stream buffer size used when reading input files (bytes)
+    constexpr std::size_t read_buffer_size = 1 << 20;
+
+    // Text buffer size used when writing long listings to the .log file (bytes)
+    constexpr std::size_t write_buffer_size = 1 << 20;
+
     // Header strings (declared here, defined in parameters.cpp)
     extern const std::string acceptor_header;
     extern const std::string donor_header;
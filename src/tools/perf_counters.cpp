@@ -0,0 +1,249 @@
+#include "perf_counters.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /// One perf event and the counted quantity it adds to.
+    struct Event_spec
+    {
+        Perf_counters::Event event;
+        std::uint32_t type;
+        std::uint64_t config;
+        double weight;
+    };
+
+#ifdef __linux__
+    ///
+    /// @brief Events to open. The FP_ARITH_INST_RETIRED encodings (event 0xC7;
+    /// scalar, 128, 256 and 512 bit double) only exist on Intel CPUs.
+    ///
+    std::vector<Event_spec> event_specs()
+    {
+        std::vector<Event_spec> specs = {
+            {Perf_counters::Task_clock, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, 1.0},
+            {Perf_counters::Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1.0},
+            {Perf_counters::Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 1.0},
+            {Perf_counters::Cache_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1.0},
+            {Perf_counters::Branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 1.0},
+        };
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            if (line.rfind("vendor_id", 0) != 0)
+                continue;
+            if (line.find("GenuineIntel") != std::string::npos)
+            {
+                specs.push_back({Perf_counters::Flops, PERF_TYPE_RAW, 0x01C7, 1.0});
+                specs.push_back({Perf_counters::Flops, PERF_TYPE_RAW, 0x04C7, 2.0});
+                specs.push_back({Perf_counters::Flops, PERF_TYPE_RAW, 0x10C7, 4.0});
+                specs.push_back({Perf_counters::Flops, PERF_TYPE_RAW, 0x40C7, 8.0});
+            }
+            break;
+        }
+        return specs;
+    }
+
+    ///
+    /// @brief Opens one user-space counter of the calling thread (-1 on failure, errno set).
+    ///
+    int open_event(const Event_spec &spec, bool inherit)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#else
+    std::vector<Event_spec> event_specs() { return {}; }
+    int open_event(const Event_spec &, bool)
+    {
+        errno = ENOSYS;
+        return -1;
+    }
+#endif
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Checks which events can be opened, then opens them on the OpenMP
+/// threads first and on the calling thread last, so the inherited counters of
+/// the calling thread only cover threads started afterwards.
+///
+Perf_counters::Perf_counters()
+{
+    const auto specs = event_specs();
+    if (specs.empty())
+        unavailable_reason = "perf_event_open is only available on Linux";
+
+    // Probe: an event group (e.g. Flops) is used only if all its events open
+    std::array<bool, nevents> failed{};
+    for (const auto &spec : specs)
+    {
+        const int fd = open_event(spec, false);
+        if (fd < 0)
+        {
+            failed[spec.event] = true;
+            if (spec.event != Flops && unavailable_reason.empty())
+                unavailable_reason = std::strerror(errno);
+            continue;
+        }
+        opened[spec.event] = true;
+#ifdef __linux__
+        close(fd);
+#endif
+    }
+    for (int e = 0; e < nevents; ++e)
+        opened[e] = opened[e] && !failed[e];
+
+    #pragma omp parallel
+    {
+        if (omp_get_thread_num() != 0)
+            open_thread(false);
+    }
+    open_thread(true);
+
+    Perf_counters *expected = nullptr;
+    if (!active.compare_exchange_strong(expected, this))
+    {
+#ifdef __linux__
+        for (const auto &counter : counters)
+            close(counter.fd);
+#endif
+        throw std::logic_error("Only one set of performance counters can be active.");
+    }
+
+    start = std::chrono::steady_clock::now();
+    start_counts = read();
+}
+//----------------------------------------------------------------------
+Perf_counters::~Perf_counters()
+{
+    active.store(nullptr);
+#ifdef __linux__
+    for (const auto &counter : counters)
+        close(counter.fd);
+#endif
+}
+//----------------------------------------------------------------------
+void Perf_counters::open_thread(bool inherit)
+{
+    std::vector<Counter> opened_here;
+    for (const auto &spec : event_specs())
+    {
+        if (!opened[spec.event])
+            continue;
+        const int fd = open_event(spec, inherit);
+        if (fd >= 0)
+            opened_here.push_back({fd, spec.event, spec.weight});
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.insert(counters.end(), opened_here.begin(), opened_here.end());
+}
+//----------------------------------------------------------------------
+///
+/// @brief Sums the counters over threads. Counts of multiplexed events are
+/// scaled by the fraction of time they were scheduled.
+///
+std::array<double, Perf_counters::nevents> Perf_counters::read() const
+{
+    std::array<double, nevents> counts{};
+#ifdef __linux__
+    for (const auto &counter : counters)
+    {
+        std::uint64_t values[3] = {0, 0, 0}; // value, time enabled, time running
+        if (::read(counter.fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))
+            continue;
+
+        double value = static_cast<double>(values[0]);
+        if (values[2] > 0 && values[2] < values[1])
+            value *= static_cast<double>(values[1]) / values[2];
+        counts[counter.event] += counter.weight * value;
+    }
+#endif
+    return counts;
+}
+//----------------------------------------------------------------------
+Perf_counters::Phase_data Perf_counters::total() const
+{
+    Phase_data data;
+    data.name = "Total";
+    data.calls = 1;
+    data.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const auto now = read();
+    for (int e = 0; e < nevents; ++e)
+        data.counts[e] = now[e] - start_counts[e];
+    return data;
+}
+//----------------------------------------------------------------------
+std::vector<Perf_counters::Phase_data> Perf_counters::phases() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return phase_data;
+}
+//----------------------------------------------------------------------
+void Perf_counters::record(const char *name, double seconds, const std::array<double, nevents> &counts)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = std::find_if(phase_data.begin(), phase_data.end(), [&](const Phase_data &phase)
+                           { return phase.name == name; });
+    if (it == phase_data.end())
+    {
+        phase_data.push_back(Phase_data{});
+        it = std::prev(phase_data.end());
+        it->name = name;
+    }
+
+    ++it->calls;
+    it->seconds += seconds;
+    for (int e = 0; e < nevents; ++e)
+        it->counts[e] += counts[e];
+}
+//----------------------------------------------------------------------
+Perf_counters::Phase::Phase(const char *name) : counters(active.load(std::memory_order_acquire)), name(name)
+{
+    if (counters == nullptr)
+        return;
+
+    start = std::chrono::steady_clock::now();
+    start_counts = counters->read();
+}
+//----------------------------------------------------------------------
+Perf_counters::Phase::~Phase()
+{
+    if (counters == nullptr)
+        return;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto counts = counters->read();
+    for (int e = 0; e < nevents; ++e)
+        counts[e] -= start_counts[e];
+
+    counters->record(name, seconds, counts);
+}
+//----------------------------------------------------------------------
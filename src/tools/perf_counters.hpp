@@ -0,0 +1,118 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+///
+/// @class Perf_counters
+/// @brief Hardware performance counters (perf_event_open) per computational phase.
+///
+/// The counters follow every thread of the process: each OpenMP thread opens
+/// its own, and the calling thread opens inherited ones that also cover the
+/// threads it starts later. While a Perf_counters object exists, a Phase scope
+/// records the wall time and the change of the counters between its start and
+/// end under its name. Phases running at the same time on different threads
+/// (e.g. concurrent cube reads) each see the events of both. Events the kernel
+/// or the CPU do not provide are reported as unavailable; the CPU time
+/// (software task clock) is counted whenever perf_event_open is allowed.
+///
+class Perf_counters
+{
+public:
+    /// Counted events. Flops sums the FP_ARITH events of Intel CPUs, weighted
+    /// by the double-precision operations of each vector width.
+    enum Event
+    {
+        Task_clock,
+        Cycles,
+        Instructions,
+        Cache_misses,
+        Branch_misses,
+        Flops,
+        nevents
+    };
+
+    /// Time and events of one phase, summed over its calls.
+    struct Phase_data
+    {
+        std::string name;
+        int calls = 0;
+        double seconds = 0.0;
+        std::array<double, nevents> counts{};
+    };
+
+    ///
+    /// @class Phase
+    /// @brief Scope of a named phase; does nothing without a Perf_counters object.
+    ///
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name);
+        ~Phase();
+
+        Phase(const Phase &) = delete;
+        Phase &operator=(const Phase &) = delete;
+
+    private:
+        Perf_counters *counters = nullptr;
+        const char *name = nullptr;
+        std::chrono::steady_clock::time_point start;
+        std::array<double, nevents> start_counts{};
+    };
+
+    /// @brief Opens the counters on every thread and starts the total.
+    Perf_counters();
+
+    /// @brief Closes the counters.
+    ~Perf_counters();
+
+    Perf_counters(const Perf_counters &) = delete;
+    Perf_counters &operator=(const Perf_counters &) = delete;
+
+    /// @brief True if the event could be opened.
+    bool available(Event event) const { return opened[event]; }
+
+    /// @brief Time and events since construction.
+    Phase_data total() const;
+
+    /// @brief Phases in the order they were first entered.
+    std::vector<Phase_data> phases() const;
+
+    /// Why the hardware events are missing (empty if they are counted).
+    std::string unavailable_reason;
+
+private:
+    struct Counter
+    {
+        int fd = -1;
+        Event event = Task_clock;
+        double weight = 1.0;
+    };
+
+    static inline std::atomic<Perf_counters *> active{nullptr};
+
+    std::vector<Counter> counters;
+    std::array<bool, nevents> opened{};
+    std::chrono::steady_clock::time_point start;
+    std::array<double, nevents> start_counts{};
+
+    mutable std::mutex mutex;
+    std::vector<Phase_data> phase_data;
+
+    /// @brief Opens the events of the calling thread (inherited by its new threads if @p inherit).
+    void open_thread(bool inherit);
+
+    /// @brief Current counts summed over threads, scaled for multiplexing.
+    std::array<double, nevents> read() const;
+
+    /// @brief Adds one call of a phase.
+    void record(const char *name, double seconds, const std::array<double, nevents> &counts);
+};
+
+#endif // PERF_COUNTERS_HPP
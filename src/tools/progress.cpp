@@ -0,0 +1,99 @@
+#include "progress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace
+{
+    ///
+    /// @brief Resident set size of the process (MB), from /proc/self/statm (0 if unavailable).
+    ///
+    double resident_mb()
+    {
+        std::FILE *statm = std::fopen("/proc/self/statm", "r");
+        if (statm == nullptr)
+            return 0.0;
+
+        unsigned long size = 0, resident = 0;
+        const int read = std::fscanf(statm, "%lu %lu", &size, &resident);
+        std::fclose(statm);
+        if (read != 2)
+            return 0.0;
+
+        return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    }
+} // namespace
+//----------------------------------------------------------------------
+///
+/// @brief Opens the file, registers the counters and starts the reporter thread.
+///
+Progress::Progress(const std::string &filepath, double interval)
+    : ncounters(omp_get_max_threads()), counters(new Counter[ncounters]), file(filepath, std::ios::trunc),
+      interval(interval), start(std::chrono::steady_clock::now())
+{
+    if (!file)
+        throw std::runtime_error("Could not write progress file: " + filepath);
+    if (interval <= 0.0)
+        throw std::runtime_error("Progress interval must be positive.");
+
+    char header[160];
+    std::snprintf(header, sizeof(header), "#%11s %8s %14s %12s %10s %10s\n",
+                  "Elapsed(s)", "Done(%)", "Pairs", "Pairs/s", "ETA(s)", "RSS(MB)");
+    file << header << std::flush;
+
+    Progress *expected = nullptr;
+    if (!active.compare_exchange_strong(expected, this))
+        throw std::logic_error("Only one progress report can be active.");
+
+    reporter = std::thread([this]
+                           {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::duration<double>(this->interval), [this] { return stopping; }))
+            report(false); });
+}
+//----------------------------------------------------------------------
+Progress::~Progress()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    reporter.join();
+
+    report(true);
+    active.store(nullptr);
+}
+//----------------------------------------------------------------------
+///
+/// @brief Sums the counters and appends a line. The fraction and ETA refer to
+/// the pairs announced so far; "-" if none were announced.
+///
+void Progress::report(bool final)
+{
+    std::uint64_t done = 0;
+    for (int t = 0; t < ncounters; ++t)
+        done += counters[t].pairs.load(std::memory_order_relaxed);
+    const std::uint64_t expected = total.load(std::memory_order_relaxed);
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double rate = elapsed > 0.0 ? done / elapsed : 0.0;
+
+    char fraction[32] = "-", eta[32] = "-";
+    if (expected > 0)
+    {
+        const double left = expected > done ? static_cast<double>(expected - done) : 0.0;
+        std::snprintf(fraction, sizeof(fraction), "%.1f", 100.0 * std::min<double>(done, expected) / expected);
+        if (rate > 0.0)
+            std::snprintf(eta, sizeof(eta), "%.0f", left / rate);
+    }
+
+    char line[160];
+    std::snprintf(line, sizeof(line), "%12.1f %8s %14.6e %12.4e %10s %10.1f%s\n",
+                  elapsed, fraction, static_cast<double>(done), rate, eta, resident_mb(), final ? "  done" : "");
+    file << line << std::flush;
+}
+//----------------------------------------------------------------------
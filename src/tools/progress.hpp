@@ -0,0 +1,79 @@
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+
+#include <omp.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+///
+/// @class Progress
+/// @brief Heartbeat of the coupling kernels, written to a sidecar file.
+///
+/// While a Progress object exists, the kernels add the point pairs they have
+/// evaluated to per-thread counters (one cache line each, relaxed atomics, one
+/// update per row or tile) and announce the pairs they are about to evaluate.
+/// A reporter thread samples the counters every interval and appends the
+/// fraction done, pair evaluations per second, the estimated time left and the
+/// resident memory to the file. Without a Progress object the kernel calls
+/// are a single pointer load.
+///
+class Progress
+{
+public:
+    /// @brief Starts reporting to @p filepath every @p interval seconds.
+    Progress(const std::string &filepath, double interval);
+
+    /// @brief Writes the final line and stops the reporter thread.
+    ~Progress();
+
+    Progress(const Progress &) = delete;
+    Progress &operator=(const Progress &) = delete;
+
+    /// @brief Announces @p pairs more pair evaluations (kernel entry points).
+    static void expect(std::uint64_t pairs)
+    {
+        if (Progress *progress = active.load(std::memory_order_relaxed))
+            progress->total.fetch_add(pairs, std::memory_order_relaxed);
+    }
+
+    /// @brief Counts @p pairs evaluated pairs for the calling thread.
+    static void add(std::uint64_t pairs)
+    {
+        if (Progress *progress = active.load(std::memory_order_relaxed))
+            progress->counters[omp_get_thread_num() % progress->ncounters].pairs.fetch_add(pairs, std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Counter
+    {
+        std::atomic<std::uint64_t> pairs{0};
+    };
+
+    static inline std::atomic<Progress *> active{nullptr};
+
+    int ncounters = 1;
+    std::unique_ptr<Counter[]> counters;
+    std::atomic<std::uint64_t> total{0};
+
+    std::ofstream file;
+    double interval = 0.0;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread reporter;
+
+    /// @brief Appends one line with the current counters.
+    void report(bool final);
+};
+
+#endif // PROGRESS_HPP
@@ -0,0 +1,46 @@
+#include "ranks.hpp"
+
+#include <stdexcept>
+
+//----------------------------------------------------------------------
+Ranks::Ranks()
+{
+    Ranks *expected = nullptr;
+    if (!active.compare_exchange_strong(expected, this))
+        throw std::logic_error("Only one set of ranks can be active.");
+}
+//----------------------------------------------------------------------
+Ranks::~Ranks()
+{
+    active.store(nullptr);
+}
+//----------------------------------------------------------------------
+int Ranks::rank()
+{
+    const Ranks *ranks = active.load(std::memory_order_relaxed);
+    return ranks ? ranks->this_rank() : 0;
+}
+//----------------------------------------------------------------------
+int Ranks::size()
+{
+    const Ranks *ranks = active.load(std::memory_order_relaxed);
+    return ranks ? ranks->nranks() : 1;
+}
+//----------------------------------------------------------------------
+std::array<int, 2> Ranks::share(int n)
+{
+    const int nranks = size();
+    const int r = rank();
+
+    const int base = n / nranks;
+    const int extra = n % nranks;
+    const int begin = r * base + (r < extra ? r : extra);
+    return {begin, begin + base + (r < extra ? 1 : 0)};
+}
+//----------------------------------------------------------------------
+void Ranks::sum(std::span<double> values)
+{
+    if (const Ranks *ranks = active.load(std::memory_order_relaxed); ranks && ranks->nranks() > 1)
+        ranks->sum_over_ranks(values);
+}
+//----------------------------------------------------------------------
@@ -0,0 +1,53 @@
+#ifndef RANKS_HPP
+#define RANKS_HPP
+
+#include <array>
+#include <atomic>
+#include <span>
+
+///
+/// @class Ranks
+/// @brief Processes that share the pair sums of the coupling kernels (the MPI
+/// ranks of FretLab_mpi).
+///
+/// Every rank holds all the reduced points. The kernels evaluate only their
+/// rank's share of the acceptor rows (whole tiles where they work by tiles),
+/// with OpenMP threads inside the rank, and then add the partial sums of all
+/// ranks with sum(). While no Ranks object exists (FretLab, the server and the
+/// library) there is a single rank owning every row and sum() does nothing.
+///
+class Ranks
+{
+public:
+    virtual ~Ranks();
+
+    Ranks(const Ranks &) = delete;
+    Ranks &operator=(const Ranks &) = delete;
+
+    /// @brief Index of the calling process (0 without ranks).
+    static int rank();
+
+    /// @brief Number of processes (1 without ranks).
+    static int size();
+
+    /// @brief Contiguous range [begin, end) of n items handled by the calling
+    /// process; the first n % size ranks get one item more.
+    static std::array<int, 2> share(int n);
+
+    /// @brief Replaces values on every rank by their sum over ranks, added in
+    /// rank order so the result does not depend on message timing.
+    static void sum(std::span<double> values);
+
+protected:
+    /// @brief Becomes the active set of ranks.
+    Ranks();
+
+    virtual int this_rank() const = 0;
+    virtual int nranks() const = 0;
+    virtual void sum_over_ranks(std::span<double> values) const = 0;
+
+private:
+    static inline std::atomic<Ranks *> active{nullptr};
+};
+
+#endif // RANKS_HPP
@@ -6,6 +6,10 @@
 #include <istream>
 #include <stdexcept>
 #include <string_view>
+#include <algorithm>
+#include <functional>
+#include <charconv>
+#include <system_error>
 
 /// @class String manipulation
 /// debugpgi
@@ -35,4 +39,67 @@ inline bool go_to_string(std::istream &in, std::string_view marker)
     return false;
 }
 
+
+// Finds a line in text that is exactly equal to marker (CRLF-safe), starting
+// the search at byte offset from. Returns the offset of the marker line, or
+// std::string_view::npos if not found. Uses a Boyer-Moore-Horspool search, so
+// long files are skipped through instead of being split into lines.
+inline std::size_t find_marker_line(std::string_view text, std::string_view marker, std::size_t from = 0)
+{
+    const std::boyer_moore_horspool_searcher searcher(marker.begin(), marker.end());
+
+    auto it = text.begin() + std::min(from, text.size());
+    while (true)
+    {
+        it = std::search(it, text.end(), searcher);
+        if (it == text.end())
+            return std::string_view::npos;
+
+        const std::size_t pos = it - text.begin();
+        const std::size_t end = pos + marker.size();
+
+        const bool at_line_start = (pos == 0 || text[pos - 1] == '\n');
+        const bool at_line_end = (end == text.size() || text[end] == '\n' ||
+                                  (text[end] == '\r' && (end + 1 == text.size() || text[end + 1] == '\n')));
+        if (at_line_start && at_line_end)
+            return pos;
+
+        ++it;
+    }
+}
+
+
+// Returns the line starting at offset pos (without '\n' or trailing '\r') and
+// moves pos to the beginning of the next line.
+inline std::string_view next_line(std::string_view text, std::size_t &pos)
+{
+    const std::size_t eol = text.find('\n', pos);
+    const std::size_t end = (eol == std::string_view::npos) ? text.size() : eol;
+
+    std::string_view line = text.substr(pos, end - pos);
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    pos = (eol == std::string_view::npos) ? text.size() : eol + 1;
+    return line;
+}
+
+
+// Parses the next whitespace-separated floating point number of [first, last)
+// with std::from_chars and advances first past it. Returns false on failure.
+inline bool parse_next_double(const char *&first, const char *last, double &out)
+{
+    while (first != last && (*first == ' ' || *first == '\t'))
+        ++first;
+    if (first != last && *first == '+')
+        ++first;
+
+    const auto [ptr, ec] = std::from_chars(first, last, out);
+    if (ec != std::errc())
+        return false;
+
+    first = ptr;
+    return true;
+}
+
 #endif
@@ -2,9 +2,12 @@
 #define TARGET_HPP
 
 #include "enum.hpp"
+#include "parameters.hpp"
 
 #include <string>
 #include <array>
+#include <vector>
+#include <cstdint>
 
 struct Target
 {
@@ -15,18 +18,21 @@ struct Target
     std::string input_filename;
     std::string density_file_integration;       ///< File for density integration (full path)
     std::string density_file_integration_input; /// File for density integration as named in input
+    AtomicPartition atomic_partition = AtomicPartition::None; ///< Atom-resolved populations of the integrated density
 
     // Acceptor
     bool is_acceptor_density_present = false;
 
     std::string acceptor_density_file;       ///< File for acceptor density (full path)
     std::string acceptor_density_input_file; /// File for acceptor density as named in input
+    std::vector<std::string> acceptor_density_files; ///< All acceptor densities (states) sharing one grid (full paths)
 
     // Donor
     bool is_donor_density_present = false;
 
     std::string donor_density_file;       ///< File for donor density (full path)
     std::string donor_density_input_file; /// File for donor density as named in input
+    std::vector<std::string> donor_density_files; ///< All donor densities (states) sharing one grid (full paths)
 
     // Nanoparticle
     bool is_nanoparticle_present = false;
@@ -34,6 +40,58 @@ struct Target
     std::string nanoparticle_file;       ///< File for nanoparticle (full path)
     std::string nanoparticle_input_file; /// File for nanoparticle as named in input
 
+    bool nanoparticle_frequencies = false; ///< nanoparticle_file is a list of "frequency  log file" lines
+
+    // Nanoparticle potential map cache
+    bool is_potential_map_present = false;
+
+    std::string potential_map_file;       ///< Cache file of the map (full path, created if missing)
+    std::string potential_map_input_file; /// Cache file as named in input
+    double potential_map_tolerance = 0.0; ///< Relative interpolation tolerance
+
+    // Cutoff convergence sweep
+    bool is_cutoff_sweep_present = false;
+    std::vector<double> sweep_cutoffs; ///< Decreasing cutoffs; cutoff is set to the last one
+    double sweep_tolerance = 0.0;      ///< Relative change of the coupling that stops the sweep
+
+    // Compressed (H-matrix) interaction operator
+    bool is_compression_present = false;
+    double compression_tolerance = 0.0; ///< Relative accuracy of the low-rank blocks
+
+    // Monte Carlo estimate of the coupling
+    bool is_monte_carlo_present = false;
+    double monte_carlo_tolerance = 0.0;                         ///< Relative standard error to reach
+    std::uint64_t monte_carlo_seed = Parameters::monte_carlo_seed; ///< Seed of the sample batches
+
+    // Dipole prescreen of acceptor-donor couplings
+    bool is_dipole_prescreen_present = false;
+    double dipole_prescreen_tolerance = 0.0; ///< Relative error above which the full integral is run
+
+    // Checkpoint/restart of acceptor-donor couplings
+    std::string checkpoint_file;       ///< Progress file (full path, created if missing); empty: no checkpoints
+    std::string checkpoint_input_file; /// Progress file as named in input
+    double checkpoint_interval = 0.0;  ///< Minimum time between checkpoint files (s)
+    bool is_checkpoint_interval_present = false;
+
+    // Aggregate
+    bool is_aggregate_present = false;
+
+    std::string aggregate_density_input_file;          /// Aggregate densities as named in input
+    std::vector<std::string> aggregate_density_files;  ///< One density per chromophore, or one shared by all poses (full paths)
+    std::string aggregate_poses_file;                  ///< Rigid-body poses of the shared density (full path)
+    std::string aggregate_poses_input_file;            /// Poses file as named in input
+
+    bool is_multipole_distance_present = false;
+    double multipole_distance = 0.0; ///< Minimum gap (Bohr) for the multipole shortcut; <= 0 disables it
+
+    // Trajectory
+    bool is_trajectory_present = false;
+
+    std::string trajectory_file;       ///< XYZ or DCD trajectory (full path)
+    std::string trajectory_input_file; /// Trajectory as named in input
+
+    double trajectory_timestep = 1.0; ///< Time between frames, in the unit wanted for the series
+
     // Target + other options
     TargetMode target_mode = TargetMode::None; ///< Selected calculation target
 
@@ -41,6 +99,8 @@ struct Target
 
     bool calc_overlap_int = false;
 
+    bool screening = true; ///< Screened Coulomb kernel erf(r / QMscrnFact) / r; bare 1 / r if false
+
     bool is_cutoff_present = false;
     double cutoff = 0.0;
 
@@ -53,7 +113,18 @@ struct Target
     bool is_debug_present;
     int debug = 0;
 
+    double progress_interval = 0.0; ///< Seconds between heartbeat lines in the .progress file; 0: none
+
+    Verbosity verbosity = Verbosity::Normal;          ///< Detail of the .log file
+    ResultsFormat results_format = ResultsFormat::None; ///< Machine-readable results next to the .log
+
     int n_threads_OMP = 1;
+    std::string thread_binding; ///< -bind policy: close, spread or none (report only); empty: not requested
+    bool perf_counters = false; ///< -counters: hardware counters per phase in the timing summary
+
+    // Server mode (-server [-cache N])
+    bool server_mode = false;
+    int cache_size = 8; ///< Maximum number of loaded files kept between jobs
 };
 
 #endif // TARGET_HPP
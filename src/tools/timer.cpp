@@ -4,6 +4,7 @@
 #include <iomanip> 
 #include <stdexcept>
 #include <ctime>
+#include <cstdio>
 
 //----------------------------------------------------------------------
 ///
@@ -53,6 +54,12 @@ void Timer::finish(const std::string& name) {
     }
 }
 //----------------------------------------------------------------------
+double Timer::elapsed(const std::string& name) const {
+    const auto it = timers.find(name);
+    if (it == timers.end() || !it->second.finished) return 0.0;
+    return std::chrono::duration<double>(it->second.end_time - it->second.start_time).count();
+}
+//----------------------------------------------------------------------
 ///
 /// @brief Prints a summary report of all timers to the provided output stream.
 ///
@@ -100,6 +107,10 @@ void Timer::conclude(const Output& out) {
 
     out.stream()  << "\n " << out.sticks << "\n\n";
 
+    if (counters) {
+        print_counters(out);
+    }
+
     // Date/Time Stamp
     out.stream() << std::setw(4) << " "
                << "Normal Termination of FretLab program in date "
@@ -109,3 +120,69 @@ void Timer::conclude(const Output& out) {
 }
 //----------------------------------------------------------------------
 
+///
+/// @brief Starts the hardware counters; phases entered from now on are recorded.
+///
+void Timer::count_events() {
+    counters = std::make_unique<Perf_counters>();
+}
+//----------------------------------------------------------------------
+///
+/// @brief Prints one line per phase and the total. IPC is instructions per
+/// cycle; the bandwidth is estimated as one 64-byte line per last-level cache
+/// miss. Counts cover all threads, so CPU time above the wall time shows the
+/// parallel speedup. Unavailable events are printed as "-".
+///
+void Timer::print_counters(const Output& out) const {
+    using Event = Perf_counters::Event;
+
+    out.stream() << std::setw(30) << " " << "Performance Counters\n\n";
+
+    if (!counters->unavailable_reason.empty()) {
+        out.stream() << "   Hardware events unavailable: " << counters->unavailable_reason << "\n\n";
+    }
+
+    char line[200];
+    std::snprintf(line, sizeof(line), "   %-22s %5s %9s %9s %10s %10s %5s %10s %10s %7s %8s\n",
+                  "Phase", "Calls", "Wall(s)", "CPU(s)", "Cycles", "Instr.", "IPC",
+                  "LLC miss", "Br. miss", "GB/s", "GFLOP/s");
+    out.stream() << line;
+
+    auto print_phase = [&](const Perf_counters::Phase_data& phase) {
+        auto count = [&](Event event) -> std::string {
+            if (!counters->available(event)) return "-";
+            char value[32];
+            std::snprintf(value, sizeof(value), "%.3e", phase.counts[event]);
+            return value;
+        };
+        auto ratio = [&](bool valid, double numerator, double denominator, const char* format) -> std::string {
+            if (!valid || denominator <= 0.0) return "-";
+            char value[32];
+            std::snprintf(value, sizeof(value), format, numerator / denominator);
+            return value;
+        };
+
+        const std::string cpu = ratio(counters->available(Event::Task_clock), phase.counts[Event::Task_clock], 1.0e9, "%.2f");
+        const std::string ipc = ratio(counters->available(Event::Cycles) && counters->available(Event::Instructions),
+                                      phase.counts[Event::Instructions], phase.counts[Event::Cycles], "%.2f");
+        const std::string bandwidth = ratio(counters->available(Event::Cache_misses),
+                                            64.0 * phase.counts[Event::Cache_misses], 1.0e9 * phase.seconds, "%.2f");
+        const std::string gflops = ratio(counters->available(Event::Flops),
+                                         phase.counts[Event::Flops], 1.0e9 * phase.seconds, "%.2f");
+
+        std::snprintf(line, sizeof(line), "   %-22.22s %5d %9.2f %9s %10s %10s %5s %10s %10s %7s %8s\n",
+                      phase.name.c_str(), phase.calls, phase.seconds, cpu.c_str(),
+                      count(Event::Cycles).c_str(), count(Event::Instructions).c_str(), ipc.c_str(),
+                      count(Event::Cache_misses).c_str(), count(Event::Branch_misses).c_str(),
+                      bandwidth.c_str(), gflops.c_str());
+        out.stream() << line;
+    };
+
+    for (const auto& phase : counters->phases()) {
+        print_phase(phase);
+    }
+    print_phase(counters->total());
+
+    out.stream() << "\n " << out.sticks << "\n\n";
+}
+//----------------------------------------------------------------------
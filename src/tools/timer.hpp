@@ -2,6 +2,8 @@
 #define TIMER_HPP
 
 #include "output.hpp"
+#include "perf_counters.hpp"
+#include <memory>
 #include <string>
 #include <iostream>
 #include <unordered_map>
@@ -44,6 +46,16 @@ public:
     /// @param Output stream to write the report to (default is std::cout).
     void conclude(const Output& out);
 
+    /// @brief Starts counting hardware events per phase (cube read, reduction,
+    /// kernels...). The summary printed by conclude() then includes them.
+    void count_events();
+
+    /// @brief Seconds between start() and finish() of a timer (0 if not finished).
+    double elapsed(const std::string& name) const;
+
+    /// @brief Hardware counters and phase times, or nullptr without count_events().
+    const Perf_counters* events() const { return counters.get(); }
+
     // TODO: Add finish() and conclude() methods for reporting.
 
 private:
@@ -57,6 +69,12 @@ private:
 
     /// @brief Map of timer names to their timing data.
     std::unordered_map<std::string, TimeData> timers;
+
+    /// @brief Hardware counters, if requested.
+    std::unique_ptr<Perf_counters> counters;
+
+    /// @brief Prints the events, IPC, bandwidth and FLOP rate of every phase.
+    void print_counters(const Output& out) const;
 };
 
 #endif 